@@ -0,0 +1,366 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+// Measures the overhead of the wrappers against the native calls, and the throughput of some
+// of the extensions. Each result is printed as one JSON object per line:
+//
+//   {"benchmark":"read_write/pipe/w","iterations":1048576,"ns_per_op":612.3,"bytes_per_second":1.04e+08}
+//
+// where bytes_per_second is only present for benchmarks which move data. Arguments are an
+// optional substring which benchmark names must contain, and --min-time=<ms> for the minimum
+// measurement time of each benchmark (200 ms by default).
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+#include <wx/ipv6.hpp>
+#include <wx/slurp.hpp>
+#include <wx/string.hpp>
+
+namespace
+{
+	std::string filter;
+	std::chrono::nanoseconds min_time = std::chrono::milliseconds(200);
+
+	template <typename T>
+	void keep(const T& value)
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	// Runs a benchmark in batches, doubling the batch size until a batch takes at least the
+	// minimum time, and reports the time per operation of the last batch.
+
+	void run(const std::string& name, const std::function<void(std::size_t)>& batch,
+		std::size_t bytes_per_op = 0)
+	{
+		if (name.find(filter) == std::string::npos)
+			return;
+
+		using clock = std::chrono::steady_clock;
+
+		std::size_t iterations = 1;
+		clock::duration elapsed;
+
+		while (true)
+		{
+			auto start = clock::now();
+			batch(iterations);
+			elapsed = clock::now() - start;
+
+			if (elapsed >= min_time || iterations >= (std::size_t { 1 } << 40))
+				break;
+
+			iterations *= 2;
+		}
+
+		double ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+
+		std::printf("{\"benchmark\":\"%s\",\"iterations\":%zu,\"ns_per_op\":%.1f", name.c_str(), iterations, ns);
+		if (bytes_per_op)
+			std::printf(",\"bytes_per_second\":%.3g", static_cast<double>(bytes_per_op) * 1e9 / ns);
+		std::printf("}\n");
+		std::fflush(stdout);
+	}
+
+	void bench_read_write()
+	{
+		char buf[64] = { };
+
+		for (std::size_t size : { std::size_t { 1 }, sizeof(buf) })
+		{
+			auto [r, w] = w::pipe();
+			std::string suffix = "/" + std::to_string(size);
+
+			run("read_write/pipe/native" + suffix, [&, r = int { r }, w = int { w }](std::size_t n)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					keep(::write(w, buf, size));
+					keep(::read(r, buf, size));
+				}
+			}, size);
+
+			run("read_write/pipe/w" + suffix, [&, r = int { r }, w = int { w }](std::size_t n)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					keep(w::write(w, buf, size));
+					keep(w::read(r, buf, size));
+				}
+			}, size);
+
+			run("read_write/pipe/w_ec" + suffix, [&, r = int { r }, w = int { w }](std::size_t n)
+			{
+				std::error_code ec;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					keep(w::write(w, buf, size, ec));
+					keep(w::read(r, buf, size, ec));
+				}
+			}, size);
+		}
+
+		auto efd = w::eventfd(0, EFD_CLOEXEC);
+
+		run("read_write/eventfd/native", [fd = int { efd }](std::size_t n)
+		{
+			std::uint64_t value = 1;
+
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				keep(::write(fd, &value, sizeof(value)));
+				keep(::read(fd, &value, sizeof(value)));
+			}
+		});
+
+		run("read_write/eventfd/w", [fd = int { efd }](std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				w::eventfd_write(fd, 1);
+				keep(w::eventfd_read(fd));
+			}
+		});
+	}
+
+	void bench_would_block()
+	{
+		auto [r, w] = w::pipe();
+		w::fcntl(r, F_SETFL, w::fcntl(r, F_GETFL) | O_NONBLOCK);
+		char c;
+
+		run("would_block/native", [&, fd = int { r }](std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+				keep(::read(fd, &c, 1));
+		});
+
+		run("would_block/error_code", [&, fd = int { r }](std::size_t n)
+		{
+			std::error_code ec;
+
+			for (std::size_t i = 0; i < n; ++i)
+				keep(w::read(fd, &c, 1, ec));
+		});
+
+		run("would_block/throw", [&, fd = int { r }](std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				try
+				{
+					keep(w::read(fd, &c, 1));
+				}
+				catch (const std::system_error& e)
+				{
+					keep(e.code().value());
+				}
+			}
+		});
+	}
+
+	void bench_slurp()
+	{
+		std::filesystem::path dir = std::filesystem::temp_directory_path() / ("cppwrap_bench." + std::to_string(::getpid()));
+		std::filesystem::create_directory(dir);
+
+		for (std::size_t size : { std::size_t { 64 }, std::size_t { 4096 }, std::size_t { 65536 }, std::size_t { 1 << 20 }, std::size_t { 16 << 20 } })
+		{
+			auto path = dir / std::to_string(size);
+			wx::spew(path, std::string(size, 'x'));
+
+			run("slurp/file/" + std::to_string(size), [&](std::size_t n)
+			{
+				std::string contents;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					wx::slurp(path, contents);
+					keep(contents.data());
+				}
+			}, size);
+		}
+
+		std::filesystem::remove_all(dir);
+
+		for (const char *path : { "/sys/class/net/lo/mtu", "/sys/devices/system/cpu/online", "/proc/self/stat" })
+		{
+			if (::access(path, R_OK))
+				continue;
+
+			run(std::string("slurp/sysfs") + path, [&](std::size_t n)
+			{
+				std::string contents;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					wx::slurp(path, contents);
+					keep(contents.data());
+				}
+			});
+		}
+	}
+
+	void bench_epoll_wait()
+	{
+		struct rlimit limit;
+		::getrlimit(RLIMIT_NOFILE, &limit);
+
+		constexpr int max_events = 64;
+		struct epoll_event events[max_events];
+
+		for (std::size_t count : { std::size_t { 64 }, std::size_t { 1024 }, std::size_t { 16384 } })
+		{
+			if (count + 16 > limit.rlim_cur)
+				continue;
+
+			// Only every count/64th eventfd is readable, so each wait returns a full batch of
+			// events drawn from a much larger interest list.
+
+			auto epfd = w::epoll_create1(EPOLL_CLOEXEC);
+			std::vector<w::fd> fds;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				fds.push_back(w::eventfd(i % (count / max_events) ? 0 : 1, EFD_CLOEXEC));
+				w::epoll_ctl(epfd, EPOLL_CTL_ADD, fds.back(), EPOLLIN, static_cast<int>(i));
+			}
+
+			run("epoll_wait/" + std::to_string(count), [&](std::size_t n)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+					keep(w::epoll_wait(epfd, events, max_events, std::chrono::milliseconds(0)));
+			});
+		}
+	}
+
+	void bench_number()
+	{
+		std::vector<std::string> integers, hex, floats;
+
+		for (std::uint64_t i = 0, x = 88172645463325252; i < 1024; ++i)
+		{
+			x ^= x << 13;
+			x ^= x >> 7;
+			x ^= x << 17;
+
+			integers.push_back(std::to_string(static_cast<std::int64_t>(x) >> (x % 48)));
+			char buf[16];
+			std::snprintf(buf, sizeof(buf), "0x%x", static_cast<unsigned>(x));
+			hex.push_back(buf);
+			floats.push_back(std::to_string(static_cast<double>(x % 1000000) / 1000.0));
+		}
+
+		std::size_t integer_bytes = 0, hex_bytes = 0, float_bytes = 0;
+		for (std::size_t i = 0; i < integers.size(); ++i)
+		{
+			integer_bytes += integers[i].size();
+			hex_bytes += hex[i].size();
+			float_bytes += floats[i].size();
+		}
+
+		run("number/int64", [&](std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+				keep(wx::number<std::int64_t>(std::string_view(integers[i & 1023])));
+		}, integer_bytes / 1024);
+
+		run("number/uint32_hex", [&](std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+				keep(wx::number<std::uint32_t>(std::string_view(hex[i & 1023]), 16));
+		}, hex_bytes / 1024);
+
+		run("number/double", [&](std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+				keep(wx::number<double>(std::string_view(floats[i & 1023])));
+		}, float_bytes / 1024);
+	}
+
+	void bench_ipv6()
+	{
+		const char *addresses[] =
+		{
+			"::1",
+			"fe80::1c2d:3eff:fe4f:5a6b",
+			"2001:db8:85a3:8d3:1319:8a2e:370:7348",
+			"::ffff:192.0.2.128",
+		};
+
+		for (const char *text : addresses)
+		{
+			in6_addr address = wx::ipv6::parse(text);
+
+			run(std::string("ipv6/to_string/") + text, [&](std::size_t n)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+					keep(wx::ipv6::to_string(address));
+			});
+
+			run(std::string("ipv6/to_chars/") + text, [&](std::size_t n)
+			{
+				char buf[wx::ipv6::max_string_length];
+
+				for (std::size_t i = 0; i < n; ++i)
+					keep(wx::ipv6::to_chars(buf, buf + sizeof(buf), address).ptr);
+			});
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string_view arg = argv[i];
+
+		if (arg.starts_with("--min-time="))
+			min_time = std::chrono::milliseconds(std::atoi(argv[i] + 11));
+		else
+			filter = arg;
+	}
+
+	try
+	{
+		bench_read_write();
+		bench_would_block();
+		bench_slurp();
+		bench_epoll_wait();
+		bench_number();
+		bench_ipv6();
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "cppwrap_bench: %s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
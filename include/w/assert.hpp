@@ -98,4 +98,114 @@ namespace w
 			throw std::system_error(errno, std::generic_category(), message);
 		return value;
 	}
+
+	/**
+	 * Sets @p ec to `errno` if @p value `==` @p x, otherwise clears @p ec. This is the
+	 * non-throwing counterpart of throw_if_eq().
+	 *
+	 * @tparam T The type of @p value and @p x.
+	 * @param value The value to check.
+	 * @param x The value to test for.
+	 * @param ec The error code to set or clear.
+	 * @return @p value.
+	 */
+	template <typename T>
+	T error_if_eq(T value, T x, std::error_code& ec) noexcept
+	{
+		if (value == x)
+			ec.assign(errno, std::generic_category());
+		else
+			ec.clear();
+		return value;
+	}
+
+	/**
+	 * Sets @p ec to `errno` if @p value `<` @p x, otherwise clears @p ec. This is the
+	 * non-throwing counterpart of throw_if_lt().
+	 *
+	 * @tparam T The type of @p value and @p x.
+	 * @param value The value to check.
+	 * @param x The value to test for.
+	 * @param ec The error code to set or clear.
+	 * @return @p value.
+	 */
+	template <typename T>
+	T error_if_lt(T value, T x, std::error_code& ec) noexcept
+	{
+		if (value < x)
+			ec.assign(errno, std::generic_category());
+		else
+			ec.clear();
+		return value;
+	}
+
+	/**
+	 * Sets @p ec to `errno` if @p value `!=` @p x, otherwise clears @p ec. This is the
+	 * non-throwing counterpart of throw_if_ne().
+	 *
+	 * @tparam T The type of @p value and @p x.
+	 * @param value The value to check.
+	 * @param x The value to test for.
+	 * @param ec The error code to set or clear.
+	 * @return @p value.
+	 */
+	template <typename T>
+	T error_if_ne(T value, T x, std::error_code& ec) noexcept
+	{
+		if (value != x)
+			ec.assign(errno, std::generic_category());
+		else
+			ec.clear();
+		return value;
+	}
+
+	/**
+	 * Sets @p ec to `errno` if @p value `!= 0`, otherwise clears @p ec. This is the
+	 * non-throwing counterpart of throw_if_nz().
+	 *
+	 * @tparam T The type of @p value.
+	 * @param value The value to check.
+	 * @param ec The error code to set or clear.
+	 * @return @p value.
+	 */
+	template <typename T>
+	T error_if_nz(T value, std::error_code& ec) noexcept
+	{
+		if (value != 0)
+			ec.assign(errno, std::generic_category());
+		else
+			ec.clear();
+		return value;
+	}
+
+	/**
+	 * Sets @p ec to `errno` if @p value `== 0`, otherwise clears @p ec. This is the
+	 * non-throwing counterpart of throw_if_z().
+	 *
+	 * @tparam T The type of @p value.
+	 * @param value The value to check.
+	 * @param ec The error code to set or clear.
+	 * @return @p value.
+	 */
+	template <typename T>
+	T error_if_z(T value, std::error_code& ec) noexcept
+	{
+		if (value == 0)
+			ec.assign(errno, std::generic_category());
+		else
+			ec.clear();
+		return value;
+	}
+
+	/**
+	 * Tests whether an error code indicates that a non-blocking operation would have blocked.
+	 *
+	 * @param ec The error code to test.
+	 * @return `true` if @p ec is `EAGAIN` or `EWOULDBLOCK`.
+	 */
+	inline bool would_block(const std::error_code& ec) noexcept
+	{
+		return ec == std::errc::resource_unavailable_try_again ||
+		       ec == std::errc::operation_would_block;
+	}
 }
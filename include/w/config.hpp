@@ -0,0 +1,23 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+/**
+ * Marks the definitions of the core wrappers in the `w/impl` headers. When `CPPWRAP_HEADER_ONLY` is
+ * defined (as by the `cppwrap_header_only` CMake target), each public header includes its
+ * definitions and they are declared `inline`, so that the wrappers can be inlined into their
+ * callers without LTO; otherwise, they are compiled once into the library.
+ */
+#ifdef CPPWRAP_HEADER_ONLY
+#define CPPWRAP_DECL inline
+#else
+#define CPPWRAP_DECL
+#endif
+
+#if defined(CPPWRAP_HEADER_ONLY) && defined(CPPWRAP_INSTRUMENTATION)
+#error "instrumentation is not available in header-only mode"
+#endif
@@ -0,0 +1,153 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <w/posix.hpp>
+
+namespace w
+{
+	/**
+	 * A set of file descriptors which owns them as w::fd does, and closes them in bulk.
+	 *
+	 * @remarks Membership is kept in a bitmap indexed by file descriptor number, so lookup,
+	 *          insertion and removal take constant time, and the bitmap is only as large as the
+	 *          highest descriptor held (128 KiB for a million descriptors). Since the kernel
+	 *          allocates the lowest free descriptor, the descriptors of a process tend to be
+	 *          dense, and close() takes advantage of this: it walks the bitmap in order and
+	 *          closes each run of consecutive descriptors with one `close_range()` call (falling
+	 *          back to `close()` on kernels older than 5.9), instead of taking the file table
+	 *          lock once per descriptor.
+	 *
+	 *          The table is moveable but not copyable, like w::fd. It is not thread-safe.
+	 */
+	class fd_table
+	{
+		public:
+
+			/**
+			 * Constructs an empty table.
+			 */
+			fd_table() noexcept : _size(0) { }
+
+			fd_table(const fd_table&) = delete;
+			fd_table& operator=(const fd_table&) = delete;
+
+			/**
+			 * Constructs a table which takes ownership of the file descriptors of another
+			 * table, leaving it empty.
+			 *
+			 * @param other The table to take the file descriptors of.
+			 */
+			fd_table(fd_table&& other) noexcept;
+
+			/**
+			 * Closes the file descriptors of this table, and takes ownership of the file
+			 * descriptors of another table, leaving it empty.
+			 *
+			 * @param other The table to take the file descriptors of.
+			 * @return A reference to this table.
+			 */
+			fd_table& operator=(fd_table&& other) noexcept;
+
+			/**
+			 * Closes the file descriptors of this table.
+			 */
+			~fd_table() noexcept { close(); }
+
+			/**
+			 * Takes ownership of a file descriptor.
+			 *
+			 * @param fd The file descriptor, which is left empty. Nothing happens if it is
+			 *        already empty.
+			 * @throw std::bad_alloc The bitmap could not be grown. @p fd keeps ownership.
+			 */
+			void insert(w::fd&& fd);
+
+			/**
+			 * Tests whether this table owns a file descriptor.
+			 *
+			 * @param fd The file descriptor.
+			 * @return `true` if this table owns @p fd.
+			 */
+			bool contains(int fd) const noexcept
+			{
+				auto i = static_cast<std::size_t>(fd);
+				return fd >= 0 && i / 64 < _bits.size() && (_bits[i / 64] >> (i % 64) & 1);
+			}
+
+			/**
+			 * Removes a file descriptor from this table without closing it.
+			 *
+			 * @param fd The file descriptor.
+			 * @return A handle which owns @p fd, or an empty handle if this table does not own
+			 *         @p fd.
+			 */
+			w::fd extract(int fd) noexcept;
+
+			/**
+			 * Closes a file descriptor and removes it from this table. Nothing happens if this
+			 * table does not own @p fd.
+			 *
+			 * @param fd The file descriptor.
+			 */
+			void erase(int fd) noexcept { extract(fd).close(); }
+
+			/**
+			 * Closes all the file descriptors of this table, in bulk, and empties it.
+			 */
+			void close() noexcept;
+
+			/**
+			 * Releases (without closing) all the file descriptors of this table, and empties
+			 * it.
+			 *
+			 * @return The file descriptors, in ascending order.
+			 */
+			std::vector<int> release();
+
+			/**
+			 * Calls a function for each file descriptor of this table, in ascending order. The
+			 * function must not modify the table.
+			 *
+			 * @tparam Function The type of the function, which is called with an `int`.
+			 * @param function The function.
+			 */
+			template <typename Function>
+			void for_each(Function&& function) const
+			{
+				for (std::size_t word = 0; word < _bits.size(); ++word)
+				{
+					for (std::uint64_t bits = _bits[word]; bits; bits &= bits - 1)
+						function(static_cast<int>(word * 64 + static_cast<std::size_t>(std::countr_zero(bits))));
+				}
+			}
+
+			/**
+			 * Gets the number of file descriptors owned by this table.
+			 *
+			 * @return The number of file descriptors.
+			 */
+			std::size_t size() const noexcept { return _size; }
+
+			/**
+			 * Tests whether this table owns no file descriptors.
+			 *
+			 * @return `true` if this table is empty.
+			 */
+			bool empty() const noexcept { return !_size; }
+
+		private:
+
+			std::vector<std::uint64_t> _bits;
+			std::size_t _size;
+	};
+}
@@ -0,0 +1,286 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <linux/io_uring.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <w/assert.hpp>
+#include <w/config.hpp>
+#include <w/instrumentation.hpp>
+#include <w/io_uring.hpp>
+#include <w/posix.hpp>
+
+CPPWRAP_DECL w::fd w::io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+	CPPWRAP_INSTRUMENT(io_uring_setup);
+
+	return w::throw_if_eq(
+		static_cast<int>(::syscall(__NR_io_uring_setup, entries, p)),
+		-1,
+		"failed to create io_uring instance");
+}
+
+CPPWRAP_DECL unsigned w::io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+	const sigset_t *sig)
+{
+	CPPWRAP_INSTRUMENT(io_uring_enter);
+
+	return static_cast<unsigned>(
+		w::throw_if_lt(
+			static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, sig, _NSIG / 8)),
+			0,
+			"failed to enter io_uring instance"));
+}
+
+CPPWRAP_DECL unsigned w::io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+	const sigset_t *sig, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(io_uring_enter, ec);
+
+	int rv = w::error_if_lt(
+		static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, sig, _NSIG / 8)),
+		0,
+		ec);
+
+	return ec ? 0 : static_cast<unsigned>(rv);
+}
+
+CPPWRAP_DECL int w::io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args)
+{
+	CPPWRAP_INSTRUMENT(io_uring_register);
+
+	return w::throw_if_lt(
+		static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args)),
+		0,
+		"failed to register resources with io_uring instance");
+}
+
+CPPWRAP_DECL w::io_uring::io_uring(unsigned entries, unsigned flags)
+{
+	std::memset(&_params, 0, sizeof(_params));
+	_params.flags = flags;
+
+	if (flags & (IORING_SETUP_SQE128 | IORING_SETUP_CQE32))
+		throw std::invalid_argument("unsupported io_uring entry size");
+
+	_fd = w::io_uring_setup(entries, &_params);
+	map_rings();
+}
+
+CPPWRAP_DECL w::io_uring::io_uring(unsigned entries, struct io_uring_params& params)
+{
+	if (params.flags & (IORING_SETUP_SQE128 | IORING_SETUP_CQE32))
+		throw std::invalid_argument("unsupported io_uring entry size");
+
+	_fd = w::io_uring_setup(entries, &params);
+	_params = params;
+	map_rings();
+}
+
+CPPWRAP_DECL void w::io_uring::map_rings()
+{
+	// Since Linux 5.4 (IORING_FEAT_SINGLE_MMAP), the submission and completion rings share a
+	// single mapping, which must then be large enough for both.
+
+	std::size_t sq_size = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+	std::size_t cq_size = _params.cq_off.cqes + _params.cq_entries * sizeof(struct io_uring_cqe);
+	bool single_mmap = _params.features & IORING_FEAT_SINGLE_MMAP;
+
+	if (single_mmap)
+		sq_size = cq_size = std::max(sq_size, cq_size);
+
+	_sq_ring = w::mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		_fd, IORING_OFF_SQ_RING);
+
+	if (!single_mmap)
+		_cq_ring = w::mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			_fd, IORING_OFF_CQ_RING);
+
+	_sqe_array = w::mmap(nullptr, _params.sq_entries * sizeof(struct io_uring_sqe),
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+
+	auto sq = static_cast<char *>(_sq_ring.get().address);
+	auto cq = single_mmap ? sq : static_cast<char *>(_cq_ring.get().address);
+
+	_sq_head = reinterpret_cast<unsigned *>(sq + _params.sq_off.head);
+	_sq_tail = reinterpret_cast<unsigned *>(sq + _params.sq_off.tail);
+	_sq_flags = reinterpret_cast<unsigned *>(sq + _params.sq_off.flags);
+	_sq_mask = *reinterpret_cast<unsigned *>(sq + _params.sq_off.ring_mask);
+	_sqes = static_cast<struct io_uring_sqe *>(_sqe_array.get().address);
+	_sqe_head = _sqe_tail = *_sq_tail;
+
+	_cq_head = reinterpret_cast<unsigned *>(cq + _params.cq_off.head);
+	_cq_tail = reinterpret_cast<unsigned *>(cq + _params.cq_off.tail);
+	_cq_mask = *reinterpret_cast<unsigned *>(cq + _params.cq_off.ring_mask);
+	_cqes = reinterpret_cast<struct io_uring_cqe *>(cq + _params.cq_off.cqes);
+
+	// Submission queue entries are always handed out in ring order, so the indirection array
+	// is the identity mapping and only needs to be filled in once.
+
+	auto array = reinterpret_cast<unsigned *>(sq + _params.sq_off.array);
+	for (unsigned i = 0; i < _params.sq_entries; ++i)
+		array[i] = i;
+}
+
+CPPWRAP_DECL struct io_uring_sqe *w::io_uring::get_sqe() noexcept
+{
+	unsigned head = std::atomic_ref<unsigned>(*_sq_head).load(std::memory_order_acquire);
+
+	if (_sqe_tail - head >= _params.sq_entries)
+		return nullptr;
+
+	struct io_uring_sqe *sqe = &_sqes[_sqe_tail++ & _sq_mask];
+	std::memset(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+CPPWRAP_DECL unsigned w::io_uring::flush() noexcept
+{
+	unsigned count = _sqe_tail - _sqe_head;
+
+	if (count)
+	{
+		std::atomic_ref<unsigned>(*_sq_tail).store(_sqe_tail, std::memory_order_release);
+		_sqe_head = _sqe_tail;
+	}
+
+	return count;
+}
+
+CPPWRAP_DECL unsigned w::io_uring::enter_flags(unsigned wait_nr) const noexcept
+{
+	unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+
+	if ((_params.flags & IORING_SETUP_SQPOLL) &&
+		(std::atomic_ref<unsigned>(*_sq_flags).load(std::memory_order_relaxed) & IORING_SQ_NEED_WAKEUP))
+		flags |= IORING_ENTER_SQ_WAKEUP;
+
+	return flags;
+}
+
+CPPWRAP_DECL unsigned w::io_uring::submit(unsigned wait_nr)
+{
+	std::error_code ec;
+	unsigned submitted = submit(wait_nr, ec);
+
+	if (ec)
+		throw std::system_error(ec, "failed to submit to io_uring instance");
+
+	return submitted;
+}
+
+CPPWRAP_DECL unsigned w::io_uring::submit(unsigned wait_nr, std::error_code& ec) noexcept
+{
+	unsigned count = flush();
+
+	// With a kernel polling thread, new entries are picked up without a system call, so one is
+	// only needed to wait for completions or to wake the thread up.
+
+	if (_params.flags & IORING_SETUP_SQPOLL)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		unsigned flags = enter_flags(wait_nr);
+
+		if (!flags)
+		{
+			ec.clear();
+			return count;
+		}
+
+		w::io_uring_enter(_fd, count, wait_nr, flags, nullptr, ec);
+		return ec ? 0 : count;
+	}
+
+	if (!count && !wait_nr)
+	{
+		ec.clear();
+		return 0;
+	}
+
+	return w::io_uring_enter(_fd, count, wait_nr, enter_flags(wait_nr), nullptr, ec);
+}
+
+CPPWRAP_DECL const struct io_uring_cqe *w::io_uring::peek_cqe() noexcept
+{
+	unsigned head = *_cq_head;
+
+	if (head == std::atomic_ref<unsigned>(*_cq_tail).load(std::memory_order_acquire))
+		return nullptr;
+
+	return &_cqes[head & _cq_mask];
+}
+
+CPPWRAP_DECL const struct io_uring_cqe *w::io_uring::wait_cqe()
+{
+	const struct io_uring_cqe *cqe;
+
+	while (!(cqe = peek_cqe()))
+	{
+		std::error_code ec;
+		w::io_uring_enter(_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, ec);
+
+		if (ec && ec != std::errc::interrupted)
+			throw std::system_error(ec, "failed to wait on io_uring instance");
+	}
+
+	return cqe;
+}
+
+CPPWRAP_DECL unsigned w::io_uring::sq_space_left() const noexcept
+{
+	return _params.sq_entries -
+		(_sqe_tail - std::atomic_ref<unsigned>(*_sq_head).load(std::memory_order_acquire));
+}
+
+CPPWRAP_DECL unsigned w::io_uring::cq_ready() const noexcept
+{
+	return std::atomic_ref<unsigned>(*_cq_tail).load(std::memory_order_acquire) - *_cq_head;
+}
+
+CPPWRAP_DECL void w::io_uring::register_files(const int *fds, unsigned count)
+{
+	w::io_uring_register(_fd, IORING_REGISTER_FILES, fds, count);
+}
+
+CPPWRAP_DECL void w::io_uring::unregister_files()
+{
+	w::io_uring_register(_fd, IORING_UNREGISTER_FILES, nullptr, 0);
+}
+
+CPPWRAP_DECL void w::io_uring::register_buffers(const struct iovec *iov, unsigned count)
+{
+	w::io_uring_register(_fd, IORING_REGISTER_BUFFERS, iov, count);
+}
+
+CPPWRAP_DECL void w::io_uring::unregister_buffers()
+{
+	w::io_uring_register(_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+}
+
+CPPWRAP_DECL void w::io_uring::register_buf_ring(const struct io_uring_buf_reg& reg)
+{
+	w::io_uring_register(_fd, IORING_REGISTER_PBUF_RING, &reg, 1);
+}
+
+CPPWRAP_DECL void w::io_uring::unregister_buf_ring(std::uint16_t bgid)
+{
+	struct io_uring_buf_reg reg { };
+	reg.bgid = bgid;
+	w::io_uring_register(_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+}
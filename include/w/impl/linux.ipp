@@ -0,0 +1,530 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <chrono>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <w/assert.hpp>
+#include <w/config.hpp>
+#include <w/instrumentation.hpp>
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+
+CPPWRAP_DECL void w::close_range(unsigned first, unsigned last, int flags)
+{
+	CPPWRAP_INSTRUMENT(close_range);
+
+	w::throw_if_ne(
+		::close_range(first, last, flags),
+		0,
+		"failed to close file descriptors");
+}
+
+CPPWRAP_DECL void w::close_range(unsigned first, unsigned last, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(close_range, ec);
+
+	w::error_if_ne(
+		::close_range(first, last, flags),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL std::size_t w::copy_file_range(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+	std::size_t len, unsigned flags)
+{
+	CPPWRAP_INSTRUMENT(copy_file_range);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::copy_file_range(fd_in, off_in, fd_out, off_out, len, flags)),
+			ssize_t { 0 },
+			"failed to copy file range"));
+}
+
+CPPWRAP_DECL std::size_t w::copy_file_range(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+	std::size_t len, unsigned flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(copy_file_range, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::copy_file_range(fd_in, off_in, fd_out, off_out, len, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL w::fd w::epoll_create(int size)
+{
+	CPPWRAP_INSTRUMENT(epoll_create);
+
+	return w::throw_if_eq(
+		::epoll_create(size),
+		-1,
+		"failed to create epoll instance");
+}
+
+CPPWRAP_DECL w::fd w::epoll_create1(int flags)
+{
+	CPPWRAP_INSTRUMENT(epoll_create1);
+
+	return w::throw_if_eq(
+		::epoll_create1(flags),
+		-1,
+		"failed to create epoll instance");
+}
+
+CPPWRAP_DECL void w::epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+	CPPWRAP_INSTRUMENT(epoll_ctl);
+
+	w::throw_if_ne(
+		::epoll_ctl(epfd, op, fd, event),
+		0,
+		"failed to add file descriptor to epoll instance");
+}
+
+CPPWRAP_DECL void w::epoll_ctl(int epfd, int op, int fd, struct epoll_event *event, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(epoll_ctl, ec);
+
+	w::error_if_ne(
+		::epoll_ctl(epfd, op, fd, event),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::epoll_ctl(int epfd, int op, int fd, std::uint32_t events, void *user_data)
+{
+	struct epoll_event ev { .events = events, .data { .ptr = user_data } };
+	w::epoll_ctl(epfd, op, fd, &ev);
+}
+
+CPPWRAP_DECL void w::epoll_ctl(int epfd, int op, int fd, std::uint32_t events, void *user_data,
+	std::error_code& ec) noexcept
+{
+	struct epoll_event ev { .events = events, .data { .ptr = user_data } };
+	w::epoll_ctl(epfd, op, fd, &ev, ec);
+}
+
+CPPWRAP_DECL void w::epoll_ctl(int epfd, int op, int fd, std::uint32_t events, int user_data)
+{
+	struct epoll_event ev { .events = events, .data { .fd = user_data } };
+	w::epoll_ctl(epfd, op, fd, &ev);
+}
+
+CPPWRAP_DECL void w::epoll_ctl(int epfd, int op, int fd, std::uint32_t events, std::uint32_t user_data)
+{
+	struct epoll_event ev { .events = events, .data { .u32 = user_data } };
+	w::epoll_ctl(epfd, op, fd, &ev);
+}
+
+CPPWRAP_DECL void w::epoll_ctl(int epfd, int op, int fd, std::uint32_t events, std::uint64_t user_data)
+{
+	struct epoll_event ev { .events = events, .data { .u64 = user_data } };
+	w::epoll_ctl(epfd, op, fd, &ev);
+}
+
+CPPWRAP_DECL unsigned w::epoll_wait(int epfd, struct epoll_event *events, int maxevents,
+	std::chrono::milliseconds timeout)
+{
+	CPPWRAP_INSTRUMENT(epoll_wait);
+
+	if (timeout.count() < std::numeric_limits<int>::min() ||
+		timeout.count() > std::numeric_limits<int>::max())
+		throw std::invalid_argument("invalid timeout for epoll wait");
+
+	return w::throw_if_lt(
+		::epoll_wait(epfd, events, maxevents, timeout.count()),
+		0,
+		"failed to wait on epoll instance");
+}
+
+CPPWRAP_DECL unsigned w::epoll_wait(int epfd, struct epoll_event *events, int maxevents,
+	std::chrono::milliseconds timeout, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(epoll_wait, ec);
+
+	if (timeout.count() < std::numeric_limits<int>::min() ||
+		timeout.count() > std::numeric_limits<int>::max())
+	{
+		ec = std::make_error_code(std::errc::invalid_argument);
+		return 0;
+	}
+
+	int rv = w::error_if_lt(
+		::epoll_wait(epfd, events, maxevents, timeout.count()),
+		0,
+		ec);
+
+	return ec ? 0 : static_cast<unsigned>(rv);
+}
+
+CPPWRAP_DECL w::fd w::eventfd(unsigned initval, int flags)
+{
+	CPPWRAP_INSTRUMENT(eventfd);
+
+	return w::throw_if_eq(
+		::eventfd(initval, flags),
+		-1,
+		"failed to create event file descriptor");
+}
+
+CPPWRAP_DECL std::uint64_t w::eventfd_read(int evfd)
+{
+	std::uint64_t result;
+	w::read(evfd, &result, sizeof(result));
+	return result;
+}
+
+CPPWRAP_DECL std::uint64_t w::eventfd_read(int evfd, std::error_code& ec) noexcept
+{
+	std::uint64_t result = 0;
+	w::read(evfd, &result, sizeof(result), ec);
+	return ec ? 0 : result;
+}
+
+CPPWRAP_DECL void w::eventfd_write(int evfd, std::uint64_t value)
+{
+	w::write(evfd, &value, sizeof(value));
+}
+
+CPPWRAP_DECL void w::eventfd_write(int evfd, std::uint64_t value, std::error_code& ec) noexcept
+{
+	w::write(evfd, &value, sizeof(value), ec);
+}
+
+CPPWRAP_DECL void w::fallocate(int fd, int mode, off_t offset, off_t len)
+{
+	CPPWRAP_INSTRUMENT(fallocate);
+
+	w::throw_if_ne(
+		::fallocate(fd, mode, offset, len),
+		0,
+		"failed to allocate file space");
+}
+
+CPPWRAP_DECL void w::fallocate(int fd, int mode, off_t offset, off_t len, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(fallocate, ec);
+
+	w::error_if_ne(
+		::fallocate(fd, mode, offset, len),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::mbind(void *addr, unsigned long len, int mode, const unsigned long *nodemask, unsigned long maxnode, unsigned flags)
+{
+	CPPWRAP_INSTRUMENT(mbind);
+
+	w::throw_if_ne(
+		static_cast<int>(::syscall(SYS_mbind, addr, len, mode, nodemask, maxnode, flags)),
+		0,
+		"failed to set memory policy");
+}
+
+CPPWRAP_DECL void w::mbind(void *addr, unsigned long len, int mode, const unsigned long *nodemask, unsigned long maxnode, unsigned flags,
+		std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(mbind, ec);
+
+	w::error_if_ne(
+		static_cast<int>(::syscall(SYS_mbind, addr, len, mode, nodemask, maxnode, flags)),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL w::fd w::memfd_create(const char *name, unsigned flags)
+{
+	CPPWRAP_INSTRUMENT(memfd_create);
+
+	return w::throw_if_eq(
+		::memfd_create(name, flags),
+		-1,
+		"failed to create memory file");
+}
+
+CPPWRAP_DECL w::fd w::memfd_create(const char *name, unsigned flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(memfd_create, ec);
+
+	return w::error_if_eq(
+		::memfd_create(name, flags),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL void w::mlock2(const void *addr, std::size_t len, unsigned flags)
+{
+	CPPWRAP_INSTRUMENT(mlock2);
+
+	w::throw_if_ne(
+		::mlock2(addr, len, flags),
+		0,
+		"failed to lock memory");
+}
+
+CPPWRAP_DECL void w::mlock2(const void *addr, std::size_t len, unsigned flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(mlock2, ec);
+
+	w::error_if_ne(
+		::mlock2(addr, len, flags),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::mremap(w::mmap_handle& mapping, std::size_t new_length, int flags)
+{
+	CPPWRAP_INSTRUMENT(mremap);
+
+	w::memory_region region = mapping.get();
+	void *address = ::mremap(region.address, region.length, new_length, flags);
+	w::throw_if_eq<void *>(address, MAP_FAILED, "failed to remap memory");
+
+	mapping.release();
+	mapping = w::memory_region { address, new_length };
+}
+
+CPPWRAP_DECL void w::mremap(w::mmap_handle& mapping, std::size_t new_length, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(mremap, ec);
+
+	w::memory_region region = mapping.get();
+	void *address = ::mremap(region.address, region.length, new_length, flags);
+	w::error_if_eq<void *>(address, MAP_FAILED, ec);
+
+	if (!ec)
+	{
+		mapping.release();
+		mapping = w::memory_region { address, new_length };
+	}
+}
+
+CPPWRAP_DECL cpu_set_t w::sched_getaffinity(pid_t pid)
+{
+	CPPWRAP_INSTRUMENT(sched_getaffinity);
+
+	cpu_set_t mask;
+
+	w::throw_if_ne(
+		::sched_getaffinity(pid, sizeof(mask), &mask),
+		0,
+		"failed to get CPU affinity");
+
+	return mask;
+}
+
+CPPWRAP_DECL cpu_set_t w::sched_getaffinity(pid_t pid, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(sched_getaffinity, ec);
+
+	cpu_set_t mask;
+
+	w::error_if_ne(::sched_getaffinity(pid, sizeof(mask), &mask), 0, ec);
+
+	if (ec)
+		CPU_ZERO(&mask);
+
+	return mask;
+}
+
+CPPWRAP_DECL void w::sched_setaffinity(pid_t pid, const cpu_set_t& mask)
+{
+	CPPWRAP_INSTRUMENT(sched_setaffinity);
+
+	w::throw_if_ne(
+		::sched_setaffinity(pid, sizeof(mask), &mask),
+		0,
+		"failed to set CPU affinity");
+}
+
+CPPWRAP_DECL void w::sched_setaffinity(pid_t pid, const cpu_set_t& mask, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(sched_setaffinity, ec);
+
+	w::error_if_ne(::sched_setaffinity(pid, sizeof(mask), &mask), 0, ec);
+}
+
+CPPWRAP_DECL std::size_t w::sendfile(int out_fd, int in_fd, off_t *offset, std::size_t count)
+{
+	CPPWRAP_INSTRUMENT(sendfile);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::sendfile(out_fd, in_fd, offset, count)),
+			ssize_t { 0 },
+			"failed to send file"));
+}
+
+CPPWRAP_DECL std::size_t w::sendfile(int out_fd, int in_fd, off_t *offset, std::size_t count,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(sendfile, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::sendfile(out_fd, in_fd, offset, count)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::splice(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+	std::size_t len, unsigned flags)
+{
+	CPPWRAP_INSTRUMENT(splice);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::splice(fd_in, off_in, fd_out, off_out, len, flags)),
+			ssize_t { 0 },
+			"failed to splice data"));
+}
+
+CPPWRAP_DECL std::size_t w::splice(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+	std::size_t len, unsigned flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(splice, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::splice(fd_in, off_in, fd_out, off_out, len, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL void w::syncfs(int fd)
+{
+	CPPWRAP_INSTRUMENT(syncfs);
+
+	w::throw_if_ne(
+		::syncfs(fd),
+		0,
+		"failed to synchronize filesystem");
+}
+
+CPPWRAP_DECL void w::syncfs(int fd, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(syncfs, ec);
+
+	w::error_if_ne(
+		::syncfs(fd),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL std::size_t w::tee(int fd_in, int fd_out, std::size_t len, unsigned flags)
+{
+	CPPWRAP_INSTRUMENT(tee);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::tee(fd_in, fd_out, len, flags)),
+			ssize_t { 0 },
+			"failed to duplicate pipe data"));
+}
+
+CPPWRAP_DECL std::size_t w::tee(int fd_in, int fd_out, std::size_t len, unsigned flags,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(tee, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::tee(fd_in, fd_out, len, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL w::fd w::timerfd_create(int clockid, int flags)
+{
+	CPPWRAP_INSTRUMENT(timerfd_create);
+
+	return w::throw_if_eq(
+		::timerfd_create(clockid, flags),
+		-1,
+		"failed to create timer file descriptor");
+}
+
+CPPWRAP_DECL void w::timerfd_settime(int fd, int flags,
+	const struct itimerspec *new_value,
+	struct itimerspec *old_value)
+{
+	CPPWRAP_INSTRUMENT(timerfd_settime);
+
+	w::throw_if_ne(
+		::timerfd_settime(fd, flags, new_value, old_value),
+		0,
+		"failed to set timer file descriptor interval");
+}
+
+CPPWRAP_DECL std::pair<std::chrono::nanoseconds, std::chrono::nanoseconds>
+w::timerfd_settime(int fd, int flags,
+	std::chrono::nanoseconds interval,
+	std::chrono::nanoseconds initial)
+{
+	struct itimerspec old_value, new_value;
+	new_value.it_interval.tv_sec  = interval.count() / 1000000000;
+	new_value.it_interval.tv_nsec = interval.count() % 1000000000;
+	new_value.it_value.tv_sec  = initial.count() / 1000000000;
+	new_value.it_value.tv_nsec = initial.count() % 1000000000;
+
+	w::timerfd_settime(fd, flags, &new_value, &old_value);
+
+	return std::make_pair(
+		std::chrono::nanoseconds(
+			old_value.it_interval.tv_sec * 1000000000 +
+			old_value.it_interval.tv_nsec),
+		std::chrono::nanoseconds(
+			old_value.it_value.tv_sec * 1000000000 +
+			old_value.it_value.tv_nsec));
+}
+
+CPPWRAP_DECL std::size_t w::vmsplice(int fd, const struct iovec *iov, std::size_t nr_segs, unsigned flags)
+{
+	CPPWRAP_INSTRUMENT(vmsplice);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::vmsplice(fd, iov, nr_segs, flags)),
+			ssize_t { 0 },
+			"failed to map memory into pipe"));
+}
+
+CPPWRAP_DECL std::size_t w::vmsplice(int fd, const struct iovec *iov, std::size_t nr_segs, unsigned flags,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(vmsplice, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::vmsplice(fd, iov, nr_segs, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
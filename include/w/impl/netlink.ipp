@@ -0,0 +1,23 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include <linux/netlink.h>
+#include <sys/socket.h>
+
+#include <w/config.hpp>
+#include <w/netlink.hpp>
+
+CPPWRAP_DECL w::netlink_address::netlink_address(std::uint32_t groups, std::uint32_t pid) noexcept
+{
+	nl_family = AF_NETLINK;
+	nl_pad = 0;
+	nl_pid = pid;
+	nl_groups = groups;
+}
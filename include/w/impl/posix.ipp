@@ -0,0 +1,622 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include <w/assert.hpp>
+#include <w/config.hpp>
+#include <w/instrumentation.hpp>
+#include <w/posix.hpp>
+
+CPPWRAP_DECL int w::fcntl(int fd, int cmd)
+{
+	CPPWRAP_INSTRUMENT(fcntl);
+
+	return w::throw_if_eq(
+		::fcntl(fd, cmd),
+		-1,
+		"file descriptor control failed");
+}
+
+CPPWRAP_DECL int w::fcntl(int fd, int cmd, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(fcntl, ec);
+
+	return w::error_if_eq(
+		::fcntl(fd, cmd),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL void w::fdatasync(int fd)
+{
+	CPPWRAP_INSTRUMENT(fdatasync);
+
+	w::throw_if_ne(
+		::fdatasync(fd),
+		0,
+		"failed to synchronize file data");
+}
+
+CPPWRAP_DECL void w::fdatasync(int fd, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(fdatasync, ec);
+
+	w::error_if_ne(
+		::fdatasync(fd),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL struct stat w::fstat(int fd)
+{
+	CPPWRAP_INSTRUMENT(fstat);
+
+	struct stat statbuf;
+	w::throw_if_ne(
+		::fstat(fd, &statbuf),
+		0,
+		"failed to get file status");
+	return statbuf;
+}
+
+CPPWRAP_DECL struct stat w::fstat(int fd, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(fstat, ec);
+
+	struct stat statbuf { };
+	w::error_if_ne(
+		::fstat(fd, &statbuf),
+		0,
+		ec);
+	return statbuf;
+}
+
+CPPWRAP_DECL void w::fsync(int fd)
+{
+	CPPWRAP_INSTRUMENT(fsync);
+
+	w::throw_if_ne(
+		::fsync(fd),
+		0,
+		"failed to synchronize file");
+}
+
+CPPWRAP_DECL void w::fsync(int fd, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(fsync, ec);
+
+	w::error_if_ne(
+		::fsync(fd),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::ftruncate(int fd, off_t length)
+{
+	CPPWRAP_INSTRUMENT(ftruncate);
+
+	w::throw_if_ne(
+		::ftruncate(fd, length),
+		0,
+		"failed to truncate file");
+}
+
+CPPWRAP_DECL void w::ftruncate(int fd, off_t length, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(ftruncate, ec);
+
+	w::error_if_ne(
+		::ftruncate(fd, length),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL int w::ioctl(int fd, unsigned long request, void *arg)
+{
+	CPPWRAP_INSTRUMENT(ioctl);
+
+	return w::throw_if_lt(
+		::ioctl(fd, request, arg),
+		0,
+		"ioctl failed");
+}
+
+CPPWRAP_DECL int w::ioctl(int fd, unsigned long request, void *arg, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(ioctl, ec);
+
+	return w::error_if_lt(
+		::ioctl(fd, request, arg),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL int w::ioctl(int fd, unsigned long request, const void *arg)
+{
+	CPPWRAP_INSTRUMENT(ioctl);
+
+	return w::throw_if_lt(
+		::ioctl(fd, request, arg),
+		0,
+		"ioctl failed");
+}
+
+CPPWRAP_DECL int w::ioctl(int fd, unsigned long request, const void *arg, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(ioctl, ec);
+
+	return w::error_if_lt(
+		::ioctl(fd, request, arg),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::linkat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath, int flags)
+{
+	CPPWRAP_INSTRUMENT(linkat);
+
+	w::throw_if_ne(
+		::linkat(olddirfd, oldpath, newdirfd, newpath, flags),
+		0,
+		"failed to create link");
+}
+
+CPPWRAP_DECL void w::linkat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath, int flags,
+		std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(linkat, ec);
+
+	w::error_if_ne(
+		::linkat(olddirfd, oldpath, newdirfd, newpath, flags),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL std::size_t w::lseek(int fd, off_t offset, int whence)
+{
+	CPPWRAP_INSTRUMENT(lseek);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			::lseek(fd, offset, whence),
+			static_cast<off_t>(0),
+			"lseek failed"));
+}
+
+CPPWRAP_DECL std::size_t w::lseek(int fd, off_t offset, int whence, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(lseek, ec);
+
+	off_t rv = w::error_if_lt(
+		::lseek(fd, offset, whence),
+		static_cast<off_t>(0),
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL void w::madvise(void *address, std::size_t length, int advice)
+{
+	CPPWRAP_INSTRUMENT(madvise);
+
+	w::throw_if_ne(
+		::madvise(address, length, advice),
+		0,
+		"failed to give memory usage advice");
+}
+
+CPPWRAP_DECL void w::madvise(void *address, std::size_t length, int advice, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(madvise, ec);
+
+	w::error_if_ne(
+		::madvise(address, length, advice),
+		0,
+		ec);
+}
+
+#if (__cplusplus >= 201709L)
+__attribute__((visibility("default"))) CPPWRAP_DECL
+w::mmap_handle w::mmap(void *address, std::size_t length, int prot, int flags, int fd, off_t offset)
+{
+	CPPWRAP_INSTRUMENT(mmap);
+
+	void *actual_address = ::mmap(address, length, prot, flags, fd, offset);
+	w::throw_if_eq<void *>(actual_address, MAP_FAILED, "failed to map file or device into memory");
+	return w::memory_region { actual_address, length };
+}
+
+__attribute__((visibility("default"))) CPPWRAP_DECL
+w::mmap_handle w::mmap(void *address, std::size_t length, int prot, int flags, int fd, off_t offset,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(mmap, ec);
+
+	void *actual_address = ::mmap(address, length, prot, flags, fd, offset);
+	w::error_if_eq<void *>(actual_address, MAP_FAILED, ec);
+	return ec ? w::memory_region { } : w::memory_region { actual_address, length };
+}
+#endif
+
+CPPWRAP_DECL void w::mlock(const void *addr, std::size_t len)
+{
+	CPPWRAP_INSTRUMENT(mlock);
+
+	w::throw_if_ne(
+		::mlock(addr, len),
+		0,
+		"failed to lock memory");
+}
+
+CPPWRAP_DECL void w::mlock(const void *addr, std::size_t len, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(mlock, ec);
+
+	w::error_if_ne(
+		::mlock(addr, len),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::munlock(const void *addr, std::size_t len)
+{
+	CPPWRAP_INSTRUMENT(munlock);
+
+	w::throw_if_ne(
+		::munlock(addr, len),
+		0,
+		"failed to unlock memory");
+}
+
+CPPWRAP_DECL void w::munlock(const void *addr, std::size_t len, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(munlock, ec);
+
+	w::error_if_ne(
+		::munlock(addr, len),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL w::fd w::open(const char *pathname, int flags)
+{
+	CPPWRAP_INSTRUMENT(open);
+
+	return w::throw_if_eq(
+		::open(pathname, flags),
+		-1,
+		"failed to open file");
+}
+
+CPPWRAP_DECL w::fd w::open(const char *pathname, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(open, ec);
+
+	return w::error_if_eq(
+		::open(pathname, flags),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL w::fd w::open(const char *pathname, int flags, mode_t mode)
+{
+	CPPWRAP_INSTRUMENT(open);
+
+	return w::throw_if_eq(
+		::open(pathname, flags, mode),
+		-1,
+		"failed to open file");
+}
+
+CPPWRAP_DECL w::fd w::open(const char *pathname, int flags, mode_t mode, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(open, ec);
+
+	return w::error_if_eq(
+		::open(pathname, flags, mode),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL std::pair<w::fd, w::fd> w::pipe()
+{
+	CPPWRAP_INSTRUMENT(pipe);
+
+	int fds[2];
+
+	w::throw_if_ne(
+		::pipe(fds),
+		0,
+		"failed to create pipe");
+
+	return std::make_pair(fds[0], fds[1]);
+}
+
+CPPWRAP_DECL std::pair<w::fd, w::fd> w::pipe(std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(pipe, ec);
+
+	int fds[2] = { -1, -1 };
+
+	w::error_if_ne(
+		::pipe(fds),
+		0,
+		ec);
+
+	return std::make_pair(fds[0], fds[1]);
+}
+
+CPPWRAP_DECL unsigned w::poll(struct pollfd *fds, nfds_t nfds, std::chrono::milliseconds timeout)
+{
+	CPPWRAP_INSTRUMENT(poll);
+
+	if (timeout.count() < std::numeric_limits<int>::min() ||
+		timeout.count() > std::numeric_limits<int>::max())
+		throw std::invalid_argument("invalid timeout for poll");
+
+	return w::throw_if_lt(
+		::poll(fds, nfds, static_cast<int>(timeout.count())),
+		0,
+		"failed to poll file descriptors");
+}
+
+CPPWRAP_DECL unsigned w::poll(struct pollfd *fds, nfds_t nfds, std::chrono::milliseconds timeout,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(poll, ec);
+
+	if (timeout.count() < std::numeric_limits<int>::min() ||
+		timeout.count() > std::numeric_limits<int>::max())
+	{
+		ec = std::make_error_code(std::errc::invalid_argument);
+		return 0;
+	}
+
+	int rv = w::error_if_lt(
+		::poll(fds, nfds, static_cast<int>(timeout.count())),
+		0,
+		ec);
+
+	return ec ? 0 : static_cast<unsigned>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::pread(int fd, void *buf, std::size_t count, off_t offset)
+{
+	CPPWRAP_INSTRUMENT(pread);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::pread(fd, buf, count, offset)),
+			ssize_t { 0 },
+			"read error"));
+}
+
+CPPWRAP_DECL std::size_t w::pread(int fd, void *buf, std::size_t count, off_t offset,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(pread, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::pread(fd, buf, count, offset)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::pwrite(int fd, const void *buf, std::size_t count, off_t offset)
+{
+	CPPWRAP_INSTRUMENT(pwrite);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::pwrite(fd, buf, count, offset)),
+			ssize_t { 0 },
+			"write error"));
+}
+
+CPPWRAP_DECL std::size_t w::pwrite(int fd, const void *buf, std::size_t count, off_t offset,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(pwrite, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::pwrite(fd, buf, count, offset)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::read(int fd, void *buf, std::size_t count)
+{
+	CPPWRAP_INSTRUMENT(read);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::read(fd, buf, count)),
+			ssize_t { 0 },
+			"read error"));
+}
+
+CPPWRAP_DECL std::size_t w::read(int fd, void *buf, std::size_t count, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(read, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::read(fd, buf, count)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::readv(int fd, const struct iovec *iov, int iovcnt)
+{
+	CPPWRAP_INSTRUMENT(readv);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::readv(fd, iov, iovcnt)),
+			ssize_t { 0 },
+			"read error"));
+}
+
+CPPWRAP_DECL std::size_t w::readv(int fd, const struct iovec *iov, int iovcnt, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(readv, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::readv(fd, iov, iovcnt)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL void w::rename(const char *oldpath, const char *newpath)
+{
+	CPPWRAP_INSTRUMENT(rename);
+
+	w::throw_if_ne(
+		::rename(oldpath, newpath),
+		0,
+		"failed to rename file");
+}
+
+CPPWRAP_DECL void w::rename(const char *oldpath, const char *newpath, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(rename, ec);
+
+	w::error_if_ne(
+		::rename(oldpath, newpath),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::renameat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath)
+{
+	CPPWRAP_INSTRUMENT(renameat);
+
+	w::throw_if_ne(
+		::renameat(olddirfd, oldpath, newdirfd, newpath),
+		0,
+		"failed to rename file");
+}
+
+CPPWRAP_DECL void w::renameat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath,
+		std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(renameat, ec);
+
+	w::error_if_ne(
+		::renameat(olddirfd, oldpath, newdirfd, newpath),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::unlink(const char *pathname)
+{
+	CPPWRAP_INSTRUMENT(unlink);
+
+	w::throw_if_ne(
+		::unlink(pathname),
+		0,
+		"failed to remove file");
+}
+
+CPPWRAP_DECL void w::unlink(const char *pathname, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(unlink, ec);
+
+	w::error_if_ne(
+		::unlink(pathname),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::unlinkat(int dirfd, const char *pathname, int flags)
+{
+	CPPWRAP_INSTRUMENT(unlinkat);
+
+	w::throw_if_ne(
+		::unlinkat(dirfd, pathname, flags),
+		0,
+		"failed to remove file");
+}
+
+CPPWRAP_DECL void w::unlinkat(int dirfd, const char *pathname, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(unlinkat, ec);
+
+	w::error_if_ne(
+		::unlinkat(dirfd, pathname, flags),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL std::size_t w::write(int fd, const void *buf, std::size_t count)
+{
+	CPPWRAP_INSTRUMENT(write);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::write(fd, buf, count)),
+			ssize_t { 0 },
+			"write error"));
+}
+
+CPPWRAP_DECL std::size_t w::write(int fd, const void *buf, std::size_t count, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(write, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::write(fd, buf, count)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::writev(int fd, const struct iovec *iov, int iovcnt)
+{
+	CPPWRAP_INSTRUMENT(writev);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::writev(fd, iov, iovcnt)),
+			ssize_t { 0 },
+			"write error"));
+}
+
+CPPWRAP_DECL std::size_t w::writev(int fd, const struct iovec *iov, int iovcnt, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(writev, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::writev(fd, iov, iovcnt)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
@@ -0,0 +1,588 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <ifaddrs.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <w/assert.hpp>
+#include <w/config.hpp>
+#include <w/handle.hpp>
+#include <w/instrumentation.hpp>
+#include <w/posix.hpp>
+#include <w/sockets.hpp>
+
+CPPWRAP_DECL w::ipv4_address::ipv4_address(std::uint16_t port)
+{
+	sin_family = AF_INET;
+	sin_port = htons(port);
+	sin_addr.s_addr = INADDR_ANY;
+	std::memset(sin_zero, 0, sizeof(sin_zero));
+}
+
+CPPWRAP_DECL w::ipv4_address::ipv4_address(const char *address, std::uint16_t port)
+{
+	sin_family = AF_INET;
+	w::inet_pton(AF_INET, address, sin_addr);
+	sin_port = htons(port);
+	std::memset(sin_zero, 0, sizeof(sin_zero));
+}
+
+CPPWRAP_DECL w::ipv4_address::ipv4_address(const in_addr& address, std::uint16_t port)
+{
+	sin_family = AF_INET;
+	sin_addr = address;
+	sin_port = htons(port);
+	std::memset(sin_zero, 0, sizeof(sin_zero));
+}
+
+CPPWRAP_DECL w::ipv6_address::ipv6_address(std::uint16_t port)
+{
+	sin6_family = AF_INET6;
+	sin6_port = htons(port);
+	sin6_flowinfo = { };
+	std::memset(&sin6_addr, 0, sizeof(sin6_addr));
+	sin6_scope_id = 0;
+}
+
+CPPWRAP_DECL w::ipv6_address::ipv6_address(const char *address, std::uint16_t port)
+	: ipv6_address(address, port, 0u)
+{
+}
+
+CPPWRAP_DECL w::ipv6_address::ipv6_address(const char *address, std::uint16_t port, const char *interface_name)
+	: ipv6_address(address, port, w::if_nametoindex(interface_name))
+{
+}
+
+CPPWRAP_DECL w::ipv6_address::ipv6_address(const char *address, std::uint16_t port, unsigned interface_index)
+{
+	sin6_family = AF_INET6;
+	sin6_port = htons(port);
+	sin6_flowinfo = { };
+	w::inet_pton(AF_INET6, address, sin6_addr);
+	sin6_scope_id = interface_index;
+}
+
+
+CPPWRAP_DECL w::ipv6_address::ipv6_address(const in6_addr& address, std::uint16_t port)
+	: ipv6_address(address, port, 0u)
+{
+}
+
+CPPWRAP_DECL w::ipv6_address::ipv6_address(const in6_addr& address, std::uint16_t port, const char *interface_name)
+	: ipv6_address(address, port, w::if_nametoindex(interface_name))
+{
+}
+
+CPPWRAP_DECL w::ipv6_address::ipv6_address(const in6_addr& address, std::uint16_t port, unsigned interface_index)
+{
+	sin6_family = AF_INET6;
+	sin6_port = htons(port);
+	sin6_flowinfo = { };
+	sin6_addr = address;
+	sin6_scope_id = interface_index;
+}
+
+CPPWRAP_DECL w::unix_domain_address::unix_domain_address(const char *path)
+{
+	sun_family = AF_UNIX;
+
+	std::strncpy(sun_path, path, sizeof(sun_path));
+	if (sun_path[sizeof(sun_path) - 1] != '\0')
+		throw std::invalid_argument("UNIX domain socket path is too long");
+}
+
+CPPWRAP_DECL w::fd w::accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
+{
+	CPPWRAP_INSTRUMENT(accept);
+
+	return w::throw_if_eq(
+		::accept(sockfd, addr, addrlen),
+		-1,
+		"failed to accept connection on socket");
+}
+
+CPPWRAP_DECL w::fd w::accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(accept, ec);
+
+	return w::error_if_eq(
+		::accept(sockfd, addr, addrlen),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL w::fd w::accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags)
+{
+	CPPWRAP_INSTRUMENT(accept4);
+
+	return w::throw_if_eq(
+		::accept4(sockfd, addr, addrlen, flags),
+		-1,
+		"failed to accept connection on socket");
+}
+
+CPPWRAP_DECL w::fd w::accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(accept4, ec);
+
+	return w::error_if_eq(
+		::accept4(sockfd, addr, addrlen, flags),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL void w::bind(int sockfd, const struct sockaddr *addr, socklen_t addrlen)
+{
+	CPPWRAP_INSTRUMENT(bind);
+
+	w::throw_if_ne(
+		::bind(sockfd, addr, addrlen),
+		0,
+		"failed to bind socket");
+}
+
+CPPWRAP_DECL void w::bind(int sockfd, const struct sockaddr *addr, socklen_t addrlen, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(bind, ec);
+
+	w::error_if_ne(
+		::bind(sockfd, addr, addrlen),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL void w::connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen)
+{
+	CPPWRAP_INSTRUMENT(connect);
+
+	w::throw_if_ne(
+		::connect(sockfd, addr, addrlen),
+		0,
+		"failed to connect socket");
+}
+
+CPPWRAP_DECL void w::connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(connect, ec);
+
+	w::error_if_ne(
+		::connect(sockfd, addr, addrlen),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL w::handle<struct ifaddrs *, nullptr, ::freeifaddrs> w::getifaddrs()
+{
+	CPPWRAP_INSTRUMENT(getifaddrs);
+
+	struct ifaddrs *ifa;
+
+	w::throw_if_nz(
+		::getifaddrs(&ifa),
+		"failed to get list of network interfaces");
+
+	return ifa;
+}
+
+CPPWRAP_DECL w::handle<struct ifaddrs *, nullptr, ::freeifaddrs> w::getifaddrs(std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(getifaddrs, ec);
+
+	struct ifaddrs *ifa = nullptr;
+
+	w::error_if_nz(
+		::getifaddrs(&ifa),
+		ec);
+
+	return ec ? nullptr : ifa;
+}
+
+CPPWRAP_DECL void w::getsockname(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
+{
+	CPPWRAP_INSTRUMENT(getsockname);
+
+	w::throw_if_ne(
+		::getsockname(sockfd, addr, addrlen),
+		0,
+		"failed to get socket address");
+}
+
+CPPWRAP_DECL int w::getsockopt(int sockfd, int level, int optname,
+	void *optval, socklen_t *optlen)
+{
+	CPPWRAP_INSTRUMENT(getsockopt);
+
+	return w::throw_if_eq(
+		::getsockopt(sockfd, level, optname, optval, optlen),
+		-1,
+		"failed to get socket option");
+}
+
+CPPWRAP_DECL int w::getsockopt(int sockfd, int level, int optname,
+	void *optval, socklen_t *optlen, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(getsockopt, ec);
+
+	return w::error_if_eq(
+		::getsockopt(sockfd, level, optname, optval, optlen),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL unsigned w::if_nametoindex(const char *ifname)
+{
+	CPPWRAP_INSTRUMENT(if_nametoindex);
+
+	return w::throw_if_eq(
+		::if_nametoindex(ifname),
+		0u,
+		(std::string("failed to look up index of network interface '") + ifname + '\'').c_str());
+}
+
+CPPWRAP_DECL unsigned w::if_nametoindex(const char *ifname, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(if_nametoindex, ec);
+
+	return w::error_if_eq(
+		::if_nametoindex(ifname),
+		0u,
+		ec);
+}
+
+CPPWRAP_DECL char *w::inet_ntop(int af, const void *src, char *dst, socklen_t size)
+{
+	w::throw_if_eq(
+		::inet_ntop(af, src, dst, size),
+		static_cast<const char *>(nullptr),
+		"failed to stringify IPv4/IPv6 address");
+
+	return dst;
+}
+
+CPPWRAP_DECL char *w::inet_ntop(int af, const void *src, char *dst, socklen_t size, std::error_code& ec) noexcept
+{
+	w::error_if_eq(
+		::inet_ntop(af, src, dst, size),
+		static_cast<const char *>(nullptr),
+		ec);
+
+	return ec ? nullptr : dst;
+}
+
+CPPWRAP_DECL void *w::inet_pton(int af, const char *src, void *dst)
+{
+	int rv = ::inet_pton(af, src, dst);
+
+	if (rv == 0)
+		errno = EINVAL;
+
+	w::throw_if_ne(
+		rv,
+		1,
+		"failed to parse IPv4/IPv6 address string");
+
+	return dst;
+}
+
+CPPWRAP_DECL void *w::inet_pton(int af, const char *src, void *dst, std::error_code& ec) noexcept
+{
+	int rv = ::inet_pton(af, src, dst);
+
+	if (rv == 0)
+		errno = EINVAL;
+
+	w::error_if_ne(
+		rv,
+		1,
+		ec);
+
+	return ec ? nullptr : dst;
+}
+
+CPPWRAP_DECL void w::listen(int sockfd, int backlog)
+{
+	CPPWRAP_INSTRUMENT(listen);
+
+	w::throw_if_ne(
+		::listen(sockfd, backlog),
+		0,
+		"failed to put socket in listening state");
+}
+
+CPPWRAP_DECL void w::listen(int sockfd, int backlog, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(listen, ec);
+
+	w::error_if_ne(
+		::listen(sockfd, backlog),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL std::size_t w::recv(int sockfd, void *buf, std::size_t len, int flags)
+{
+	CPPWRAP_INSTRUMENT(recv);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::recv(sockfd, buf, len, flags)),
+			ssize_t { 0 },
+			"failed to receive from socket"));
+}
+
+CPPWRAP_DECL std::size_t w::recv(int sockfd, void *buf, std::size_t len, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(recv, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::recv(sockfd, buf, len, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::recvmsg(int sockfd, struct msghdr *msg, int flags)
+{
+	CPPWRAP_INSTRUMENT(recvmsg);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::recvmsg(sockfd, msg, flags)),
+			ssize_t { 0 },
+			"failed to receive message from socket"));
+}
+
+CPPWRAP_DECL std::size_t w::recvmsg(int sockfd, struct msghdr *msg, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(recvmsg, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::recvmsg(sockfd, msg, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL unsigned w::recvmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags,
+	struct timespec *timeout)
+{
+	CPPWRAP_INSTRUMENT(recvmmsg);
+
+	return static_cast<unsigned>(
+		w::throw_if_lt(
+			::recvmmsg(sockfd, msgvec, vlen, flags, timeout),
+			0,
+			"failed to receive messages from socket"));
+}
+
+CPPWRAP_DECL unsigned w::recvmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags,
+	struct timespec *timeout, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(recvmmsg, ec);
+
+	int rv = w::error_if_lt(
+		::recvmmsg(sockfd, msgvec, vlen, flags, timeout),
+		0,
+		ec);
+
+	return ec ? 0 : static_cast<unsigned>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::recvfrom(int sockfd, void *buf, std::size_t len, int flags,
+	struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	CPPWRAP_INSTRUMENT(recvfrom);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::recvfrom(sockfd, buf, len, flags, src_addr, addrlen)),
+			ssize_t { 0 },
+			"failed to receive from socket with source address"));
+}
+
+CPPWRAP_DECL std::size_t w::recvfrom(int sockfd, void *buf, std::size_t len, int flags,
+	struct sockaddr *src_addr, socklen_t *addrlen, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(recvfrom, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::recvfrom(sockfd, buf, len, flags, src_addr, addrlen)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::send(int sockfd, const void *buf, std::size_t len, int flags)
+{
+	CPPWRAP_INSTRUMENT(send);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::send(sockfd, buf, len, flags)),
+			ssize_t { 0 },
+			"failed to send to socket"));
+}
+
+CPPWRAP_DECL std::size_t w::send(int sockfd, const void *buf, std::size_t len, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(send, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::send(sockfd, buf, len, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::sendmsg(int sockfd, const struct msghdr *msg, int flags)
+{
+	CPPWRAP_INSTRUMENT(sendmsg);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::sendmsg(sockfd, msg, flags)),
+			ssize_t { 0 },
+			"failed to send message to socket"));
+}
+
+CPPWRAP_DECL std::size_t w::sendmsg(int sockfd, const struct msghdr *msg, int flags, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(sendmsg, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::sendmsg(sockfd, msg, flags)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL unsigned w::sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags)
+{
+	CPPWRAP_INSTRUMENT(sendmmsg);
+
+	return static_cast<unsigned>(
+		w::throw_if_lt(
+			::sendmmsg(sockfd, msgvec, vlen, flags),
+			0,
+			"failed to send messages to socket"));
+}
+
+CPPWRAP_DECL unsigned w::sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags,
+	std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(sendmmsg, ec);
+
+	int rv = w::error_if_lt(
+		::sendmmsg(sockfd, msgvec, vlen, flags),
+		0,
+		ec);
+
+	return ec ? 0 : static_cast<unsigned>(rv);
+}
+
+CPPWRAP_DECL std::size_t w::sendto(int sockfd, const void *buf, std::size_t len,
+	int flags, const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	CPPWRAP_INSTRUMENT(sendto);
+
+	return static_cast<std::size_t>(
+		w::throw_if_lt(
+			CPPWRAP_INSTRUMENT_BYTES(::sendto(sockfd, buf, len, flags, dest_addr, addrlen)),
+			ssize_t { 0 },
+			"failed to send to socket with destination address"));
+}
+
+CPPWRAP_DECL std::size_t w::sendto(int sockfd, const void *buf, std::size_t len,
+	int flags, const struct sockaddr *dest_addr, socklen_t addrlen, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(sendto, ec);
+
+	ssize_t rv = w::error_if_lt(
+		CPPWRAP_INSTRUMENT_BYTES(::sendto(sockfd, buf, len, flags, dest_addr, addrlen)),
+		ssize_t { 0 },
+		ec);
+
+	return ec ? 0 : static_cast<std::size_t>(rv);
+}
+
+CPPWRAP_DECL int w::setsockopt(int sockfd, int level, int optname,
+	const void *optval, socklen_t optlen)
+{
+	CPPWRAP_INSTRUMENT(setsockopt);
+
+	return w::throw_if_eq(
+		::setsockopt(sockfd, level, optname, optval, optlen),
+		-1,
+		"failed to set socket option");
+}
+
+CPPWRAP_DECL int w::setsockopt(int sockfd, int level, int optname,
+	const void *optval, socklen_t optlen, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(setsockopt, ec);
+
+	return w::error_if_eq(
+		::setsockopt(sockfd, level, optname, optval, optlen),
+		-1,
+		ec);
+}
+
+CPPWRAP_DECL void w::shutdown(int sockfd, int how)
+{
+	CPPWRAP_INSTRUMENT(shutdown);
+
+	w::throw_if_ne(
+		::shutdown(sockfd, how),
+		0,
+		"failed to shut down socket");
+}
+
+CPPWRAP_DECL void w::shutdown(int sockfd, int how, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(shutdown, ec);
+
+	w::error_if_ne(
+		::shutdown(sockfd, how),
+		0,
+		ec);
+}
+
+CPPWRAP_DECL w::fd w::socket(int domain, int type, int protocol)
+{
+	CPPWRAP_INSTRUMENT(socket);
+
+	return w::throw_if_eq(
+		::socket(domain, type, protocol),
+		-1,
+		"failed to create socket");
+}
+
+CPPWRAP_DECL w::fd w::socket(int domain, int type, int protocol, std::error_code& ec) noexcept
+{
+	CPPWRAP_INSTRUMENT_EC(socket, ec);
+
+	return w::error_if_eq(
+		::socket(domain, type, protocol),
+		-1,
+		ec);
+}
@@ -0,0 +1,283 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/**
+ * Invokes a macro with the name of each instrumented wrapper.
+ *
+ * @param X The macro to invoke.
+ */
+#define CPPWRAP_INSTRUMENTED_WRAPPERS(X) \
+	X(accept) X(accept4) X(bind) X(close_range) X(connect) X(copy_file_range) X(epoll_create) \
+	X(epoll_create1) X(epoll_ctl) X(epoll_wait) X(eventfd) X(eventfd_read) X(eventfd_write) \
+	X(fallocate) X(fcntl) X(fdatasync) X(fstat) X(fsync) X(ftruncate) X(getifaddrs) \
+	X(getsockname) X(getsockopt) X(if_nametoindex) X(io_uring_enter) X(io_uring_register) \
+	X(io_uring_setup) X(ioctl) X(linkat) X(listen) X(lseek) X(madvise) X(mbind) \
+	X(memfd_create) X(mlock) X(mlock2) X(mmap) X(mremap) X(munlock) X(open) X(pipe) X(poll) \
+	X(pread) X(pwrite) X(read) X(readv) X(recv) X(recvfrom) X(recvmmsg) X(recvmsg) X(rename) \
+	X(renameat) X(sched_getaffinity) X(sched_setaffinity) X(send) X(sendfile) X(sendmmsg) \
+	X(sendmsg) X(sendto) X(setsockopt) X(shutdown) X(socket) X(splice) X(syncfs) X(tee) \
+	X(timerfd_create) X(timerfd_settime) X(unlink) X(unlinkat) X(vmsplice) X(write) X(writev)
+
+/**
+ * Instrumentation of the w:: wrappers, available when the library is built with
+ * `ENABLE_INSTRUMENTATION` (which defines `CPPWRAP_INSTRUMENTATION` for the library and its
+ * users).
+ *
+ * @remarks Each wrapper records, per calling thread, the number of calls, the number of
+ *          failures by errno class, the number of bytes moved (for wrappers which return a byte
+ *          count, such as read() and send()), and a histogram of call latencies. The counters
+ *          live in a block of cache-line-aligned slots allocated for each thread on its first
+ *          wrapped call (about 64 KiB), and are only ever written by that thread, with relaxed
+ *          atomic stores and no read-modify-write instructions. snapshot() sums the blocks of
+ *          all live threads and the totals of exited threads.
+ *
+ *          Latencies are measured with `std::chrono::steady_clock` and kept in log-linear
+ *          buckets: four linear buckets per power of two nanoseconds, so each bucket is within
+ *          25% of its lower bound, up to about 17 seconds.
+ *
+ *          Counters are never reset; to measure an interval, take the difference of two
+ *          snapshots. Without `ENABLE_INSTRUMENTATION`, the wrappers are not instrumented and
+ *          these functions are not built.
+ */
+namespace w::instrumentation
+{
+	/**
+	 * An instrumented wrapper. All overloads of a wrapper share a site.
+	 */
+	enum class site : unsigned
+	{
+#define CPPWRAP_SITE(name) name,
+		CPPWRAP_INSTRUMENTED_WRAPPERS(CPPWRAP_SITE)
+#undef CPPWRAP_SITE
+	};
+
+	/**
+	 * The number of instrumented wrappers.
+	 */
+	inline constexpr std::size_t site_count = 0
+#define CPPWRAP_SITE(name) + 1
+		CPPWRAP_INSTRUMENTED_WRAPPERS(CPPWRAP_SITE)
+#undef CPPWRAP_SITE
+		;
+
+	/**
+	 * A class of errno values.
+	 */
+	enum class error_class : unsigned
+	{
+		would_block,	///< `EAGAIN`/`EWOULDBLOCK`.
+		interrupted,	///< `EINTR`.
+		in_progress,	///< `EINPROGRESS`, `EALREADY`.
+		connection,		///< Connection and network errors, such as `ECONNRESET` and `EPIPE`.
+		resource,		///< Resource exhaustion, such as `EMFILE` and `ENOMEM`.
+		permission,		///< `EACCES`, `EPERM`.
+		not_found,		///< `ENOENT` and similar.
+		invalid,		///< Invalid arguments, such as `EINVAL` and `EBADF`.
+		other,			///< Anything else.
+	};
+
+	/**
+	 * The number of errno classes.
+	 */
+	inline constexpr std::size_t error_class_count = 9;
+
+	/**
+	 * The number of latency histogram buckets.
+	 */
+	inline constexpr std::size_t histogram_buckets = 132;
+
+	/**
+	 * The counters of a wrapper, summed over all threads.
+	 */
+	struct site_snapshot
+	{
+		/**
+		 * The wrapper.
+		 */
+		w::instrumentation::site site;
+
+		/**
+		 * The number of calls.
+		 */
+		std::uint64_t calls;
+
+		/**
+		 * The number of calls which failed.
+		 */
+		std::uint64_t errors;
+
+		/**
+		 * The number of bytes moved by successful calls, for wrappers which return a byte
+		 * count.
+		 */
+		std::uint64_t bytes;
+
+		/**
+		 * The number of calls which failed, by errno class.
+		 */
+		std::array<std::uint64_t, error_class_count> errors_by_class;
+
+		/**
+		 * The number of calls by latency bucket; see bucket_lower_bound().
+		 */
+		std::array<std::uint64_t, histogram_buckets> latency;
+
+		/**
+		 * Estimates a latency percentile.
+		 *
+		 * @param p The percentile, from 0 to 100.
+		 * @return The lower bound of the bucket holding the percentile, or zero if there
+		 *         were no calls.
+		 */
+		std::chrono::nanoseconds percentile(double p) const noexcept;
+	};
+
+	/**
+	 * Gets the class of an errno value.
+	 *
+	 * @param errnum The errno value.
+	 * @return The class of @p errnum.
+	 */
+	error_class classify(int errnum) noexcept;
+
+	/**
+	 * Gets the name of a wrapper.
+	 *
+	 * @param s The wrapper.
+	 * @return The name of the wrapper, without namespace.
+	 */
+	const char *name(site s) noexcept;
+
+	/**
+	 * Gets the name of an errno class.
+	 *
+	 * @param c The errno class.
+	 * @return The name of the errno class, which matches its enumerator.
+	 */
+	const char *name(error_class c) noexcept;
+
+	/**
+	 * Gets the lower bound of a latency histogram bucket.
+	 *
+	 * @param bucket The index of the bucket.
+	 * @return The smallest latency counted in the bucket.
+	 */
+	std::chrono::nanoseconds bucket_lower_bound(std::size_t bucket) noexcept;
+
+	/**
+	 * Takes a snapshot of the counters of all threads.
+	 *
+	 * @return The counters of each wrapper which has been called at least once, in the order
+	 *         of the site enumeration.
+	 */
+	std::vector<site_snapshot> snapshot();
+
+	/**
+	 * Formats a snapshot as a JSON object, of the form
+	 * `{"sites":[{"name":"read","calls":10,"errors":1,"bytes":4096,"errors_by_class":{"would_block":1},"latency_ns":{"p50":512,"p90":1024,"p99":2048,"max":2560},"histogram":[[512,6],...]},...]}`,
+	 * where `errors_by_class` and `histogram` only list nonzero counts, and each histogram
+	 * entry is a bucket lower bound and a count.
+	 *
+	 * @param sites The snapshot.
+	 * @return The JSON text.
+	 */
+	std::string to_json(std::span<const site_snapshot> sites);
+}
+
+/// @cond
+#ifdef CPPWRAP_INSTRUMENTATION
+
+namespace w::instrumentation::detail
+{
+	void record(site s, std::chrono::steady_clock::duration elapsed, int errnum, std::uint64_t bytes) noexcept;
+
+	class scope
+	{
+		public:
+
+			explicit scope(site s) noexcept
+				: _site(s),
+				  _ec(nullptr),
+				  _exceptions(std::uncaught_exceptions()),
+				  _bytes(0),
+				  _start(std::chrono::steady_clock::now())
+			{
+			}
+
+			scope(site s, const std::error_code *ec) noexcept
+				: _site(s),
+				  _ec(ec),
+				  _exceptions(0),
+				  _bytes(0),
+				  _start(std::chrono::steady_clock::now())
+			{
+			}
+
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+
+			~scope()
+			{
+				int errnum = 0;
+
+				// A throwing wrapper fails by throwing, and leaves errno as the call set it; a
+				// non-throwing wrapper reports the error through its error code.
+
+				if (_ec)
+					errnum = *_ec ? _ec->value() : 0;
+				else if (std::uncaught_exceptions() > _exceptions)
+					errnum = errno ? errno : -1;
+
+				record(_site, std::chrono::steady_clock::now() - _start, errnum, _bytes);
+			}
+
+			template <typename T>
+			T bytes(T result) noexcept
+			{
+				if (result > 0)
+					_bytes = static_cast<std::uint64_t>(result);
+
+				return result;
+			}
+
+		private:
+
+			site _site;
+			const std::error_code *_ec;
+			int _exceptions;
+			std::uint64_t _bytes;
+			std::chrono::steady_clock::time_point _start;
+	};
+}
+
+#define CPPWRAP_INSTRUMENT(name) \
+	::w::instrumentation::detail::scope cppwrap_instrumentation_scope(::w::instrumentation::site::name)
+#define CPPWRAP_INSTRUMENT_EC(name, ec) \
+	::w::instrumentation::detail::scope cppwrap_instrumentation_scope(::w::instrumentation::site::name, &(ec))
+#define CPPWRAP_INSTRUMENT_BYTES(call) \
+	cppwrap_instrumentation_scope.bytes(call)
+
+#else
+
+#define CPPWRAP_INSTRUMENT(name) static_cast<void>(0)
+#define CPPWRAP_INSTRUMENT_EC(name, ec) static_cast<void>(0)
+#define CPPWRAP_INSTRUMENT_BYTES(call) (call)
+
+#endif
+/// @endcond
@@ -0,0 +1,478 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+#include <w/posix.hpp>
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace w
+{
+	/**
+	 * Creates an io_uring instance. Most callers should use the w::io_uring class instead, which
+	 * also maps the submission and completion rings.
+	 *
+	 * @param entries The requested number of submission queue entries.
+	 * @param p A pointer to a structure holding setup flags, which is filled in with the ring
+	 *        geometry on return.
+	 * @return The file descriptor for the io_uring instance.
+	 * @throw std::system_error An error occurred.
+	 */
+	w::fd io_uring_setup(unsigned entries, struct io_uring_params *p);
+
+	/**
+	 * Submits and/or waits for completion of I/O on an io_uring instance.
+	 *
+	 * @param fd The io_uring instance file descriptor.
+	 * @param to_submit The number of submission queue entries to submit.
+	 * @param min_complete The number of completions to wait for if @p flags includes
+	 *        `IORING_ENTER_GETEVENTS`.
+	 * @param flags A bitwise combination of flags.
+	 * @param sig A pointer to a signal mask to apply while waiting, or `nullptr`.
+	 * @return The number of submission queue entries consumed.
+	 * @throw std::system_error An error occurred.
+	 */
+	unsigned io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+		const sigset_t *sig = nullptr);
+
+	/**
+	 * Submits and/or waits for completion of I/O on an io_uring instance without throwing.
+	 *
+	 * @param fd The io_uring instance file descriptor.
+	 * @param to_submit The number of submission queue entries to submit.
+	 * @param min_complete The number of completions to wait for if @p flags includes
+	 *        `IORING_ENTER_GETEVENTS`.
+	 * @param flags A bitwise combination of flags.
+	 * @param sig A pointer to a signal mask to apply while waiting, or `nullptr`.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of submission queue entries consumed, or zero if an error occurred.
+	 */
+	unsigned io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+		const sigset_t *sig, std::error_code& ec) noexcept;
+
+	/**
+	 * Registers or unregisters resources with an io_uring instance.
+	 *
+	 * @param fd The io_uring instance file descriptor.
+	 * @param opcode The registration operation (e.g. `IORING_REGISTER_FILES`).
+	 * @param arg A pointer to an operation-specific argument.
+	 * @param nr_args The number of elements in the array pointed to by @p arg.
+	 * @return A nonnegative operation-specific result.
+	 * @throw std::system_error An error occurred.
+	 */
+	int io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args);
+
+	/**
+	 * An RAII io_uring instance, consisting of the io_uring file descriptor and its memory-mapped
+	 * submission queue, completion queue and submission queue entry array.
+	 *
+	 * @remarks Submission queue entries are obtained with get_sqe(), filled in with one of the
+	 *          `prep_*()` functions, and then submitted in a batch with a single call to
+	 *          submit(), which performs at most one `io_uring_enter()` system call regardless of
+	 *          how many entries were prepared. Completions are consumed without any system call
+	 *          using peek_cqe() and cqe_seen(), or for_each_cqe().
+	 *
+	 *          An instance must not be used concurrently from multiple threads. Setups using
+	 *          `IORING_SETUP_SQE128` or `IORING_SETUP_CQE32` are not supported.
+	 */
+	class io_uring
+	{
+		public:
+
+			/**
+			 * Creates an io_uring instance.
+			 *
+			 * @param entries The requested number of submission queue entries.
+			 * @param flags A bitwise combination of `IORING_SETUP_*` flags.
+			 * @throw std::system_error An error occurred.
+			 * @throw std::invalid_argument @p flags requests an unsupported ring layout.
+			 */
+			explicit io_uring(unsigned entries, unsigned flags = 0);
+
+			/**
+			 * Creates an io_uring instance.
+			 *
+			 * @param entries The requested number of submission queue entries.
+			 * @param params A reference to a structure holding setup flags and options, which is
+			 *        filled in with the ring geometry on return.
+			 * @throw std::system_error An error occurred.
+			 * @throw std::invalid_argument @p params requests an unsupported ring layout.
+			 */
+			io_uring(unsigned entries, struct io_uring_params& params);
+
+			io_uring(const io_uring&) = delete;
+			io_uring& operator=(const io_uring&) = delete;
+
+			/**
+			 * Gets the next free submission queue entry. The entry is zeroed, and is submitted
+			 * by the next call to submit().
+			 *
+			 * @return A pointer to the submission queue entry, or `nullptr` if the submission
+			 *         queue is full.
+			 */
+			struct io_uring_sqe *get_sqe() noexcept;
+
+			/**
+			 * Submits all submission queue entries obtained since the last submission, and
+			 * optionally waits for completions, using a single system call. If the ring uses
+			 * `IORING_SETUP_SQPOLL` and no completions are requested, the system call is
+			 * skipped unless the polling thread needs to be woken up.
+			 *
+			 * @param wait_nr The number of completions to wait for.
+			 * @return The number of submission queue entries submitted.
+			 * @throw std::system_error An error occurred.
+			 */
+			unsigned submit(unsigned wait_nr = 0);
+
+			/**
+			 * Submits all submission queue entries obtained since the last submission without
+			 * throwing.
+			 *
+			 * @param wait_nr The number of completions to wait for.
+			 * @param ec Set to the error which occurred, or cleared on success.
+			 * @return The number of submission queue entries submitted, or zero if an error
+			 *         occurred.
+			 */
+			unsigned submit(unsigned wait_nr, std::error_code& ec) noexcept;
+
+			/**
+			 * Gets the oldest unconsumed completion queue entry without waiting.
+			 *
+			 * @return A pointer to the completion queue entry, or `nullptr` if there is none.
+			 */
+			const struct io_uring_cqe *peek_cqe() noexcept;
+
+			/**
+			 * Gets the oldest unconsumed completion queue entry, waiting for one if necessary.
+			 *
+			 * @return A pointer to the completion queue entry.
+			 * @throw std::system_error An error occurred.
+			 */
+			const struct io_uring_cqe *wait_cqe();
+
+			/**
+			 * Marks the completion queue entry returned by peek_cqe() or wait_cqe() as
+			 * consumed, allowing the kernel to reuse its slot.
+			 */
+			void cqe_seen() noexcept { cq_advance(1); }
+
+			/**
+			 * Marks a number of completion queue entries as consumed.
+			 *
+			 * @param count The number of entries to consume.
+			 */
+			void cq_advance(unsigned count) noexcept
+			{
+				std::atomic_ref<unsigned>(*_cq_head).store(*_cq_head + count, std::memory_order_release);
+			}
+
+			/**
+			 * Invokes a callback for every available completion queue entry, then marks them
+			 * all as consumed in a single update of the completion queue head.
+			 *
+			 * @tparam Callback The type of @p cb.
+			 * @param cb A callable taking a `const io_uring_cqe&`. If it throws, the entries
+			 *        processed before the exception (including the current one) are consumed and
+			 *        the exception is propagated.
+			 * @return The number of entries processed.
+			 */
+			template <typename Callback>
+			unsigned for_each_cqe(Callback&& cb)
+			{
+				const unsigned head = *_cq_head;
+				const unsigned tail = std::atomic_ref<unsigned>(*_cq_tail).load(std::memory_order_acquire);
+				unsigned i = head;
+
+				try
+				{
+					for (; i != tail; ++i)
+						cb(static_cast<const struct io_uring_cqe&>(_cqes[i & _cq_mask]));
+				}
+				catch (...)
+				{
+					cq_advance(i - head + 1);
+					throw;
+				}
+
+				cq_advance(tail - head);
+				return tail - head;
+			}
+
+			/**
+			 * Gets the number of free submission queue entries.
+			 *
+			 * @return The number of entries which can be obtained with get_sqe() before the
+			 *         submission queue is full.
+			 */
+			unsigned sq_space_left() const noexcept;
+
+			/**
+			 * Gets the number of available completion queue entries.
+			 *
+			 * @return The number of unconsumed completion queue entries.
+			 */
+			unsigned cq_ready() const noexcept;
+
+			/**
+			 * Registers a set of file descriptors with the ring. Submission queue entries may
+			 * then refer to them by index by setting `IOSQE_FIXED_FILE` in their flags.
+			 *
+			 * @param fds A pointer to an array of file descriptors.
+			 * @param count The number of elements in the array pointed to by @p fds.
+			 * @throw std::system_error An error occurred.
+			 */
+			void register_files(const int *fds, unsigned count);
+
+			/**
+			 * Unregisters all file descriptors registered with register_files().
+			 *
+			 * @throw std::system_error An error occurred.
+			 */
+			void unregister_files();
+
+			/**
+			 * Registers a set of buffers with the ring, for use with prep_read_fixed() and
+			 * prep_write_fixed().
+			 *
+			 * @param iov A pointer to an array of structures describing the buffers.
+			 * @param count The number of elements in the array pointed to by @p iov.
+			 * @throw std::system_error An error occurred.
+			 */
+			void register_buffers(const struct iovec *iov, unsigned count);
+
+			/**
+			 * Unregisters all buffers registered with register_buffers().
+			 *
+			 * @throw std::system_error An error occurred.
+			 */
+			void unregister_buffers();
+
+			/**
+			 * Registers a ring of provided buffers with the ring. Submission queue entries with
+			 * `IOSQE_BUFFER_SELECT` set and a matching `buf_group` then have the kernel pick a
+			 * buffer from the ring when data arrives, reporting its ID in the `flags` field of
+			 * the completion queue entry.
+			 *
+			 * @param reg A reference to a structure describing the buffer ring.
+			 * @throw std::system_error An error occurred.
+			 */
+			void register_buf_ring(const struct io_uring_buf_reg& reg);
+
+			/**
+			 * Unregisters a ring of provided buffers registered with register_buf_ring().
+			 *
+			 * @param bgid The buffer group ID of the ring.
+			 * @throw std::system_error An error occurred.
+			 */
+			void unregister_buf_ring(std::uint16_t bgid);
+
+			/**
+			 * Gets the io_uring instance file descriptor.
+			 *
+			 * @return The io_uring instance file descriptor.
+			 */
+			int fd() const noexcept { return _fd; }
+
+			/**
+			 * Gets the parameters the ring was created with, as filled in by the kernel.
+			 *
+			 * @return A reference to the ring parameters.
+			 */
+			const struct io_uring_params& params() const noexcept { return _params; }
+
+		private:
+
+			void map_rings();
+			unsigned flush() noexcept;
+			unsigned enter_flags(unsigned wait_nr) const noexcept;
+
+			struct io_uring_params _params;
+			w::fd _fd;
+			w::mmap_handle _sq_ring;
+			w::mmap_handle _cq_ring;
+			w::mmap_handle _sqe_array;
+
+			unsigned *_sq_head;
+			unsigned *_sq_tail;
+			unsigned *_sq_flags;
+			unsigned _sq_mask;
+			unsigned _sqe_head;
+			unsigned _sqe_tail;
+			struct io_uring_sqe *_sqes;
+
+			unsigned *_cq_head;
+			unsigned *_cq_tail;
+			unsigned _cq_mask;
+			struct io_uring_cqe *_cqes;
+	};
+
+	namespace detail
+	{
+		inline void prep_rw(struct io_uring_sqe *sqe, std::uint8_t opcode, int fd,
+			const void *addr, std::uint32_t len, std::uint64_t offset) noexcept
+		{
+			sqe->opcode = opcode;
+			sqe->fd = fd;
+			sqe->off = offset;
+			sqe->addr = reinterpret_cast<std::uintptr_t>(addr);
+			sqe->len = len;
+		}
+	}
+
+	/**
+	 * Prepares a submission queue entry which reads data from a file descriptor; see
+	 * w::read().
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param fd The file descriptor to read from.
+	 * @param buf A pointer to an array where read data should be stored.
+	 * @param count The maximum number of bytes to read.
+	 * @param offset The file offset to read from, or -1 to use (and advance) the current file
+	 *        position.
+	 */
+	inline void prep_read(struct io_uring_sqe *sqe, int fd, void *buf, std::uint32_t count,
+		std::uint64_t offset = -1) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_READ, fd, buf, count, offset);
+	}
+
+	/**
+	 * Prepares a submission queue entry which reads data from a file descriptor into a buffer
+	 * registered with w::io_uring::register_buffers().
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param fd The file descriptor to read from.
+	 * @param buf A pointer into the registered buffer where read data should be stored.
+	 * @param count The maximum number of bytes to read.
+	 * @param offset The file offset to read from.
+	 * @param buf_index The index of the registered buffer containing @p buf.
+	 */
+	inline void prep_read_fixed(struct io_uring_sqe *sqe, int fd, void *buf, std::uint32_t count,
+		std::uint64_t offset, std::uint16_t buf_index) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_READ_FIXED, fd, buf, count, offset);
+		sqe->buf_index = buf_index;
+	}
+
+	/**
+	 * Prepares a submission queue entry which writes data to a file descriptor; see
+	 * w::write().
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param fd The file descriptor to write to.
+	 * @param buf A pointer to an array of data to write.
+	 * @param count The maximum number of bytes to write.
+	 * @param offset The file offset to write to, or -1 to use (and advance) the current file
+	 *        position.
+	 */
+	inline void prep_write(struct io_uring_sqe *sqe, int fd, const void *buf, std::uint32_t count,
+		std::uint64_t offset = -1) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_WRITE, fd, buf, count, offset);
+	}
+
+	/**
+	 * Prepares a submission queue entry which writes data to a file descriptor from a buffer
+	 * registered with w::io_uring::register_buffers().
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param fd The file descriptor to write to.
+	 * @param buf A pointer into the registered buffer holding the data to write.
+	 * @param count The maximum number of bytes to write.
+	 * @param offset The file offset to write to.
+	 * @param buf_index The index of the registered buffer containing @p buf.
+	 */
+	inline void prep_write_fixed(struct io_uring_sqe *sqe, int fd, const void *buf,
+		std::uint32_t count, std::uint64_t offset, std::uint16_t buf_index) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_WRITE_FIXED, fd, buf, count, offset);
+		sqe->buf_index = buf_index;
+	}
+
+	/**
+	 * Prepares a submission queue entry which receives a message from a socket; see w::recv().
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param sockfd The socket to receive from.
+	 * @param buf A pointer to an array where received data should be stored.
+	 * @param len The maximum number of bytes to receive.
+	 * @param flags A bitwise combination of flags.
+	 */
+	inline void prep_recv(struct io_uring_sqe *sqe, int sockfd, void *buf, std::uint32_t len,
+		int flags = 0) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_RECV, sockfd, buf, len, 0);
+		sqe->msg_flags = static_cast<std::uint32_t>(flags);
+	}
+
+	/**
+	 * Prepares a submission queue entry which sends a message on a socket; see w::send().
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param sockfd The socket to send from.
+	 * @param buf A pointer to the data to send.
+	 * @param len The maximum number of bytes to send.
+	 * @param flags A bitwise combination of flags.
+	 */
+	inline void prep_send(struct io_uring_sqe *sqe, int sockfd, const void *buf, std::uint32_t len,
+		int flags = 0) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_SEND, sockfd, buf, len, 0);
+		sqe->msg_flags = static_cast<std::uint32_t>(flags);
+	}
+
+	/**
+	 * Prepares a submission queue entry which accepts a connection on a socket; see
+	 * w::accept(). The file descriptor of the new connection is returned in the `res` field of
+	 * the completion queue entry, and must be wrapped in a w::fd by the caller.
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param sockfd The socket on which to accept a connection.
+	 * @param addr A pointer to the address of the remote endpoint, or `nullptr`.
+	 * @param addrlen A pointer to the size of the structure pointed to by @p addr, in bytes,
+	 *        which is updated on completion. Both @p addr and @p addrlen must remain valid
+	 *        until the operation completes.
+	 * @param flags A bitwise combination of flags, as for `accept4()`.
+	 */
+	inline void prep_accept(struct io_uring_sqe *sqe, int sockfd, struct sockaddr *addr,
+		socklen_t *addrlen, int flags = 0) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_ACCEPT, sockfd, addr, 0, reinterpret_cast<std::uintptr_t>(addrlen));
+		sqe->accept_flags = static_cast<std::uint32_t>(flags);
+	}
+
+	/**
+	 * Prepares a submission queue entry which completes after a timeout or after a number of
+	 * other completions, whichever happens first. A timeout is reported as `-ETIME` in the
+	 * `res` field of the completion queue entry.
+	 *
+	 * @param sqe The submission queue entry to prepare.
+	 * @param ts A pointer to the timeout, which must remain valid until the operation
+	 *        completes.
+	 * @param count The number of completions to wait for, or zero to wait for the timeout only.
+	 * @param flags A bitwise combination of `IORING_TIMEOUT_*` flags.
+	 */
+	inline void prep_timeout(struct io_uring_sqe *sqe, const struct __kernel_timespec *ts,
+		unsigned count = 0, unsigned flags = 0) noexcept
+	{
+		detail::prep_rw(sqe, IORING_OP_TIMEOUT, -1, ts, 1, count);
+		sqe->timeout_flags = flags;
+	}
+}
+
+#ifdef CPPWRAP_HEADER_ONLY
+#include <w/impl/io_uring.ipp>
+#endif
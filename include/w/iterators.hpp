@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 
 namespace w
@@ -80,6 +81,135 @@ namespace w
 
 		private: const ListNode *_current;
 	};
+
+	/**
+	 * A forward iterator for lists of variable-length records packed into a buffer of known
+	 * size, such as netlink messages or attributes.
+	 *
+	 * @tparam ListNode The type of the record header.
+	 * @tparam Valid A predicate which, given a pointer to a record and the number of bytes from
+	 *         it to the end of the buffer, tests whether the whole record lies within the buffer.
+	 * @tparam Next A mutator function which, given a pointer to a record and the number of bytes
+	 *         from it to the end of the buffer, returns a pointer to the next record and reduces
+	 *         the number of bytes accordingly.
+	 */
+	template <typename ListNode, bool (*Valid)(const ListNode *, std::size_t),
+		const ListNode * (*Next)(const ListNode *, std::size_t&)>
+	struct const_sized_list_iterator
+	{
+		/**
+		 * Constructs an end iterator.
+		 */
+		const_sized_list_iterator() noexcept : _current(nullptr), _remaining(0) { }
+
+		/**
+		 * Constructs an iterator pointing to the specified record, or an end iterator if the
+		 * record does not fit in the buffer.
+		 *
+		 * @param current The record to point to.
+		 * @param remaining The number of bytes from @p current to the end of the buffer.
+		 */
+		const_sized_list_iterator(const ListNode *current, std::size_t remaining) noexcept
+			: _current(Valid(current, remaining) ? current : nullptr),
+			  _remaining(_current ? remaining : 0)
+		{
+		}
+
+		/**
+		 * Advances to the next record, or to the end if there are no more complete records in
+		 * the buffer. The behavior is undefined if this is an end iterator.
+		 *
+		 * @return A reference to this object.
+		 */
+		const_sized_list_iterator& operator++() noexcept
+		{
+			_current = Next(_current, _remaining);
+
+			if (!Valid(_current, _remaining))
+			{
+				_current = nullptr;
+				_remaining = 0;
+			}
+
+			return *this;
+		}
+
+		/**
+		 * Gets a reference to the record pointed to by this iterator. The behavior is undefined
+		 * if this is an end iterator.
+		 *
+		 * @return a reference to the record pointed to by this iterator
+		 */
+		const ListNode& operator*() const noexcept { return *_current; }
+
+		/**
+		 * Gets a pointer to the record pointed to by this iterator.
+		 *
+		 * @return a pointer to the record pointed to by this iterator, or `nullptr` if this is
+		 *         an end iterator.
+		 */
+		const ListNode *operator->() const noexcept { return _current; }
+
+		/**
+		 * Tests if this object and @p rhs point to the same record.
+		 *
+		 * @param rhs The other iterator to compare.
+		 * @return `true` if and only if this object and @p rhs point to the same record.
+		 */
+		bool operator==(const_sized_list_iterator const& rhs) const noexcept { return _current == rhs._current; }
+
+		/**
+		 * Tests if this object and @p rhs point to the same record.
+		 *
+		 * @param rhs The other iterator to compare.
+		 * @return `true` if and only if this object and @p rhs point to different records.
+		 */
+		bool operator!=(const_sized_list_iterator const& rhs) const noexcept { return _current != rhs._current; }
+
+		private: const ListNode *_current; std::size_t _remaining;
+	};
+
+	/**
+	 * A range of variable-length records packed into a buffer of known size.
+	 *
+	 * @tparam ListNode The type of the record header.
+	 * @tparam Valid See w::const_sized_list_iterator.
+	 * @tparam Next See w::const_sized_list_iterator.
+	 */
+	template <typename ListNode, bool (*Valid)(const ListNode *, std::size_t),
+		const ListNode * (*Next)(const ListNode *, std::size_t&)>
+	struct const_sized_list
+	{
+		/**
+		 * The iterator type.
+		 */
+		typedef const_sized_list_iterator<ListNode, Valid, Next> iterator;
+
+		/**
+		 * A pointer to the first record.
+		 */
+		const ListNode *head;
+
+		/**
+		 * The size of the buffer, in bytes, starting at @ref head.
+		 */
+		std::size_t size;
+
+		/**
+		 * Gets an iterator pointing to the first record.
+		 *
+		 * @return An iterator pointing to the first record, or an end iterator if the buffer
+		 *         holds no complete record.
+		 */
+		iterator begin() const noexcept { return iterator(head, size); }
+
+		/**
+		 * Gets an end iterator.
+		 *
+		 * @return An end iterator.
+		 */
+		iterator end() const noexcept { return iterator(); }
+	};
 }
 
 template <typename ListNode, const ListNode * (*Next)(const ListNode *)>
@@ -91,3 +221,14 @@ struct std::iterator_traits<w::const_list_iterator<ListNode, Next>>
     typedef const ListNode&				reference;
     typedef std::forward_iterator_tag	iterator_category;
 };
+
+template <typename ListNode, bool (*Valid)(const ListNode *, std::size_t),
+	const ListNode * (*Next)(const ListNode *, std::size_t&)>
+struct std::iterator_traits<w::const_sized_list_iterator<ListNode, Valid, Next>>
+{
+    typedef std::ptrdiff_t				difference_type;
+    typedef ListNode					value_type;
+    typedef const ListNode *			pointer;
+    typedef const ListNode&				reference;
+    typedef std::forward_iterator_tag	iterator_category;
+};
@@ -7,15 +7,79 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <system_error>
 #include <utility>
 
 #include <w/posix.hpp>
 
+#include <fcntl.h>
+#include <sched.h>
 #include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/uio.h>
 
 namespace w
 {
+	/**
+	 * Closes all open file descriptors in a range (requires Linux 5.9).
+	 *
+	 * @param first The first file descriptor to close.
+	 * @param last The last file descriptor to close, inclusive.
+	 * @param flags Zero, or a bitwise combination of `CLOSE_RANGE_CLOEXEC` and
+	 *        `CLOSE_RANGE_UNSHARE`.
+	 * @throw std::system_error An error occurred.
+	 */
+	void close_range(unsigned first, unsigned last, int flags = 0);
+
+	/**
+	 * Closes all open file descriptors in a range (requires Linux 5.9) without throwing.
+	 *
+	 * @param first The first file descriptor to close.
+	 * @param last The last file descriptor to close, inclusive.
+	 * @param flags Zero, or a bitwise combination of `CLOSE_RANGE_CLOEXEC` and
+	 *        `CLOSE_RANGE_UNSHARE`.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void close_range(unsigned first, unsigned last, int flags, std::error_code& ec) noexcept;
+
+	/**
+	 * Copies a range of data from one file to another without passing it through user space.
+	 *
+	 * @param fd_in The file descriptor to copy from.
+	 * @param off_in A pointer to the offset to copy from, which is advanced by the number of
+	 *        bytes copied, or `nullptr` to use and advance the file offset of @p fd_in.
+	 * @param fd_out The file descriptor to copy to.
+	 * @param off_out A pointer to the offset to copy to, which is advanced by the number of
+	 *        bytes copied, or `nullptr` to use and advance the file offset of @p fd_out.
+	 * @param len The maximum number of bytes to copy.
+	 * @param flags Reserved; must be zero.
+	 * @return The number of bytes actually copied, which is zero at the end of the input file.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t copy_file_range(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+		std::size_t len, unsigned flags = 0);
+
+	/**
+	 * Copies a range of data from one file to another without throwing. This overload allows
+	 * callers to detect that the files do not support the operation (e.g. `EXDEV` or `EINVAL`)
+	 * and fall back to another method without an exception.
+	 *
+	 * @param fd_in The file descriptor to copy from.
+	 * @param off_in A pointer to the offset to copy from, or `nullptr`.
+	 * @param fd_out The file descriptor to copy to.
+	 * @param off_out A pointer to the offset to copy to, or `nullptr`.
+	 * @param len The maximum number of bytes to copy.
+	 * @param flags Reserved; must be zero.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually copied (which is zero at the end of the input file),
+	 *         or zero if an error occurred.
+	 */
+	std::size_t copy_file_range(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+		std::size_t len, unsigned flags, std::error_code& ec) noexcept;
+
 	/**
 	 * Creates an epoll instance.
 	 *
@@ -25,6 +89,15 @@ namespace w
 	 */
 	w::fd epoll_create(int size = sizeof(nullptr));
 
+	/**
+	 * Creates an epoll instance.
+	 *
+	 * @param flags A bitwise combination of flags (e.g. `EPOLL_CLOEXEC`).
+	 * @return The file descriptor for the epoll instance.
+	 * @throw std::system_error An error occurred.
+	 */
+	w::fd epoll_create1(int flags);
+
 	/**
 	 * Manipulates an epoll instance.
 	 *
@@ -36,6 +109,17 @@ namespace w
 	 */
 	void epoll_ctl(int epfd, int op, int fd, struct epoll_event *event = nullptr);
 
+	/**
+	 * Manipulates an epoll instance without throwing.
+	 *
+	 * @param epfd The epoll instance file descriptor.
+	 * @param op The operation to perform.
+	 * @param fd The file descriptor to add, modify or remove from the poll instance.
+	 * @param event A pointer to a structure specifying the events of interest.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void epoll_ctl(int epfd, int op, int fd, struct epoll_event *event, std::error_code& ec) noexcept;
+
 	/**
 	 * Manipulates an epoll instance.
 	 *
@@ -48,6 +132,19 @@ namespace w
 	 */
 	void epoll_ctl(int epfd, int op, int fd, std::uint32_t events, void *user_data = nullptr);
 
+	/**
+	 * Manipulates an epoll instance without throwing.
+	 *
+	 * @param epfd The epoll instance file descriptor.
+	 * @param op The operation to perform.
+	 * @param fd The file descriptor to add, modify or remove from the poll instance.
+	 * @param events A bitwise combination of events of interest.
+	 * @param user_data An opaque user data value.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void epoll_ctl(int epfd, int op, int fd, std::uint32_t events, void *user_data,
+		std::error_code& ec) noexcept;
+
 	/**
 	 * Manipulates an epoll instance.
 	 *
@@ -98,6 +195,22 @@ namespace w
 	unsigned epoll_wait(int epfd, struct epoll_event *events, int maxevents,
 		std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
 
+	/**
+	 * Waits for events to occur on an epoll instance without throwing. This overload allows
+	 * `EINTR` to be handled without an exception.
+	 *
+	 * @param epfd The epoll instance file descriptor.
+	 * @param events A pointer to an array of structures to receive information about events.
+	 * @param maxevents The number of elements in the @p events array.
+	 * @param timeout The number of milliseconds
+	 * @param ec Set to the error which occurred, or cleared on success. An out-of-range
+	 *        @p timeout is reported as `EINVAL`.
+	 * @return The number of events that occurred (which may be zero), or zero if an error
+	 *         occurred.
+	 */
+	unsigned epoll_wait(int epfd, struct epoll_event *events, int maxevents,
+		std::chrono::milliseconds timeout, std::error_code& ec) noexcept;
+
 	/**
 	 * Creates an event file descriptor.
 	 *
@@ -116,6 +229,17 @@ namespace w
 	 */
 	std::uint64_t eventfd_read(int evfd);
 
+	/**
+	 * Reads the current counter value of an event file descriptor without throwing. This
+	 * overload is intended for non-blocking event file descriptors, where a zero counter is
+	 * reported as `EAGAIN` through @p ec rather than as an exception.
+	 *
+	 * @param evfd The event file descriptor.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The event counter value, or zero if an error occurred.
+	 */
+	std::uint64_t eventfd_read(int evfd, std::error_code& ec) noexcept;
+
 	/**
 	 * Modifies the counter value of an event file descriptor; see the man page of `eventfd()` for
 	 * a description of the counter semantics.
@@ -126,6 +250,294 @@ namespace w
 	 */
 	void eventfd_write(int evfd, std::uint64_t value);
 
+	/**
+	 * Modifies the counter value of an event file descriptor without throwing.
+	 *
+	 * @param evfd The event file descriptor.
+	 * @param value The event counter value.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void eventfd_write(int evfd, std::uint64_t value, std::error_code& ec) noexcept;
+
+	/**
+	 * Allocates, deallocates or zeroes space in a file.
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @param mode Zero to allocate space (extending the file if needed), or a bitwise combination
+	 *        of `FALLOC_FL_*` flags.
+	 * @param offset The offset of the range, in bytes.
+	 * @param len The length of the range, in bytes.
+	 * @throw std::system_error An error occurred.
+	 */
+	void fallocate(int fd, int mode, off_t offset, off_t len);
+
+	/**
+	 * Allocates, deallocates or zeroes space in a file without throwing.
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @param mode Zero to allocate space (extending the file if needed), or a bitwise combination
+	 *        of `FALLOC_FL_*` flags.
+	 * @param offset The offset of the range, in bytes.
+	 * @param len The length of the range, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void fallocate(int fd, int mode, off_t offset, off_t len, std::error_code& ec) noexcept;
+
+	/**
+	 * Sets the NUMA memory policy of a range of memory, which determines the nodes its pages are
+	 * allocated from.
+	 *
+	 * @param addr The start of the range, which must be page-aligned.
+	 * @param len The length of the range, in bytes.
+	 * @param mode The policy, such as `MPOL_BIND` or `MPOL_PREFERRED`, optionally combined with
+	 *        mode flags.
+	 * @param nodemask A bitmask of the nodes the policy applies to, or `nullptr` for
+	 *        `MPOL_DEFAULT` and `MPOL_LOCAL`.
+	 * @param maxnode The number of bits in @p nodemask, plus one (as expected by the system call).
+	 * @param flags Zero, or a bitwise combination of `MPOL_MF_*` flags to apply the policy to
+	 *        pages already allocated.
+	 * @throw std::system_error An error occurred.
+	 */
+	void mbind(void *addr, unsigned long len, int mode, const unsigned long *nodemask, unsigned long maxnode, unsigned flags = 0);
+
+	/**
+	 * Sets the NUMA memory policy of a range of memory, which determines the nodes its pages are
+	 * allocated from without throwing.
+	 *
+	 * @param addr The start of the range, which must be page-aligned.
+	 * @param len The length of the range, in bytes.
+	 * @param mode The policy, such as `MPOL_BIND` or `MPOL_PREFERRED`, optionally combined with
+	 *        mode flags.
+	 * @param nodemask A bitmask of the nodes the policy applies to, or `nullptr` for
+	 *        `MPOL_DEFAULT` and `MPOL_LOCAL`.
+	 * @param maxnode The number of bits in @p nodemask, plus one (as expected by the system call).
+	 * @param flags Zero, or a bitwise combination of `MPOL_MF_*` flags to apply the policy to
+	 *        pages already allocated.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void mbind(void *addr, unsigned long len, int mode, const unsigned long *nodemask, unsigned long maxnode, unsigned flags,
+		std::error_code& ec) noexcept;
+
+	/**
+	 * Creates an anonymous file which lives in memory, such as for sharing memory through
+	 * w::mmap() or passing it to another process.
+	 *
+	 * @param name A name for the file, which is only used for debugging (it appears as the
+	 *        target of the `/proc/self/fd` link).
+	 * @param flags A bitwise combination of flags, such as `MFD_CLOEXEC`.
+	 * @return A file descriptor for the file, which is initially empty.
+	 * @throw std::system_error An error occurred.
+	 */
+	w::fd memfd_create(const char *name, unsigned flags = 0);
+
+	/**
+	 * Creates an anonymous file which lives in memory without throwing.
+	 *
+	 * @param name A name for the file, which is only used for debugging.
+	 * @param flags A bitwise combination of flags, such as `MFD_CLOEXEC`.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A file descriptor for the file, which is empty if an error occurred.
+	 */
+	w::fd memfd_create(const char *name, unsigned flags, std::error_code& ec) noexcept;
+
+	/**
+	 * Locks a range of memory into RAM, with flags which control how its pages are faulted in.
+	 *
+	 * @param addr The start of the range, which is rounded down to a page boundary.
+	 * @param len The length of the range, in bytes.
+	 * @param flags Zero, or `MLOCK_ONFAULT` to lock pages as they are faulted in rather than all
+	 *        at once.
+	 * @throw std::system_error An error occurred.
+	 */
+	void mlock2(const void *addr, std::size_t len, unsigned flags);
+
+	/**
+	 * Locks a range of memory into RAM, with flags which control how its pages are faulted in
+	 * without throwing.
+	 *
+	 * @param addr The start of the range, which is rounded down to a page boundary.
+	 * @param len The length of the range, in bytes.
+	 * @param flags Zero, or `MLOCK_ONFAULT` to lock pages as they are faulted in rather than all
+	 *        at once.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void mlock2(const void *addr, std::size_t len, unsigned flags, std::error_code& ec) noexcept;
+
+	/**
+	 * Resizes a memory mapping, possibly moving it, and updates its handle. Unlike growing a
+	 * mapping by mapping a new one and copying, the pages are moved by remapping them.
+	 *
+	 * @param mapping The handle of the mapping, which is updated to the new address and
+	 *        length on success.
+	 * @param new_length The new length of the mapping, in bytes.
+	 * @param flags Zero to resize in place only, or `MREMAP_MAYMOVE` to let the kernel move the
+	 *        mapping if it cannot be grown in place. `MREMAP_FIXED` is not supported.
+	 * @throw std::system_error An error occurred. @p mapping is unchanged.
+	 */
+	void mremap(w::mmap_handle& mapping, std::size_t new_length, int flags = MREMAP_MAYMOVE);
+
+	/**
+	 * Resizes a memory mapping, possibly moving it, and updates its handle without throwing.
+	 *
+	 * @param mapping The handle of the mapping, which is updated to the new address and
+	 *        length on success.
+	 * @param new_length The new length of the mapping, in bytes.
+	 * @param flags Zero to resize in place only, or `MREMAP_MAYMOVE` to let the kernel move the
+	 *        mapping if it cannot be grown in place. `MREMAP_FIXED` is not supported.
+	 * @param ec Set to the error which occurred, or cleared on success. @p mapping is unchanged
+	 *        if an error occurred.
+	 */
+	void mremap(w::mmap_handle& mapping, std::size_t new_length, int flags, std::error_code& ec) noexcept;
+
+	/**
+	 * Gets the set of CPUs on which a thread is allowed to run.
+	 *
+	 * @param pid The thread ID, or zero for the calling thread.
+	 * @return The CPU affinity mask.
+	 * @throw std::system_error An error occurred.
+	 */
+	cpu_set_t sched_getaffinity(pid_t pid);
+
+	/**
+	 * Gets the set of CPUs on which a thread is allowed to run without throwing.
+	 *
+	 * @param pid The thread ID, or zero for the calling thread.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The CPU affinity mask, which is empty if an error occurred.
+	 */
+	cpu_set_t sched_getaffinity(pid_t pid, std::error_code& ec) noexcept;
+
+	/**
+	 * Sets the set of CPUs on which a thread is allowed to run.
+	 *
+	 * @param pid The thread ID, or zero for the calling thread.
+	 * @param mask The CPU affinity mask.
+	 * @throw std::system_error An error occurred.
+	 */
+	void sched_setaffinity(pid_t pid, const cpu_set_t& mask);
+
+	/**
+	 * Sets the set of CPUs on which a thread is allowed to run without throwing.
+	 *
+	 * @param pid The thread ID, or zero for the calling thread.
+	 * @param mask The CPU affinity mask.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void sched_setaffinity(pid_t pid, const cpu_set_t& mask, std::error_code& ec) noexcept;
+
+	/**
+	 * Transfers data from a file to another file descriptor (typically a socket) without
+	 * passing it through user space.
+	 *
+	 * @param out_fd The file descriptor to write to.
+	 * @param in_fd The file descriptor to read from, which must support `mmap()`-like
+	 *        operations.
+	 * @param offset A pointer to the offset to read from, which is advanced by the number of
+	 *        bytes transferred, or `nullptr` to use and advance the file offset of @p in_fd.
+	 * @param count The maximum number of bytes to transfer.
+	 * @return The number of bytes actually transferred, which is zero at the end of the input
+	 *         file.
+	 * @throw std::system_error An error occurred. This includes `EAGAIN` on non-blocking files.
+	 */
+	std::size_t sendfile(int out_fd, int in_fd, off_t *offset, std::size_t count);
+
+	/**
+	 * Transfers data from a file to another file descriptor without throwing. This overload is
+	 * intended for non-blocking output file descriptors, where `EAGAIN` is reported through
+	 * @p ec rather than as an exception.
+	 *
+	 * @param out_fd The file descriptor to write to.
+	 * @param in_fd The file descriptor to read from.
+	 * @param offset A pointer to the offset to read from, or `nullptr`.
+	 * @param count The maximum number of bytes to transfer.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually transferred (which is zero at the end of the input
+	 *         file), or zero if an error occurred.
+	 */
+	std::size_t sendfile(int out_fd, int in_fd, off_t *offset, std::size_t count,
+		std::error_code& ec) noexcept;
+
+	/**
+	 * Moves data between two file descriptors, at least one of which must be a pipe, without
+	 * passing it through user space.
+	 *
+	 * @param fd_in The file descriptor to read from.
+	 * @param off_in A pointer to the offset to read from, which is advanced by the number of
+	 *        bytes moved, or `nullptr` to use the file offset. This must be `nullptr` for pipes.
+	 * @param fd_out The file descriptor to write to.
+	 * @param off_out A pointer to the offset to write to, which is advanced by the number of
+	 *        bytes moved, or `nullptr` to use the file offset. This must be `nullptr` for pipes.
+	 * @param len The maximum number of bytes to move.
+	 * @param flags A bitwise combination of flags (e.g. `SPLICE_F_MOVE`).
+	 * @return The number of bytes actually moved, which is zero at the end of the input.
+	 * @throw std::system_error An error occurred. This includes `EAGAIN` on non-blocking files
+	 *        and with `SPLICE_F_NONBLOCK`.
+	 */
+	std::size_t splice(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+		std::size_t len, unsigned flags = 0);
+
+	/**
+	 * Moves data between two file descriptors without throwing. This overload is intended for
+	 * non-blocking operation, where `EAGAIN` is reported through @p ec rather than as an
+	 * exception.
+	 *
+	 * @param fd_in The file descriptor to read from.
+	 * @param off_in A pointer to the offset to read from, or `nullptr`.
+	 * @param fd_out The file descriptor to write to.
+	 * @param off_out A pointer to the offset to write to, or `nullptr`.
+	 * @param len The maximum number of bytes to move.
+	 * @param flags A bitwise combination of flags (e.g. `SPLICE_F_MOVE`).
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually moved (which is zero at the end of the input), or
+	 *         zero if an error occurred.
+	 */
+	std::size_t splice(int fd_in, loff_t *off_in, int fd_out, loff_t *off_out,
+		std::size_t len, unsigned flags, std::error_code& ec) noexcept;
+
+	/**
+	 * Flushes all modified data and metadata of the filesystem containing a file to the storage
+	 * device.
+	 *
+	 * @param fd A file descriptor of any file on the filesystem.
+	 * @throw std::system_error An error occurred.
+	 */
+	void syncfs(int fd);
+
+	/**
+	 * Flushes all modified data and metadata of the filesystem containing a file to the storage
+	 * device without throwing.
+	 *
+	 * @param fd A file descriptor of any file on the filesystem.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void syncfs(int fd, std::error_code& ec) noexcept;
+
+	/**
+	 * Duplicates data from one pipe to another without consuming it.
+	 *
+	 * @param fd_in The pipe to read from.
+	 * @param fd_out The pipe to write to.
+	 * @param len The maximum number of bytes to duplicate.
+	 * @param flags A bitwise combination of flags (e.g. `SPLICE_F_NONBLOCK`).
+	 * @return The number of bytes actually duplicated, which is zero if @p fd_in is empty and
+	 *         has no writers.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t tee(int fd_in, int fd_out, std::size_t len, unsigned flags = 0);
+
+	/**
+	 * Duplicates data from one pipe to another without throwing.
+	 *
+	 * @param fd_in The pipe to read from.
+	 * @param fd_out The pipe to write to.
+	 * @param len The maximum number of bytes to duplicate.
+	 * @param flags A bitwise combination of flags (e.g. `SPLICE_F_NONBLOCK`).
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually duplicated, or zero if an error occurred.
+	 */
+	std::size_t tee(int fd_in, int fd_out, std::size_t len, unsigned flags,
+		std::error_code& ec) noexcept;
+
 	/**
 	 * Creates a timer file descriptor.
 	 *
@@ -166,4 +578,34 @@ namespace w
 	timerfd_settime(int fd, int flags,
 		std::chrono::nanoseconds interval,
 		std::chrono::nanoseconds initial);
+
+	/**
+	 * Maps user memory into a pipe.
+	 *
+	 * @param fd The write end of the pipe.
+	 * @param iov A pointer to an array of structures describing the memory to map.
+	 * @param nr_segs The number of elements in the @p iov array.
+	 * @param flags A bitwise combination of flags (e.g. `SPLICE_F_GIFT`).
+	 * @return The number of bytes actually transferred into the pipe.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t vmsplice(int fd, const struct iovec *iov, std::size_t nr_segs, unsigned flags = 0);
+
+	/**
+	 * Maps user memory into a pipe without throwing.
+	 *
+	 * @param fd The write end of the pipe.
+	 * @param iov A pointer to an array of structures describing the memory to map.
+	 * @param nr_segs The number of elements in the @p iov array.
+	 * @param flags A bitwise combination of flags (e.g. `SPLICE_F_GIFT`).
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually transferred into the pipe, or zero if an error
+	 *         occurred.
+	 */
+	std::size_t vmsplice(int fd, const struct iovec *iov, std::size_t nr_segs, unsigned flags,
+		std::error_code& ec) noexcept;
 }
+
+#ifdef CPPWRAP_HEADER_ONLY
+#include <w/impl/linux.ipp>
+#endif
@@ -0,0 +1,180 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <w/iterators.hpp>
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+
+namespace w
+{
+	/**
+	 * Wraps `struct sockaddr_nl`, adding constructors for convenient initialization.
+	 */
+	struct netlink_address : sockaddr_nl
+	{
+		/**
+		 * Initializes a netlink address.
+		 *
+		 * @param groups A bitmask of the multicast groups to subscribe to (when binding), or
+		 *        zero.
+		 * @param pid The port ID, or zero to address the kernel (or, when binding, to let the
+		 *        kernel assign one).
+		 */
+		netlink_address(std::uint32_t groups = 0, std::uint32_t pid = 0) noexcept;
+	};
+}
+
+/// @cond
+namespace w::detail
+{
+	inline bool valid_nlmsghdr(const struct nlmsghdr *cur, std::size_t remaining)
+	{
+		return remaining >= sizeof(struct nlmsghdr) &&
+			cur->nlmsg_len >= sizeof(struct nlmsghdr) &&
+			cur->nlmsg_len <= remaining;
+	}
+
+	inline const struct nlmsghdr *get_next_nlmsghdr(const struct nlmsghdr *cur, std::size_t& remaining)
+	{
+		// NLMSG_NEXT() would underflow if the last message is not padded to the alignment, so
+		// the padding is clamped to the end of the buffer.
+
+		std::size_t length = NLMSG_ALIGN(cur->nlmsg_len);
+		if (length > remaining)
+			length = remaining;
+
+		remaining -= length;
+		return reinterpret_cast<const struct nlmsghdr *>(reinterpret_cast<const char *>(cur) + length);
+	}
+
+	inline bool valid_rtattr(const struct rtattr *cur, std::size_t remaining)
+	{
+		return remaining >= sizeof(struct rtattr) &&
+			cur->rta_len >= sizeof(struct rtattr) &&
+			cur->rta_len <= remaining;
+	}
+
+	inline const struct rtattr *get_next_rtattr(const struct rtattr *cur, std::size_t& remaining)
+	{
+		std::size_t length = RTA_ALIGN(cur->rta_len);
+		if (length > remaining)
+			length = remaining;
+
+		remaining -= length;
+		return reinterpret_cast<const struct rtattr *>(reinterpret_cast<const char *>(cur) + length);
+	}
+}
+/// @endcond
+
+namespace w
+{
+	/**
+	 * A range of the netlink messages in a buffer.
+	 */
+	typedef w::const_sized_list<struct nlmsghdr, w::detail::valid_nlmsghdr, w::detail::get_next_nlmsghdr> netlink_message_list;
+
+	/**
+	 * A range of the routing attributes in a buffer.
+	 */
+	typedef w::const_sized_list<struct rtattr, w::detail::valid_rtattr, w::detail::get_next_rtattr> route_attribute_list;
+
+	/**
+	 * Gets the netlink messages in a buffer, such as a datagram received from a netlink socket.
+	 * Iteration stops at the first message which is truncated or malformed.
+	 *
+	 * @param buf A pointer to the buffer, which must be aligned for `struct nlmsghdr`.
+	 * @param len The number of bytes in the buffer.
+	 * @return A range of the messages.
+	 */
+	inline netlink_message_list netlink_messages(const void *buf, std::size_t len) noexcept
+	{
+		return { static_cast<const struct nlmsghdr *>(buf), len };
+	}
+
+	/**
+	 * Gets the family-specific header which follows a netlink message header, such as the
+	 * `struct ifinfomsg` of an `RTM_NEWLINK` message. The message must be long enough to hold
+	 * it; see netlink_payload_fits().
+	 *
+	 * @tparam Header The type of the family-specific header.
+	 * @param message The message.
+	 * @return A reference to the family-specific header.
+	 */
+	template <typename Header>
+	const Header& netlink_payload(const struct nlmsghdr& message) noexcept
+	{
+		return *static_cast<const Header *>(NLMSG_DATA(&message));
+	}
+
+	/**
+	 * Tests whether a netlink message is long enough to hold a family-specific header.
+	 *
+	 * @tparam Header The type of the family-specific header.
+	 * @param message The message.
+	 * @return `true` if @p message holds a whole @p Header.
+	 */
+	template <typename Header>
+	bool netlink_payload_fits(const struct nlmsghdr& message) noexcept
+	{
+		return message.nlmsg_len >= NLMSG_LENGTH(sizeof(Header));
+	}
+
+	/**
+	 * Gets the routing attributes which follow the family-specific header of a netlink
+	 * message, such as the `IFLA_*` attributes of an `RTM_NEWLINK` message.
+	 *
+	 * @tparam Header The type of the family-specific header.
+	 * @param message The message.
+	 * @return A range of the attributes, which is empty if @p message is too short to hold a
+	 *         @p Header.
+	 */
+	template <typename Header>
+	route_attribute_list route_attributes(const struct nlmsghdr& message) noexcept
+	{
+		if (!w::netlink_payload_fits<Header>(message))
+			return { nullptr, 0 };
+
+		auto first = reinterpret_cast<const char *>(NLMSG_DATA(&message)) + NLMSG_ALIGN(sizeof(Header));
+		auto last = reinterpret_cast<const char *>(&message) + message.nlmsg_len;
+
+		return { reinterpret_cast<const struct rtattr *>(first),
+			last > first ? static_cast<std::size_t>(last - first) : 0 };
+	}
+
+	/**
+	 * Gets the routing attributes nested in a routing attribute.
+	 *
+	 * @param attribute The attribute.
+	 * @return A range of the nested attributes.
+	 */
+	inline route_attribute_list route_attributes(const struct rtattr& attribute) noexcept
+	{
+		return { static_cast<const struct rtattr *>(RTA_DATA(&attribute)), RTA_PAYLOAD(&attribute) };
+	}
+
+	/**
+	 * Gets the payload of a routing attribute.
+	 *
+	 * @param attribute The attribute.
+	 * @return A span of the payload bytes.
+	 */
+	inline std::span<const std::byte> attribute_payload(const struct rtattr& attribute) noexcept
+	{
+		return { static_cast<const std::byte *>(RTA_DATA(&attribute)), RTA_PAYLOAD(&attribute) };
+	}
+}
+
+#ifdef CPPWRAP_HEADER_ONLY
+#include <w/impl/netlink.ipp>
+#endif
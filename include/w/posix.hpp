@@ -6,15 +6,20 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <system_error>
 #include <utility>
 
 #include <w/assert.hpp>
 #include <w/handle.hpp>
+#include <w/instrumentation.hpp>
 
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/uio.h>
 
 namespace w
@@ -78,6 +83,16 @@ namespace w
 	 */
 	int fcntl(int fd, int cmd);
 
+	/**
+	 * Controls a file descriptor without throwing.
+	 *
+	 * @param fd The file descriptor to control.
+	 * @param cmd The control command code.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A result code from the command, or -1 if an error occurred.
+	 */
+	int fcntl(int fd, int cmd, std::error_code& ec) noexcept;
+
 	/**
 	 * Controls a file descriptor.
 	 *
@@ -91,12 +106,105 @@ namespace w
 	template <typename Argument>
 	int fcntl(int fd, int cmd, const Argument& arg)
 	{
+		CPPWRAP_INSTRUMENT(fcntl);
+
 		return w::throw_if_eq(
 			::fcntl(fd, cmd, arg),
 			-1,
 			"file descriptor control failed");
 	}
 
+	/**
+	 * Controls a file descriptor without throwing.
+	 *
+	 * @tparam Argument The type of the command-specific argument.
+	 * @param fd The file descriptor to control.
+	 * @param cmd The control command code.
+	 * @param arg A reference to a command-specific input argument.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A result code from the command, or -1 if an error occurred.
+	 */
+	template <typename Argument>
+	int fcntl(int fd, int cmd, const Argument& arg, std::error_code& ec) noexcept
+	{
+		CPPWRAP_INSTRUMENT_EC(fcntl, ec);
+
+		return w::error_if_eq(
+			::fcntl(fd, cmd, arg),
+			-1,
+			ec);
+	}
+
+	/**
+	 * Flushes the modified data of a file to the storage device, along with only the metadata
+	 * needed to read it back (unlike fsync(), which also flushes timestamps).
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @throw std::system_error An error occurred.
+	 */
+	void fdatasync(int fd);
+
+	/**
+	 * Flushes the modified data of a file to the storage device, along with only the metadata
+	 * needed to read it back, without throwing.
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void fdatasync(int fd, std::error_code& ec) noexcept;
+
+	/**
+	 * Gets the status of an open file.
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @return A structure describing the file.
+	 * @throw std::system_error An error occurred.
+	 */
+	struct stat fstat(int fd);
+
+	/**
+	 * Gets the status of an open file without throwing.
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A structure describing the file, which is zero-filled if an error occurred.
+	 */
+	struct stat fstat(int fd, std::error_code& ec) noexcept;
+
+	/**
+	 * Flushes the modified data and metadata of a file to the storage device.
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @throw std::system_error An error occurred.
+	 */
+	void fsync(int fd);
+
+	/**
+	 * Flushes the modified data and metadata of a file to the storage device without throwing.
+	 *
+	 * @param fd The file descriptor of the file.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void fsync(int fd, std::error_code& ec) noexcept;
+
+	/**
+	 * Sets the size of a file, truncating it or extending it with zeroes.
+	 *
+	 * @param fd The file descriptor of the file, which must be open for writing.
+	 * @param length The new size of the file, in bytes.
+	 * @throw std::system_error An error occurred.
+	 */
+	void ftruncate(int fd, off_t length);
+
+	/**
+	 * Sets the size of a file, truncating it or extending it with zeroes without throwing.
+	 *
+	 * @param fd The file descriptor of the file, which must be open for writing.
+	 * @param length The new size of the file, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void ftruncate(int fd, off_t length, std::error_code& ec) noexcept;
+
 	/**
 	 * Controls a device.
 	 *
@@ -108,6 +216,18 @@ namespace w
 	 */
 	int ioctl(int fd, unsigned long request, void *arg);
 
+	/**
+	 * Controls a device without throwing.
+	 *
+	 * @param fd The file descriptor of the device to control.
+	 * @param request The control request code.
+	 * @param arg A pointer to a request-specific output argument.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A nonnegative result code from the control request, or a negative value if an
+	 *         error occurred.
+	 */
+	int ioctl(int fd, unsigned long request, void *arg, std::error_code& ec) noexcept;
+
 	/**
 	 * Controls a device. Note that the library cannot guarantee the underlying ioctl call will
 	 * not modify its argument. Therefore, when using this overload, it is the caller's
@@ -122,6 +242,19 @@ namespace w
 	 */
 	int ioctl(int fd, unsigned long request, const void *arg);
 
+	/**
+	 * Controls a device without throwing. The same caveat applies as for the throwing
+	 * overload taking a `const void *` argument.
+	 *
+	 * @param fd The file descriptor of the device to control.
+	 * @param request The control request code.
+	 * @param arg A pointer to a request-specific input argument.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A nonnegative result code from the control request, or a negative value if an
+	 *         error occurred.
+	 */
+	int ioctl(int fd, unsigned long request, const void *arg, std::error_code& ec) noexcept;
+
 	/**
 	 * Controls a device.
 	 *
@@ -138,6 +271,23 @@ namespace w
 		return w::ioctl(fd, request, reinterpret_cast<void *>(&arg));
 	}
 
+	/**
+	 * Controls a device without throwing.
+	 *
+	 * @tparam Argument The type of @p arg.
+	 * @param fd The file descriptor of the device to control.
+	 * @param request The control request code.
+	 * @param arg A pointer to a request-specific input argument.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A nonnegative result code from the control request, or a negative value if an
+	 *         error occurred.
+	 */
+	template <typename Argument>
+	int ioctl(int fd, unsigned long request, Argument& arg, std::error_code& ec) noexcept
+	{
+		return w::ioctl(fd, request, reinterpret_cast<void *>(&arg), ec);
+	}
+
 	/**
 	 * Controls a device. Note that the library cannot guarantee the underlying ioctl call will
 	 * not modify its argument. Therefore, when using this overload, it is the caller's
@@ -157,6 +307,24 @@ namespace w
 		return w::ioctl(fd, request, reinterpret_cast<const void *>(&arg));
 	}
 
+	/**
+	 * Controls a device without throwing. The same caveat applies as for the throwing
+	 * overload taking a `const Argument&` argument.
+	 *
+	 * @tparam Argument The type of @p arg.
+	 * @param fd The file descriptor of the device to control.
+	 * @param request The control request code.
+	 * @param arg A pointer to a request-specific input argument.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A nonnegative result code from the control request, or a negative value if an
+	 *         error occurred.
+	 */
+	template <typename Argument>
+	int ioctl(int fd, unsigned long request, const Argument& arg, std::error_code& ec) noexcept
+	{
+		return w::ioctl(fd, request, reinterpret_cast<const void *>(&arg), ec);
+	}
+
 	/**
 	 * Controls a device.
 	 *
@@ -174,6 +342,49 @@ namespace w
 		return arg;
 	}
 
+	/**
+	 * Controls a device without throwing.
+	 *
+	 * @tparam Argument The type of the request's output value. This must be specified
+	 *         explicitly.
+	 * @param fd The file descriptor of the device to control.
+	 * @param request The control request code.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The output value, which is unspecified if an error occurred.
+	 */
+	template <typename Argument>
+	Argument ioctl(int fd, unsigned long request, std::error_code& ec) noexcept
+	{
+		Argument arg { };
+		w::ioctl(fd, request, reinterpret_cast<void *>(&arg), ec);
+		return arg;
+	}
+
+	/**
+	 * Creates a hard link to a file relative to directory file descriptors.
+	 *
+	 * @param olddirfd The directory which @p oldpath is relative to, or `AT_FDCWD`.
+	 * @param oldpath The path of the existing file.
+	 * @param newdirfd The directory which @p newpath is relative to, or `AT_FDCWD`.
+	 * @param newpath The path of the new link, which must not exist.
+	 * @param flags A bitwise combination of flags, such as `AT_SYMLINK_FOLLOW`.
+	 * @throw std::system_error An error occurred.
+	 */
+	void linkat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath, int flags = 0);
+
+	/**
+	 * Creates a hard link to a file relative to directory file descriptors without throwing.
+	 *
+	 * @param olddirfd The directory which @p oldpath is relative to, or `AT_FDCWD`.
+	 * @param oldpath The path of the existing file.
+	 * @param newdirfd The directory which @p newpath is relative to, or `AT_FDCWD`.
+	 * @param newpath The path of the new link, which must not exist.
+	 * @param flags A bitwise combination of flags, such as `AT_SYMLINK_FOLLOW`.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void linkat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath, int flags,
+		std::error_code& ec) noexcept;
+
 	/**
 	 * Sets the position of a file pointer for a file descriptor.
 	 *
@@ -185,6 +396,39 @@ namespace w
 	 */
 	std::size_t lseek(int fd, off_t offset, int whence);
 
+	/**
+	 * Sets the position of a file pointer for a file descriptor without throwing.
+	 *
+	 * @param fd The file descriptor to seek in.
+	 * @param offset The offset to seek to.
+	 * @param whence `SEEK_SET`, `SEEK_CUR` or `SEEK_END`.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The new offset relative to the beginning of the file, or zero if an error
+	 *         occurred.
+	 */
+	std::size_t lseek(int fd, off_t offset, int whence, std::error_code& ec) noexcept;
+
+	/**
+	 * Advises the kernel about the expected usage pattern of a range of memory.
+	 *
+	 * @param address The page-aligned start of the range.
+	 * @param length The number of bytes in the range.
+	 * @param advice The usage pattern (e.g. `MADV_SEQUENTIAL` or `MADV_WILLNEED`).
+	 * @throw std::system_error An error occurred.
+	 */
+	void madvise(void *address, std::size_t length, int advice);
+
+	/**
+	 * Advises the kernel about the expected usage pattern of a range of memory without throwing.
+	 * Since advice is only a hint, this overload allows callers to ignore unsupported values.
+	 *
+	 * @param address The page-aligned start of the range.
+	 * @param length The number of bytes in the range.
+	 * @param advice The usage pattern (e.g. `MADV_SEQUENTIAL` or `MADV_WILLNEED`).
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void madvise(void *address, std::size_t length, int advice, std::error_code& ec) noexcept;
+
 #if (__cplusplus >= 201709L)
 	/**
 	 * Maps a file or device into memory.
@@ -199,8 +443,62 @@ namespace w
 	 * @throw std::system_error An error occurred.
 	 */
 	w::mmap_handle mmap(void *address, std::size_t length, int prot, int flags, int fd, off_t offset);
+
+	/**
+	 * Maps a file or device into memory without throwing.
+	 *
+	 * @param address The requested virtual address to map the file or device into.
+	 * @param length The number of bytes to map.
+	 * @param prot The protection flags for the mapping.
+	 * @param flags Additional flags.
+	 * @param fd The file descriptor of the file or device to map.
+	 * @param offset The offset in bytes of the file or device to map.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return An RAII handle for the mapping, which is empty if an error occurred.
+	 */
+	w::mmap_handle mmap(void *address, std::size_t length, int prot, int flags, int fd, off_t offset,
+		std::error_code& ec) noexcept;
 #endif
 
+	/**
+	 * Locks a range of memory into RAM, faulting in its pages and preventing them from being paged
+	 * out.
+	 *
+	 * @param addr The start of the range, which is rounded down to a page boundary.
+	 * @param len The length of the range, in bytes.
+	 * @throw std::system_error An error occurred.
+	 */
+	void mlock(const void *addr, std::size_t len);
+
+	/**
+	 * Locks a range of memory into RAM, faulting in its pages and preventing them from being paged
+	 * out without throwing.
+	 *
+	 * @param addr The start of the range, which is rounded down to a page boundary.
+	 * @param len The length of the range, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void mlock(const void *addr, std::size_t len, std::error_code& ec) noexcept;
+
+	/**
+	 * Unlocks a range of memory locked with mlock(), allowing its pages to be paged out.
+	 *
+	 * @param addr The start of the range, which is rounded down to a page boundary.
+	 * @param len The length of the range, in bytes.
+	 * @throw std::system_error An error occurred.
+	 */
+	void munlock(const void *addr, std::size_t len);
+
+	/**
+	 * Unlocks a range of memory locked with mlock(), allowing its pages to be paged out without
+	 * throwing.
+	 *
+	 * @param addr The start of the range, which is rounded down to a page boundary.
+	 * @param len The length of the range, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void munlock(const void *addr, std::size_t len, std::error_code& ec) noexcept;
+
 	/**
 	 * Opens and possibly creates a file.
 	 *
@@ -211,6 +509,16 @@ namespace w
 	 */
 	w::fd open(const char *pathname, int flags);
 
+	/**
+	 * Opens and possibly creates a file without throwing.
+	 *
+	 * @param pathname The path of the file to open and/or create.
+	 * @param flags A bitwise combination of flags.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A file descriptor for the opened file, which is empty if an error occurred.
+	 */
+	w::fd open(const char *pathname, int flags, std::error_code& ec) noexcept;
+
 	/**
 	 * Opens and possibly creates a file.
 	 *
@@ -222,6 +530,17 @@ namespace w
 	 */
 	w::fd open(const char *pathname, int flags, mode_t mode);
 
+	/**
+	 * Opens and possibly creates a file without throwing.
+	 *
+	 * @param pathname The path of the file to open and/or create.
+	 * @param flags A bitwise combination of flags.
+	 * @param mode The access mode for the file.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A file descriptor for the opened file, which is empty if an error occurred.
+	 */
+	w::fd open(const char *pathname, int flags, mode_t mode, std::error_code& ec) noexcept;
+
 	/**
 	 * Creates a pipe.
 	 *
@@ -230,6 +549,95 @@ namespace w
 	 */
 	std::pair<w::fd, w::fd> pipe();
 
+	/**
+	 * Creates a pipe without throwing.
+	 *
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A pair of file descriptors for the read and write ends of the pipe, respectively,
+	 *         which are both empty if an error occurred.
+	 */
+	std::pair<w::fd, w::fd> pipe(std::error_code& ec) noexcept;
+
+	/**
+	 * Waits for events to occur on a set of file descriptors.
+	 *
+	 * @param fds A pointer to an array of structures describing the file descriptors and events
+	 *        of interest, whose `revents` members are filled in with the events that occurred.
+	 * @param nfds The number of elements in the @p fds array.
+	 * @param timeout The maximum time to wait, or a negative value to wait indefinitely.
+	 * @return The number of file descriptors for which events occurred, which may be zero.
+	 * @throw std::invalid_argument @p timeout is out of range.
+	 * @throw std::system_error An error occurred.
+	 */
+	unsigned poll(struct pollfd *fds, nfds_t nfds,
+		std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+	/**
+	 * Waits for events to occur on a set of file descriptors without throwing. This overload
+	 * allows `EINTR` to be handled without an exception.
+	 *
+	 * @param fds A pointer to an array of structures describing the file descriptors and events
+	 *        of interest, whose `revents` members are filled in with the events that occurred.
+	 * @param nfds The number of elements in the @p fds array.
+	 * @param timeout The maximum time to wait, or a negative value to wait indefinitely.
+	 * @param ec Set to the error which occurred, or cleared on success. An out-of-range
+	 *        @p timeout is reported as `EINVAL`.
+	 * @return The number of file descriptors for which events occurred (which may be zero), or
+	 *         zero if an error occurred.
+	 */
+	unsigned poll(struct pollfd *fds, nfds_t nfds, std::chrono::milliseconds timeout,
+		std::error_code& ec) noexcept;
+
+	/**
+	 * Reads data from a file descriptor at a given offset, without changing its file offset.
+	 *
+	 * @param fd The file descriptor to read from.
+	 * @param buf A pointer to an array where read data should be stored.
+	 * @param count The maximum number of bytes to read.
+	 * @param offset The offset in the file to read from.
+	 * @return The number of bytes actually read, which may be zero.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t pread(int fd, void *buf, std::size_t count, off_t offset);
+
+	/**
+	 * Reads data from a file descriptor at a given offset without throwing.
+	 *
+	 * @param fd The file descriptor to read from.
+	 * @param buf A pointer to an array where read data should be stored.
+	 * @param count The maximum number of bytes to read.
+	 * @param offset The offset in the file to read from.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually read (which may be zero), or zero if an error
+	 *         occurred.
+	 */
+	std::size_t pread(int fd, void *buf, std::size_t count, off_t offset, std::error_code& ec) noexcept;
+
+	/**
+	 * Writes data to a file descriptor at a given offset, without changing its file offset.
+	 *
+	 * @param fd The file descriptor to write to.
+	 * @param buf A pointer to the data to write.
+	 * @param count The number of bytes to write.
+	 * @param offset The offset in the file to write to.
+	 * @return The number of bytes actually written.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t pwrite(int fd, const void *buf, std::size_t count, off_t offset);
+
+	/**
+	 * Writes data to a file descriptor at a given offset without throwing.
+	 *
+	 * @param fd The file descriptor to write to.
+	 * @param buf A pointer to the data to write.
+	 * @param count The number of bytes to write.
+	 * @param offset The offset in the file to write to.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually written, or zero if an error occurred.
+	 */
+	std::size_t pwrite(int fd, const void *buf, std::size_t count, off_t offset,
+		std::error_code& ec) noexcept;
+
 	/**
 	 * Reads data from a file descriptor.
 	 *
@@ -241,6 +649,19 @@ namespace w
 	 */
 	std::size_t read(int fd, void *buf, std::size_t count);
 
+	/**
+	 * Reads data from a file descriptor without throwing. This overload is intended for non-blocking
+	 * files, where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param fd The file descriptor to read from.
+	 * @param buf A pointer to an array where read data should be stored.
+	 * @param count The maximum number of bytes to read.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually read (which may be zero), or zero if an error
+	 *         occurred.
+	 */
+	std::size_t read(int fd, void *buf, std::size_t count, std::error_code& ec) noexcept;
+
 	/**
 	 * Reads data from a file descriptor.
 	 *
@@ -252,6 +673,99 @@ namespace w
 	 */
 	std::size_t readv(int fd, const struct iovec *iov, int iovcnt);
 
+	/**
+	 * Reads data from a file descriptor without throwing. This overload is intended for non-blocking
+	 * files, where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param fd The file descriptor to read from.
+	 * @param iov A pointer to an array of `iovec` scatter-gather structures.
+	 * @param iovcnt The number of structures in the array pointed to by @p iov.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually read (which may be zero), or zero if an error
+	 *         occurred.
+	 */
+	std::size_t readv(int fd, const struct iovec *iov, int iovcnt, std::error_code& ec) noexcept;
+
+	/**
+	 * Renames a file, atomically replacing any existing file at the new path.
+	 *
+	 * @param oldpath The current path of the file.
+	 * @param newpath The new path of the file.
+	 * @throw std::system_error An error occurred.
+	 */
+	void rename(const char *oldpath, const char *newpath);
+
+	/**
+	 * Renames a file, atomically replacing any existing file at the new path without throwing.
+	 *
+	 * @param oldpath The current path of the file.
+	 * @param newpath The new path of the file.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void rename(const char *oldpath, const char *newpath, std::error_code& ec) noexcept;
+
+	/**
+	 * Renames a file relative to directory file descriptors, atomically replacing any existing
+	 * file at the new path.
+	 *
+	 * @param olddirfd The directory which @p oldpath is relative to, or `AT_FDCWD`.
+	 * @param oldpath The current path of the file.
+	 * @param newdirfd The directory which @p newpath is relative to, or `AT_FDCWD`.
+	 * @param newpath The new path of the file.
+	 * @throw std::system_error An error occurred.
+	 */
+	void renameat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath);
+
+	/**
+	 * Renames a file relative to directory file descriptors, atomically replacing any existing
+	 * file at the new path without throwing.
+	 *
+	 * @param olddirfd The directory which @p oldpath is relative to, or `AT_FDCWD`.
+	 * @param oldpath The current path of the file.
+	 * @param newdirfd The directory which @p newpath is relative to, or `AT_FDCWD`.
+	 * @param newpath The new path of the file.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void renameat(int olddirfd, const char *oldpath, int newdirfd, const char *newpath,
+		std::error_code& ec) noexcept;
+
+	/**
+	 * Removes a name of a file.
+	 *
+	 * @param pathname The path to remove.
+	 * @throw std::system_error An error occurred.
+	 */
+	void unlink(const char *pathname);
+
+	/**
+	 * Removes a name of a file without throwing.
+	 *
+	 * @param pathname The path to remove.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void unlink(const char *pathname, std::error_code& ec) noexcept;
+
+	/**
+	 * Removes a name of a file, or an empty directory, relative to a directory file descriptor.
+	 *
+	 * @param dirfd The directory which @p pathname is relative to, or `AT_FDCWD`.
+	 * @param pathname The path to remove.
+	 * @param flags Zero, or `AT_REMOVEDIR` to remove a directory.
+	 * @throw std::system_error An error occurred.
+	 */
+	void unlinkat(int dirfd, const char *pathname, int flags = 0);
+
+	/**
+	 * Removes a name of a file, or an empty directory, relative to a directory file descriptor
+	 * without throwing.
+	 *
+	 * @param dirfd The directory which @p pathname is relative to, or `AT_FDCWD`.
+	 * @param pathname The path to remove.
+	 * @param flags Zero, or `AT_REMOVEDIR` to remove a directory.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void unlinkat(int dirfd, const char *pathname, int flags, std::error_code& ec) noexcept;
+
 	/**
 	 * Writes data to a file descriptor.
 	 *
@@ -263,6 +777,19 @@ namespace w
 	 */
 	std::size_t write(int fd, const void *buf, std::size_t count);
 
+	/**
+	 * Writes data to a file descriptor without throwing. This overload is intended for non-blocking
+	 * files, where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param fd The file descriptor to write to.
+	 * @param buf A pointer to an array of data to write.
+	 * @param count The maximum number of bytes to write.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually written (which may be zero), or zero if an error
+	 *         occurred.
+	 */
+	std::size_t write(int fd, const void *buf, std::size_t count, std::error_code& ec) noexcept;
+
 	/**
 	 * Writes data to a file descriptor.
 	 *
@@ -273,4 +800,21 @@ namespace w
 	 * @throw std::system_error An error occurred. This includes `EAGAIN` on non-blocking files.
 	 */
 	std::size_t writev(int fd, const struct iovec *iov, int iovcnt);
+
+	/**
+	 * Writes data to a file descriptor without throwing. This overload is intended for non-blocking
+	 * files, where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param fd The file descriptor to write to.
+	 * @param iov A pointer to an array of `iovec` scatter-gather structures.
+	 * @param iovcnt The number of structures in the array pointed to by @p iov.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes actually written (which may be zero), or zero if an error
+	 *         occurred.
+	 */
+	std::size_t writev(int fd, const struct iovec *iov, int iovcnt, std::error_code& ec) noexcept;
 }
+
+#ifdef CPPWRAP_HEADER_ONLY
+#include <w/impl/posix.ipp>
+#endif
@@ -9,8 +9,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <stdexcept>
+#include <system_error>
 
+#include <endian.h>
 #include <ifaddrs.h>
 #include <netinet/ip6.h>
 #include <sys/socket.h>
@@ -156,6 +159,22 @@ namespace w
 	 */
 	w::fd accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen);
 
+	/**
+	 * Accepts a connection on a socket without throwing. This overload is intended for
+	 * non-blocking sockets, where `EAGAIN` is reported through @p ec rather than as an
+	 * exception.
+	 *
+	 * @param sockfd The socket on which to accept a connection.
+	 * @param addr A pointer to the address of the remote endpoint.
+	 * @param addrlen A pointer to the size of the structure pointed to by @p addr, in bytes. On
+	 *        return, the value holds the actual size of the source address. This might be larger
+	 *        than the input value, in which case the address was truncated.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The socket file descriptor of the new connection, which is empty if an error
+	 *         occurred.
+	 */
+	w::fd accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen, std::error_code& ec) noexcept;
+
 	/**
 	 * Accepts a connection on a socket.
 	 *
@@ -179,6 +198,116 @@ namespace w
 		return fd;
 	}
 
+	/**
+	 * Accepts a connection on a socket without throwing.
+	 *
+	 * @tparam Address The type of @p addr.
+	 * @param sockfd The socket on which to accept a connection.
+	 * @param addr A reference to the address of the remote endpoint.
+	 * @param ec Set to the error which occurred, or cleared on success. If the structure
+	 *        referenced by @p addr is not the correct size to hold the remote address, the
+	 *        connection is closed and @p ec is set to `EINVAL`.
+	 * @return The socket file descriptor of the new connection, which is empty if an error
+	 *         occurred.
+	 */
+	template <typename Address>
+	w::fd accept(int sockfd, Address& addr, std::error_code& ec) noexcept
+	{
+		socklen_t addrlen = sizeof(addr);
+		w::fd fd = w::accept(sockfd, reinterpret_cast<struct sockaddr *>(&addr), &addrlen, ec);
+
+		if (!ec && addrlen != sizeof(addr))
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return { };
+		}
+
+		return fd;
+	}
+
+	/**
+	 * Accepts a connection on a socket, setting flags on the new socket atomically.
+	 *
+	 * @param sockfd The socket on which to accept a connection.
+	 * @param addr A pointer to the address of the remote endpoint, or `nullptr`.
+	 * @param addrlen A pointer to the size of the structure pointed to by @p addr, in bytes, or
+	 *        `nullptr`. On return, the value holds the actual size of the source address.
+	 * @param flags A bitwise combination of `SOCK_NONBLOCK` and `SOCK_CLOEXEC`.
+	 * @return The socket file descriptor of the new connection.
+	 * @throw std::system_error An error occurred.
+	 */
+	w::fd accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags);
+
+	/**
+	 * Accepts a connection on a socket, setting flags on the new socket atomically, without
+	 * throwing. This overload is intended for non-blocking sockets, where `EAGAIN` is reported
+	 * through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket on which to accept a connection.
+	 * @param addr A pointer to the address of the remote endpoint, or `nullptr`.
+	 * @param addrlen A pointer to the size of the structure pointed to by @p addr, in bytes, or
+	 *        `nullptr`. On return, the value holds the actual size of the source address.
+	 * @param flags A bitwise combination of `SOCK_NONBLOCK` and `SOCK_CLOEXEC`.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The socket file descriptor of the new connection, which is empty if an error
+	 *         occurred.
+	 */
+	w::fd accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags,
+		std::error_code& ec) noexcept;
+
+	/**
+	 * Accepts a connection on a socket, setting flags on the new socket atomically.
+	 *
+	 * @tparam Address The type of @p addr.
+	 * @param sockfd The socket on which to accept a connection.
+	 * @param addr A reference to the address of the remote endpoint.
+	 * @param flags A bitwise combination of `SOCK_NONBLOCK` and `SOCK_CLOEXEC`.
+	 * @throw std::system_error An error occurred.
+	 * @throw std::runtime_error The structure referenced by @p addr is not the correct size to
+	 *        hold the remote address.
+	 */
+	template <typename Address>
+	w::fd accept4(int sockfd, Address& addr, int flags)
+	{
+		socklen_t addrlen = sizeof(addr);
+		w::fd fd = w::accept4(sockfd, reinterpret_cast<struct sockaddr *>(&addr), &addrlen, flags);
+
+		if (addrlen != sizeof(addr))
+			throw std::runtime_error(
+				"provided structure is not the correct size to hold receive connect address");
+
+		return fd;
+	}
+
+	/**
+	 * Accepts a connection on a socket, setting flags on the new socket atomically, without
+	 * throwing.
+	 *
+	 * @tparam Address The type of @p addr.
+	 * @param sockfd The socket on which to accept a connection.
+	 * @param addr A reference to the address of the remote endpoint.
+	 * @param flags A bitwise combination of `SOCK_NONBLOCK` and `SOCK_CLOEXEC`.
+	 * @param ec Set to the error which occurred, or cleared on success. If the structure
+	 *        referenced by @p addr is not the correct size to hold the remote address, the
+	 *        connection is closed and @p ec is set to `EINVAL`.
+	 * @return The socket file descriptor of the new connection, which is empty if an error
+	 *         occurred.
+	 */
+	template <typename Address>
+	w::fd accept4(int sockfd, Address& addr, int flags, std::error_code& ec) noexcept
+	{
+		socklen_t addrlen = sizeof(addr);
+		w::fd fd = w::accept4(sockfd, reinterpret_cast<struct sockaddr *>(&addr), &addrlen, flags, ec);
+
+		if (!ec && addrlen != sizeof(addr))
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return { };
+		}
+
+		return fd;
+	}
+
 	/**
 	 * Binds a socket to an address.
 	 *
@@ -189,6 +318,16 @@ namespace w
 	 */
 	void bind(int sockfd, const struct sockaddr *addr, socklen_t addrlen);
 
+	/**
+	 * Binds a socket to an address without throwing.
+	 *
+	 * @param sockfd The socket to bind.
+	 * @param addr A pointer to the address to bind to.
+	 * @param addrlen The size of the structure pointed to by @p addr, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void bind(int sockfd, const struct sockaddr *addr, socklen_t addrlen, std::error_code& ec) noexcept;
+
 	/**
 	 * Binds a socket.
 	 *
@@ -203,6 +342,20 @@ namespace w
 		w::bind(sockfd, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr));
 	}
 
+	/**
+	 * Binds a socket without throwing.
+	 *
+	 * @tparam Address The type of @p addr.
+	 * @param sockfd The socket to bind.
+	 * @param addr A reference to the address to bind to.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	template <typename Address>
+	void bind(int sockfd, const Address& addr, std::error_code& ec) noexcept
+	{
+		w::bind(sockfd, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr), ec);
+	}
+
 	/**
 	 * Connects a socket.
 	 *
@@ -213,6 +366,17 @@ namespace w
 	 */
 	void connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen);
 
+	/**
+	 * Connects a socket without throwing. This overload is intended for non-blocking sockets,
+	 * where `EINPROGRESS` is reported through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to connect.
+	 * @param addr A pointer to the address to connect to.
+	 * @param addrlen The size of the structure pointed to by @p addr, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen, std::error_code& ec) noexcept;
+
 	/**
 	 * Connects a socket.
 	 *
@@ -227,6 +391,20 @@ namespace w
 		w::connect(sockfd, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr));
 	}
 
+	/**
+	 * Connects a socket without throwing.
+	 *
+	 * @tparam Address The type of @p addr.
+	 * @param sockfd The socket to connect.
+	 * @param addr A reference to the address to connect to.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	template <typename Address>
+	void connect(int sockfd, const Address& addr, std::error_code& ec) noexcept
+	{
+		w::connect(sockfd, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr), ec);
+	}
+
 	/**
 	 * Gets a pointer to the head of a linked list of the system's network interfaces.
 	 *
@@ -235,6 +413,49 @@ namespace w
 	 */
 	w::handle<struct ifaddrs *, nullptr, ::freeifaddrs> getifaddrs();
 
+	/**
+	 * Gets a pointer to the head of a linked list of the system's network interfaces without
+	 * throwing.
+	 *
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return A pointer to the head of a linked list of the system's network interfaces, which
+	 *         is empty if an error occurred.
+	 */
+	w::handle<struct ifaddrs *, nullptr, ::freeifaddrs> getifaddrs(std::error_code& ec) noexcept;
+
+	/**
+	 * Gets the address a socket is bound to.
+	 *
+	 * @param sockfd The socket.
+	 * @param addr A pointer to a structure to be filled in with the address.
+	 * @param addrlen A pointer to the size of the structure pointed to by @p addr, in bytes. On
+	 *        return, the value holds the actual size of the address. This might be larger than
+	 *        the input value, in which case the address was truncated.
+	 * @throw std::system_error An error occurred.
+	 */
+	void getsockname(int sockfd, struct sockaddr *addr, socklen_t *addrlen);
+
+	/**
+	 * Gets the address a socket is bound to.
+	 *
+	 * @tparam Address The type of @p addr.
+	 * @param sockfd The socket.
+	 * @param addr A reference to a structure to be filled in with the address.
+	 * @throw std::system_error An error occurred.
+	 * @throw std::runtime_error The structure referenced by @p addr is not the correct size to
+	 *        hold the address.
+	 */
+	template <typename Address>
+	void getsockname(int sockfd, Address& addr)
+	{
+		socklen_t addrlen = sizeof(addr);
+		w::getsockname(sockfd, reinterpret_cast<struct sockaddr *>(&addr), &addrlen);
+
+		if (addrlen != sizeof(addr))
+			throw std::runtime_error(
+				"provided structure is not the correct size to hold socket address");
+	}
+
 	/**
 	 * Gets an option on a socket.
 	 *
@@ -251,6 +472,22 @@ namespace w
 	int getsockopt(int sockfd, int level, int optname,
 		void *optval = nullptr, socklen_t *optlen = nullptr);
 
+	/**
+	 * Gets an option on a socket without throwing.
+	 *
+	 * @param sockfd The socket on which to get the option.
+	 * @param level The option level.
+	 * @param optname The option to get.
+	 * @param optval A pointer to the value to be filled in.
+	 * @param optlen A pointer to the size of the value pointed to by @p optval. On return, the
+	 *        value holds the actual size of the value. This might be larger than the input value,
+	 *        in which case the value was truncated.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The return value of the option, or -1 if an error occurred.
+	 */
+	int getsockopt(int sockfd, int level, int optname,
+		void *optval, socklen_t *optlen, std::error_code& ec) noexcept;
+
 	/**
 	 * Gets an option on a socket.
 	 *
@@ -273,6 +510,27 @@ namespace w
 		return optval;
 	}
 
+	/**
+	 * Gets an option on a socket without throwing.
+	 *
+	 * @param sockfd The socket on which to get the option.
+	 * @param level The option level.
+	 * @param optname The option to get.
+	 * @param ec Set to the error which occurred, or cleared on success. If @p Value has the
+	 *        wrong size for this option, @p ec is set to `EINVAL`.
+	 * @return The value returned for the option, which is unspecified if an error occurred.
+	 */
+	template <typename Value>
+	Value getsockopt(int sockfd, int level, int optname, std::error_code& ec) noexcept
+	{
+		Value optval { };
+		socklen_t optlen = sizeof(optval);
+		w::getsockopt(sockfd, level, optname, &optval, &optlen, ec);
+		if (!ec && optlen != sizeof(optval))
+			ec = std::make_error_code(std::errc::invalid_argument);
+		return optval;
+	}
+
 	/**
 	 * Returns the index of the specified network interface.
 	 *
@@ -282,6 +540,15 @@ namespace w
 	 */
 	unsigned if_nametoindex(const char *ifname);
 
+	/**
+	 * Returns the index of the specified network interface without throwing.
+	 *
+	 * @param ifname The name of the network interface.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The nonzero index of the network interface, or zero if an error occurred.
+	 */
+	unsigned if_nametoindex(const char *ifname, std::error_code& ec) noexcept;
+
 	/**
 	 * Converts an IPv4 or IPv6 address to a string.
 	 *
@@ -294,6 +561,18 @@ namespace w
 	 */
 	char *inet_ntop(int af, const void *src, char *dst, socklen_t size);
 
+	/**
+	 * Converts an IPv4 or IPv6 address to a string without throwing.
+	 *
+	 * @param af The address family.
+	 * @param src A pointer to the address.
+	 * @param dst A pointer to a character buffer to be filled.
+	 * @param size The size of the buffer pointed to by @p dst, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return @p dst, or `nullptr` if an error occurred.
+	 */
+	char *inet_ntop(int af, const void *src, char *dst, socklen_t size, std::error_code& ec) noexcept;
+
 	/**
 	 * Converts an IPv4 or IPv6 address from a string to a binary value.
 	 *
@@ -305,6 +584,18 @@ namespace w
 	 */
 	void *inet_pton(int af, const char *src, void *dst);
 
+	/**
+	 * Converts an IPv4 or IPv6 address from a string to a binary value without throwing.
+	 *
+	 * @param af The address family.
+	 * @param src A pointer to the address string.
+	 * @param dst A pointer to a socket address structure to be filled.
+	 * @param ec Set to the error which occurred, or cleared on success. An invalid address
+	 *        string is reported as `EINVAL`.
+	 * @return @p dst, or `nullptr` if an error occurred.
+	 */
+	void *inet_pton(int af, const char *src, void *dst, std::error_code& ec) noexcept;
+
 	/**
 	 * Converts an IPv4 or IPv6 address from a string to a binary value.
 	 *
@@ -321,6 +612,23 @@ namespace w
 		return dst;
 	}
 
+	/**
+	 * Converts an IPv4 or IPv6 address from a string to a binary value without throwing.
+	 *
+	 * @param af The address family.
+	 * @param src A pointer to the address string.
+	 * @param dst A reference to a socket address structure to be filled.
+	 * @param ec Set to the error which occurred, or cleared on success. An invalid address
+	 *        string is reported as `EINVAL`.
+	 * @return @p dst.
+	 */
+	template <typename Address>
+	Address& inet_pton(int af, const char *src, Address& dst, std::error_code& ec) noexcept
+	{
+		w::inet_pton(af, src, static_cast<void *>(&dst), ec);
+		return dst;
+	}
+
 	/**
 	 * Puts a socket in a listening state.
 	 *
@@ -330,6 +638,15 @@ namespace w
 	 */
 	void listen(int sockfd, int backlog);
 
+	/**
+	 * Puts a socket in a listening state without throwing.
+	 *
+	 * @param sockfd The socket to listen on.
+	 * @param backlog The maximum number of pending connections to allow.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void listen(int sockfd, int backlog, std::error_code& ec) noexcept;
+
 	/**
 	 * Receives a message from a socket.
 	 *
@@ -342,6 +659,20 @@ namespace w
 	 */
 	std::size_t recv(int sockfd, void *buf, std::size_t len, int flags = 0);
 
+	/**
+	 * Receives a message from a socket without throwing. This overload is intended for non-blocking sockets,
+	 * where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to receive from.
+	 * @param buf A pointer to an array where received data should be stored.
+	 * @param len The maximum number of bytes to receive.
+	 * @param flags A bitwise combination of flags.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes successfully received (which may be zero), or zero if an
+	 *         error occurred.
+	 */
+	std::size_t recv(int sockfd, void *buf, std::size_t len, int flags, std::error_code& ec) noexcept;
+
 	/**
 	 * Receives a message from a socket.
 	 *
@@ -353,6 +684,53 @@ namespace w
 	 */
 	std::size_t recvmsg(int sockfd, struct msghdr *msg, int flags = 0);
 
+	/**
+	 * Receives a message from a socket without throwing. This overload is intended for non-blocking sockets,
+	 * where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to receive from.
+	 * @param msg A pointer to a message structure to be filled in.
+	 * @param flags A bitwise combination of flags.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes successfully received (which may be zero), or zero if an
+	 *         error occurred.
+	 */
+	std::size_t recvmsg(int sockfd, struct msghdr *msg, int flags, std::error_code& ec) noexcept;
+
+	/**
+	 * Receives multiple messages from a socket with a single system call.
+	 *
+	 * @param sockfd The socket to receive from.
+	 * @param msgvec A pointer to an array of message structures to be filled in. On return, the
+	 *        `msg_len` member of each filled-in element holds the number of bytes received.
+	 * @param vlen The number of elements in the array pointed to by @p msgvec.
+	 * @param flags A bitwise combination of flags.
+	 * @param timeout A pointer to a timeout for the operation, or `nullptr` (see the man page for
+	 *        caveats).
+	 * @return The number of messages received (which may be zero only for a zero @p vlen).
+	 * @throw std::system_error An error occurred. This includes `EAGAIN` on non-blocking sockets.
+	 */
+	unsigned recvmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags = 0,
+		struct timespec *timeout = nullptr);
+
+	/**
+	 * Receives multiple messages from a socket with a single system call without throwing.
+	 * This overload is intended for non-blocking sockets, where `EAGAIN` is reported through
+	 * @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to receive from.
+	 * @param msgvec A pointer to an array of message structures to be filled in. On return, the
+	 *        `msg_len` member of each filled-in element holds the number of bytes received.
+	 * @param vlen The number of elements in the array pointed to by @p msgvec.
+	 * @param flags A bitwise combination of flags.
+	 * @param timeout A pointer to a timeout for the operation, or `nullptr` (see the man page for
+	 *        caveats).
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of messages received, or zero if an error occurred.
+	 */
+	unsigned recvmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags,
+		struct timespec *timeout, std::error_code& ec) noexcept;
+
 	/**
 	 * Receives a message from a socket.
 	 *
@@ -372,6 +750,25 @@ namespace w
 	std::size_t recvfrom(int sockfd, void *buf, std::size_t len, int flags,
 		struct sockaddr *src_addr = nullptr, socklen_t *addrlen = nullptr);
 
+	/**
+	 * Receives a message from a socket without throwing. This overload is intended for non-blocking sockets,
+	 * where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to receive from.
+	 * @param buf A pointer to an array where received data should be stored.
+	 * @param len The maximum number of bytes to receive.
+	 * @param flags A bitwise combination of flags.
+	 * @param src_addr A pointer to the source address.
+	 * @param addrlen A pointer to the size of the structure pointed to by @p src_addr, in bytes.
+	 *        On return, the value holds the actual size of the source address. This might be
+	 *        larger than the input value, in which case the address was truncated.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes successfully received (which may be zero), or zero if an
+	 *         error occurred.
+	 */
+	std::size_t recvfrom(int sockfd, void *buf, std::size_t len, int flags,
+		struct sockaddr *src_addr, socklen_t *addrlen, std::error_code& ec) noexcept;
+
 	/**
 	 * Receives a message from a socket.
 	 *
@@ -400,6 +797,38 @@ namespace w
 		return rv;
 	}
 
+	/**
+	 * Receives a message from a socket without throwing.
+	 *
+	 * @tparam Address The type of @p src_addr.
+	 * @param sockfd The socket to receive from.
+	 * @param buf A pointer to an array where received data should be stored.
+	 * @param len The maximum number of bytes to receive.
+	 * @param flags A bitwise combination of flags.
+	 * @param src_addr A reference to the source address.
+	 * @param ec Set to the error which occurred, or cleared on success. If the structure
+	 *        referenced by @p src_addr is not the correct size to hold the source address,
+	 *        @p ec is set to `EINVAL`.
+	 * @return The number of bytes successfully received (which may be zero), or zero if an
+	 *         error occurred.
+	 */
+	template <typename Address>
+	std::size_t recvfrom(int sockfd, void *buf, std::size_t len, int flags, Address& src_addr,
+		std::error_code& ec) noexcept
+	{
+		socklen_t addrlen = sizeof(src_addr);
+		std::size_t rv = w::recvfrom(sockfd, buf, len, flags,
+			reinterpret_cast<struct sockaddr *>(&src_addr), &addrlen, ec);
+
+		if (!ec && addrlen != sizeof(src_addr))
+		{
+			ec = std::make_error_code(std::errc::invalid_argument);
+			return 0;
+		}
+
+		return rv;
+	}
+
 	/**
 	 * Sends a message on a socket.
 	 *
@@ -412,6 +841,20 @@ namespace w
 	 */
 	std::size_t send(int sockfd, const void *buf, std::size_t len, int flags = 0);
 
+	/**
+	 * Sends a message on a socket without throwing. This overload is intended for non-blocking sockets,
+	 * where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to send from.
+	 * @param buf A pointer to the data to send.
+	 * @param len The maximum number of bytes to send.
+	 * @param flags A bitwise combination of flags.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes successfully accepted for transmission (which may be zero),
+	 *         or zero if an error occurred.
+	 */
+	std::size_t send(int sockfd, const void *buf, std::size_t len, int flags, std::error_code& ec) noexcept;
+
 	/**
 	 * Sends a message on a socket.
 	 *
@@ -423,6 +866,52 @@ namespace w
 	 */
 	std::size_t sendmsg(int sockfd, const struct msghdr *msg, int flags = 0);
 
+	/**
+	 * Sends a message on a socket without throwing. This overload is intended for non-blocking sockets,
+	 * where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to send from.
+	 * @param msg A pointer to a message structure describing the message to send.
+	 * @param flags A bitwise combination of flags.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes successfully accepted for transmission (which may be zero),
+	 *         or zero if an error occurred.
+	 */
+	std::size_t sendmsg(int sockfd, const struct msghdr *msg, int flags, std::error_code& ec) noexcept;
+
+	/**
+	 * Sends multiple messages on a socket with a single system call.
+	 *
+	 * @param sockfd The socket to send from.
+	 * @param msgvec A pointer to an array of message structures describing the messages to send.
+	 *        On return, the `msg_len` member of each sent element holds the number of bytes
+	 *        sent.
+	 * @param vlen The number of elements in the array pointed to by @p msgvec.
+	 * @param flags A bitwise combination of flags.
+	 * @return The number of messages sent, which may be less than @p vlen.
+	 * @throw std::system_error An error occurred before any message was sent. This includes
+	 *        `EAGAIN` on non-blocking sockets.
+	 */
+	unsigned sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags = 0);
+
+	/**
+	 * Sends multiple messages on a socket with a single system call without throwing. This
+	 * overload is intended for non-blocking sockets, where `EAGAIN` is reported through @p ec
+	 * rather than as an exception.
+	 *
+	 * @param sockfd The socket to send from.
+	 * @param msgvec A pointer to an array of message structures describing the messages to send.
+	 *        On return, the `msg_len` member of each sent element holds the number of bytes
+	 *        sent.
+	 * @param vlen The number of elements in the array pointed to by @p msgvec.
+	 * @param flags A bitwise combination of flags.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of messages sent, which may be less than @p vlen, or zero if an error
+	 *         occurred.
+	 */
+	unsigned sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned vlen, int flags,
+		std::error_code& ec) noexcept;
+
 	/**
 	 * Sends a message on a socket.
 	 *
@@ -438,6 +927,23 @@ namespace w
 	std::size_t sendto(int sockfd, const void *buf, std::size_t len,
 		int flags, const struct sockaddr *dest_addr, socklen_t addrlen);
 
+	/**
+	 * Sends a message on a socket without throwing. This overload is intended for non-blocking sockets,
+	 * where `EAGAIN` is reported through @p ec rather than as an exception.
+	 *
+	 * @param sockfd The socket to send from.
+	 * @param buf A pointer to the data to send.
+	 * @param len The maximum number of bytes to send.
+	 * @param flags A bitwise combination of flags.
+	 * @param dest_addr A pointer to the destination address.
+	 * @param addrlen The size of the structure pointed to by @p dest_addr, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes successfully accepted for transmission (which may be zero),
+	 *         or zero if an error occurred.
+	 */
+	std::size_t sendto(int sockfd, const void *buf, std::size_t len,
+		int flags, const struct sockaddr *dest_addr, socklen_t addrlen, std::error_code& ec) noexcept;
+
 	/**
 	 * Sends a message on a socket.
 	 *
@@ -458,6 +964,27 @@ namespace w
 			reinterpret_cast<const struct sockaddr *>(&dest_addr), sizeof(dest_addr));
 	}
 
+	/**
+	 * Sends a message on a socket without throwing.
+	 *
+	 * @tparam Address The type of @p dest_addr.
+	 * @param sockfd The socket to send from.
+	 * @param buf A pointer to the data to send.
+	 * @param len The number of bytes to send.
+	 * @param flags A bitwise combination of flags.
+	 * @param dest_addr A reference to the destination address.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The number of bytes successfully accepted for transmission (which may be zero),
+	 *         or zero if an error occurred.
+	 */
+	template <typename Address>
+	std::size_t sendto(int sockfd, const void *buf, std::size_t len,
+		int flags, const Address& dest_addr, std::error_code& ec) noexcept
+	{
+		return w::sendto(sockfd, buf, len, flags,
+			reinterpret_cast<const struct sockaddr *>(&dest_addr), sizeof(dest_addr), ec);
+	}
+
 	/**
 	 * Sets an option on a socket.
 	 *
@@ -472,6 +999,20 @@ namespace w
 	int setsockopt(int sockfd, int level, int optname,
 		const void *optval = nullptr, socklen_t optlen = 0);
 
+	/**
+	 * Sets an option on a socket without throwing.
+	 *
+	 * @param sockfd The socket on which to set the option.
+	 * @param level The option level.
+	 * @param optname The option to set.
+	 * @param optval A pointer to the value to set.
+	 * @param optlen The size of the value pointed to by @p optval, in bytes.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The return value of the option, or -1 if an error occurred.
+	 */
+	int setsockopt(int sockfd, int level, int optname,
+		const void *optval, socklen_t optlen, std::error_code& ec) noexcept;
+
 	/**
 	 * Sets an option on a socket.
 	 *
@@ -488,6 +1029,22 @@ namespace w
 		w::setsockopt(sockfd, level, optname, &optval, sizeof(optval));
 	}
 
+	/**
+	 * Sets an option on a socket without throwing.
+	 *
+	 * @tparam Value The type of @p optval.
+	 * @param sockfd The socket on which to set the option.
+	 * @param level The option level.
+	 * @param optname The option to set.
+	 * @param optval A reference to the value to set.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	template <typename Value>
+	void setsockopt(int sockfd, int level, int optname, const Value& optval, std::error_code& ec) noexcept
+	{
+		w::setsockopt(sockfd, level, optname, &optval, sizeof(optval), ec);
+	}
+
 	/**
 	 * Shuts down part of a full-duplex connection.
 	 *
@@ -497,6 +1054,15 @@ namespace w
 	 */
 	void shutdown(int sockfd, int how);
 
+	/**
+	 * Shuts down part of a full-duplex connection without throwing.
+	 *
+	 * @param sockfd The socket to shut down.
+	 * @param how A flag specifying what to shut down.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 */
+	void shutdown(int sockfd, int how, std::error_code& ec) noexcept;
+
 	/**
 	 * Creates a socket.
 	 *
@@ -507,6 +1073,72 @@ namespace w
 	 * @throw std::system_error An error occurred.
 	*/
 	w::fd socket(int domain, int type, int protocol = 0);
+
+	/**
+	 * Creates a socket without throwing.
+	 *
+	 * @param domain The communication domain.
+	 * @param type The type of socket.
+	 * @param protocol The protocol on which to communicate.
+	 * @param ec Set to the error which occurred, or cleared on success.
+	 * @return The created socket, which is empty if an error occurred.
+	 */
+	w::fd socket(int domain, int type, int protocol, std::error_code& ec) noexcept;
+
+	/// @cond
+	namespace detail
+	{
+		inline std::uint64_t in6_word(const in6_addr& address, int i) noexcept
+		{
+			std::uint64_t word;
+			std::memcpy(&word, address.s6_addr + 8 * i, sizeof(word));
+			return word;
+		}
+
+		// The finalizer of MurmurHash3, applied to a combination of two words.
+		constexpr std::size_t hash_words(std::uint64_t a, std::uint64_t b) noexcept
+		{
+			std::uint64_t h = a ^ (b * 0x9e3779b97f4a7c15);
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccd;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53;
+			h ^= h >> 33;
+			return static_cast<std::size_t>(h);
+		}
+	}
+	/// @endcond
+
+	/**
+	 * Compares two IPv4 socket addresses, including their ports.
+	 *
+	 * @param a The first address to compare.
+	 * @param b The second address to compare.
+	 * @return `true` if @p a and @p b are the same address and port.
+	 */
+	inline bool operator==(const ipv4_address& a, const ipv4_address& b) noexcept
+	{
+		return a.sin_family == b.sin_family &&
+			a.sin_port == b.sin_port &&
+			a.sin_addr.s_addr == b.sin_addr.s_addr;
+	}
+
+	/**
+	 * Compares two IPv6 socket addresses, including their ports and scopes. The flow
+	 * information is ignored.
+	 *
+	 * @param a The first address to compare.
+	 * @param b The second address to compare.
+	 * @return `true` if @p a and @p b are the same address, port and scope.
+	 */
+	inline bool operator==(const ipv6_address& a, const ipv6_address& b) noexcept
+	{
+		return a.sin6_family == b.sin6_family &&
+			a.sin6_port == b.sin6_port &&
+			a.sin6_scope_id == b.sin6_scope_id &&
+			detail::in6_word(a.sin6_addr, 0) == detail::in6_word(b.sin6_addr, 0) &&
+			detail::in6_word(a.sin6_addr, 1) == detail::in6_word(b.sin6_addr, 1);
+	}
 }
 
 namespace w::detail
@@ -515,6 +1147,26 @@ namespace w::detail
 	{
 		return cur->ifa_next;
 	}
+
+	inline bool valid_cmsghdr(const struct cmsghdr *cur, std::size_t remaining)
+	{
+		return remaining >= sizeof(struct cmsghdr) &&
+			cur->cmsg_len >= CMSG_LEN(0) &&
+			cur->cmsg_len <= remaining;
+	}
+
+	inline const struct cmsghdr *get_next_cmsghdr(const struct cmsghdr *cur, std::size_t& remaining)
+	{
+		// As with CMSG_NXTHDR(), the padding of the last control message may extend past the
+		// end of the buffer, so it is clamped.
+
+		std::size_t length = CMSG_ALIGN(cur->cmsg_len);
+		if (length > remaining)
+			length = remaining;
+
+		remaining -= length;
+		return reinterpret_cast<const struct cmsghdr *>(reinterpret_cast<const char *>(cur) + length);
+	}
 }
 
 /**
@@ -539,6 +1191,30 @@ inline auto end(const struct ifaddrs *ptr) noexcept
 	return w::const_list_iterator<struct ifaddrs, w::detail::get_next_ifaddrs>();
 }
 
+namespace w
+{
+	/**
+	 * A range of the control messages (ancillary data) of a message.
+	 */
+	typedef w::const_sized_list<struct cmsghdr, w::detail::valid_cmsghdr, w::detail::get_next_cmsghdr> control_message_list;
+
+	/**
+	 * Gets the control messages (ancillary data) of a message, such as one filled in by
+	 * w::recvmsg(). Iteration stops at the first control message which is truncated or
+	 * malformed.
+	 *
+	 * @param msg The message, whose `msg_controllen` is the number of bytes of ancillary data.
+	 * @return A range of the control messages.
+	 */
+	inline control_message_list control_messages(const struct msghdr& msg) noexcept
+	{
+		if (!msg.msg_control)
+			return { nullptr, 0 };
+
+		return { static_cast<const struct cmsghdr *>(msg.msg_control), msg.msg_controllen };
+	}
+}
+
 /**
  * Compares two IPv6 addresses.
  *
@@ -548,7 +1224,8 @@ inline auto end(const struct ifaddrs *ptr) noexcept
  */
 inline bool operator==(const in6_addr& a, const in6_addr& b) noexcept
 {
-	return 0 == std::memcmp(&a, &b, sizeof(in6_addr));
+	return w::detail::in6_word(a, 0) == w::detail::in6_word(b, 0) &&
+		w::detail::in6_word(a, 1) == w::detail::in6_word(b, 1);
 }
 
 /**
@@ -572,5 +1249,58 @@ inline bool operator!=(const in6_addr& a, const in6_addr& b) noexcept
  */
 inline bool operator<(const in6_addr& a, const in6_addr& b) noexcept
 {
-	return std::memcmp(&a, &b, sizeof(in6_addr)) < 0;
+	// Addresses are in network byte order, so each word is converted to host byte order to
+	// compare them numerically.
+
+	std::uint64_t a_high = be64toh(w::detail::in6_word(a, 0));
+	std::uint64_t b_high = be64toh(w::detail::in6_word(b, 0));
+
+	if (a_high != b_high)
+		return a_high < b_high;
+
+	return be64toh(w::detail::in6_word(a, 1)) < be64toh(w::detail::in6_word(b, 1));
 }
+
+/**
+ * Hashes IPv6 addresses, so that they can be used as keys of unordered containers.
+ */
+template <>
+struct std::hash<in6_addr>
+{
+	std::size_t operator()(const in6_addr& address) const noexcept
+	{
+		return w::detail::hash_words(w::detail::in6_word(address, 0), w::detail::in6_word(address, 1));
+	}
+};
+
+/**
+ * Hashes IPv4 socket addresses, including their ports.
+ */
+template <>
+struct std::hash<w::ipv4_address>
+{
+	std::size_t operator()(const w::ipv4_address& address) const noexcept
+	{
+		return w::detail::hash_words(address.sin_addr.s_addr, address.sin_port);
+	}
+};
+
+/**
+ * Hashes IPv6 socket addresses, including their ports and scopes.
+ */
+template <>
+struct std::hash<w::ipv6_address>
+{
+	std::size_t operator()(const w::ipv6_address& address) const noexcept
+	{
+		std::uint64_t extra = (static_cast<std::uint64_t>(address.sin6_scope_id) << 16) | address.sin6_port;
+
+		return w::detail::hash_words(
+			w::detail::hash_words(w::detail::in6_word(address.sin6_addr, 0), w::detail::in6_word(address.sin6_addr, 1)),
+			extra);
+	}
+};
+
+#ifdef CPPWRAP_HEADER_ONLY
+#include <w/impl/sockets.ipp>
+#endif
@@ -0,0 +1,145 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include <w/posix.hpp>
+
+#include <sys/mman.h>
+
+namespace wx
+{
+	/**
+	 * Gets the default huge page size of the system, as reported by `/proc/meminfo`. The result
+	 * is read once and cached.
+	 *
+	 * @return The size of a huge page, in bytes, or zero if huge pages are not supported.
+	 */
+	std::size_t huge_page_size() noexcept;
+
+	/**
+	 * Gets the w::mmap() flags which request huge pages of a given size.
+	 *
+	 * @param page_size The huge page size, which must be a power of two supported by the
+	 *        system (such as 2 MiB or 1 GiB on x86-64), or zero for the default size.
+	 * @return `MAP_HUGETLB`, combined with the encoding of @p page_size.
+	 */
+	constexpr int map_huge_flags(std::size_t page_size) noexcept
+	{
+		return MAP_HUGETLB | (page_size ? std::countr_zero(page_size) << MAP_HUGE_SHIFT : 0);
+	}
+
+	/**
+	 * Rounds a size up to a multiple of a power of two, such as a page size.
+	 *
+	 * @param size The size.
+	 * @param alignment The power of two.
+	 * @return The smallest multiple of @p alignment which is at least @p size.
+	 */
+	constexpr std::size_t round_up(std::size_t size, std::size_t alignment) noexcept
+	{
+		return (size + alignment - 1) & ~(alignment - 1);
+	}
+
+	/**
+	 * A bump allocator over large anonymous memory mappings, usable as a `std::pmr` memory
+	 * resource, whose allocations are all discarded at once by reset().
+	 *
+	 * @remarks Each allocation is carved from the current block by advancing a pointer, and
+	 *          deallocation does nothing; memory is only reclaimed by reset(), which makes the
+	 *          arena suited to short-lived allocations with a common lifetime, such as those of a
+	 *          request. reset() keeps the blocks mapped for reuse (except those mapped for
+	 *          oversized allocations), so that an arena which is reset after each request stops
+	 *          making system calls once it has grown to its working size.
+	 *
+	 *          With huge pages requested, blocks are rounded up to the default huge page size and
+	 *          mapped with `MAP_HUGETLB`, falling back to ordinary pages advised with
+	 *          `MADV_HUGEPAGE` (so that transparent huge pages may be used) if no huge pages are
+	 *          reserved. Either way, large data structures allocated from the arena need far
+	 *          fewer TLB entries. With a NUMA node given, each block is bound to it with
+	 *          `mbind()` before its pages are first touched.
+	 *
+	 *          The arena is not thread-safe, and must outlive the containers which allocate from
+	 *          it; like `std::pmr::monotonic_buffer_resource`, it is neither copyable nor
+	 *          moveable.
+	 */
+	class arena : public std::pmr::memory_resource
+	{
+		public:
+
+			/**
+			 * Constructs an empty arena. No memory is mapped until the first allocation.
+			 *
+			 * @param block_size The size of each memory mapping from which allocations are
+			 *        carved, which is rounded up to a multiple of the page size (or, with huge
+			 *        pages, the huge page size). Larger allocations get a mapping of their own.
+			 * @param huge_pages Whether to back blocks with huge pages.
+			 * @param numa_node The NUMA node to bind blocks to, or -1 to use the default memory
+			 *        policy of the calling thread.
+			 */
+			explicit arena(std::size_t block_size = 2 << 20, bool huge_pages = true, int numa_node = -1);
+
+			arena(const arena&) = delete;
+			arena& operator=(const arena&) = delete;
+
+			/**
+			 * Discards all allocations, making the memory they used available for reuse. Blocks
+			 * of the configured size stay mapped; oversized blocks are unmapped.
+			 */
+			void reset() noexcept;
+
+			/**
+			 * Discards all allocations and unmaps all blocks.
+			 */
+			void release() noexcept;
+
+			/**
+			 * Gets the number of bytes allocated since the last reset, including alignment
+			 * padding.
+			 *
+			 * @return The number of bytes allocated.
+			 */
+			std::size_t allocated() const noexcept { return _allocated; }
+
+			/**
+			 * Gets the number of bytes mapped for blocks.
+			 *
+			 * @return The number of bytes mapped.
+			 */
+			std::size_t reserved() const noexcept { return _reserved; }
+
+			/**
+			 * Gets the size of each block.
+			 *
+			 * @return The block size, in bytes, after rounding.
+			 */
+			std::size_t block_size() const noexcept { return _block_size; }
+
+		private:
+
+			void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+			void do_deallocate(void *, std::size_t, std::size_t) noexcept override { }
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+			w::mmap_handle map_block(std::size_t length);
+
+			std::size_t _block_size;
+			bool _huge_pages;
+			int _numa_node;
+			std::vector<w::mmap_handle> _blocks;
+			std::vector<w::mmap_handle> _oversized;
+			std::size_t _current;
+			std::byte *_next;
+			std::byte *_end;
+			std::size_t _allocated;
+			std::size_t _reserved;
+	};
+}
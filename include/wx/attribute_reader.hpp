@@ -0,0 +1,117 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+
+#include <w/posix.hpp>
+#include <wx/string.hpp>
+
+#include <fcntl.h>
+#include <poll.h>
+
+namespace wx
+{
+	/**
+	 * Repeatedly reads a small sysfs or procfs attribute through a persistent file descriptor.
+	 *
+	 * @remarks The file is opened once, and each read is a single `pread()` at offset zero into
+	 *          an inline buffer, so sampling an attribute neither opens the file again nor
+	 *          allocates. Values are trimmed in the same way as by wx::slurp().
+	 *
+	 *          Attributes which signal updates (via `sysfs_notify()` in the kernel) can be
+	 *          waited on with wait_for_change(), or by registering fd() with an epoll instance
+	 *          (such as wx::event_loop) for `EPOLLPRI | EPOLLERR`. The attribute must have been
+	 *          read at least once before waiting, and must be read again after each
+	 *          notification to rearm it.
+	 *
+	 * @tparam Capacity The size of the inline buffer. Attribute values must be shorter than
+	 *         this.
+	 */
+	template <std::size_t Capacity = 128>
+	class attribute_reader
+	{
+		static_assert(Capacity > 0, "buffer capacity must be nonzero");
+
+		public:
+
+			/**
+			 * Opens an attribute.
+			 *
+			 * @param path The path of the attribute.
+			 * @throw std::system_error An error occurred.
+			 */
+			explicit attribute_reader(const char *path)
+				: _fd(w::open(path, O_RDONLY | O_CLOEXEC))
+			{
+			}
+
+			/**
+			 * Reads the current value of the attribute, with trailing whitespace removed.
+			 *
+			 * @return A view of the value, which remains valid until the next read.
+			 * @throw std::length_error The value does not fit in the buffer.
+			 * @throw std::system_error An error occurred.
+			 */
+			std::string_view read()
+			{
+				std::size_t n = w::pread(_fd, _buffer, Capacity, 0);
+
+				if (n == Capacity)
+					throw std::length_error("attribute value is too long for buffer");
+
+				std::string_view value = wx::rtrim(std::string_view(_buffer, n));
+				_buffer[value.size()] = '\0';
+				return value;
+			}
+
+			/**
+			 * Reads the current value of the attribute and parses it as a number, with the same
+			 * strict formatting and range checks as wx::number().
+			 *
+			 * @tparam T The numeric type to convert to.
+			 * @return The parsed value.
+			 * @throw std::length_error The value does not fit in the buffer.
+			 * @throw std::range_error The value is valid but the number is out of range.
+			 * @throw std::runtime_error The value is invalid.
+			 * @throw std::system_error An error occurred.
+			 */
+			template <typename T>
+			T read_as()
+			{
+				return wx::number<T>(read());
+			}
+
+			/**
+			 * Waits for the attribute to signal a change with `POLLPRI` or `POLLERR`.
+			 *
+			 * @param timeout The maximum time to wait, or a negative value to wait indefinitely.
+			 * @return `true` if the attribute changed, or `false` if the timeout elapsed.
+			 * @throw std::system_error An error occurred.
+			 */
+			bool wait_for_change(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1))
+			{
+				struct pollfd pfd { _fd, POLLPRI | POLLERR, 0 };
+				return w::poll(&pfd, 1, timeout) != 0;
+			}
+
+			/**
+			 * Gets the file descriptor of the attribute.
+			 *
+			 * @return The file descriptor.
+			 */
+			int fd() const noexcept { return _fd; }
+
+		private:
+
+			w::fd _fd;
+			char _buffer[Capacity + 1];
+	};
+}
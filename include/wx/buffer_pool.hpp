@@ -0,0 +1,238 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <w/posix.hpp>
+#include <wx/cache_line.hpp>
+
+namespace wx
+{
+	/**
+	 * A pool of fixed-size I/O buffers carved out of large anonymous memory mappings.
+	 *
+	 * @remarks Buffers are rounded up to a multiple of the cache line size, and are carved out
+	 *          of slabs mapped with w::mmap() as the pool grows; slabs are only unmapped when the
+	 *          pool is destroyed. Free buffers are kept on intrusive free lists in a set of
+	 *          shards, each on its own cache line, and each thread allocates from and frees to
+	 *          its own shard. When its shard is empty, a thread steals the whole free list of one
+	 *          other shard; if that shard is empty too, the pool grows by one buffer, and the
+	 *          thread tries the next shard on its following miss. A thread which allocates
+	 *          buffers freed by another (as when a worker hands them to the kernel and a
+	 *          completion thread returns them) therefore takes the other thread's lock once per
+	 *          batch of buffers, rather than every shard's lock per allocation. As long as there
+	 *          are no more threads than shards, a shard's lock is only ever contended by a
+	 *          thief.
+	 *
+	 *          With huge pages requested, slabs are mapped with `MAP_HUGETLB`, falling back to
+	 *          ordinary pages advised with `MADV_HUGEPAGE` (so that transparent huge pages may be
+	 *          used) if no huge pages are reserved.
+	 *
+	 *          All members are thread-safe. Leases must not outlive the pool.
+	 */
+	class buffer_pool
+	{
+		public:
+
+			/**
+			 * An RAII lease of a buffer, which returns the buffer to the pool when destroyed.
+			 */
+			class lease
+			{
+				public:
+
+					/**
+					 * Constructs an empty lease.
+					 */
+					lease() noexcept : _pool(nullptr), _data(nullptr) { }
+
+					/**
+					 * Takes ownership of a buffer.
+					 *
+					 * @param pool The pool which the buffer belongs to.
+					 * @param data A pointer to the buffer.
+					 */
+					lease(buffer_pool& pool, std::byte *data) noexcept : _pool(&pool), _data(data) { }
+
+					lease(const lease&) = delete;
+					lease& operator=(const lease&) = delete;
+
+					/**
+					 * Move-constructs a lease.
+					 *
+					 * @param other The lease to move from, which becomes empty.
+					 */
+					lease(lease&& other) noexcept
+						: _pool(other._pool),
+						  _data(std::exchange(other._data, nullptr))
+					{
+					}
+
+					/**
+					 * Move-assigns a lease, returning the buffer (if any) held by this lease.
+					 *
+					 * @param other The lease to move from, which becomes empty.
+					 * @return A reference to this lease.
+					 */
+					lease& operator=(lease&& other) noexcept
+					{
+						if (this != &other)
+						{
+							reset();
+							_pool = other._pool;
+							_data = std::exchange(other._data, nullptr);
+						}
+
+						return *this;
+					}
+
+					/**
+					 * Returns the buffer (if any) to the pool.
+					 */
+					~lease() { reset(); }
+
+					/**
+					 * Returns the buffer (if any) to the pool, leaving the lease empty.
+					 */
+					void reset() noexcept
+					{
+						if (_data)
+							_pool->release(std::exchange(_data, nullptr));
+					}
+
+					/**
+					 * Relinquishes ownership of the buffer without returning it to the pool. The
+					 * buffer must later be returned with buffer_pool::release().
+					 *
+					 * @return A pointer to the buffer, or `nullptr` if the lease is empty.
+					 */
+					std::byte *release() noexcept { return std::exchange(_data, nullptr); }
+
+					/**
+					 * Gets a pointer to the buffer.
+					 *
+					 * @return A pointer to the buffer, or `nullptr` if the lease is empty.
+					 */
+					std::byte *data() const noexcept { return _data; }
+
+					/**
+					 * Gets the size of the buffer.
+					 *
+					 * @return The size of the buffer in bytes, or zero if the lease is empty.
+					 */
+					std::size_t size() const noexcept { return _data ? _pool->buffer_size() : 0; }
+
+					/**
+					 * Gets the buffer as a span of bytes.
+					 *
+					 * @return A span covering the buffer.
+					 */
+					std::span<std::byte> bytes() const noexcept { return { _data, size() }; }
+
+					/**
+					 * Tests whether the lease holds a buffer.
+					 *
+					 * @return `true` if the lease holds a buffer.
+					 */
+					explicit operator bool() const noexcept { return _data != nullptr; }
+
+				private:
+
+					buffer_pool *_pool;
+					std::byte *_data;
+			};
+
+			/**
+			 * Constructs an empty pool.
+			 *
+			 * @param buffer_size The size of each buffer, which is rounded up to a multiple of
+			 *        the cache line size.
+			 * @param slab_size The size of each memory mapping from which buffers are carved,
+			 *        which is rounded up to a whole number of buffers (and, with huge pages, to a
+			 *        multiple of 2 MiB).
+			 * @param huge_pages Whether to back slabs with huge pages.
+			 * @throw std::invalid_argument @p buffer_size is zero.
+			 */
+			explicit buffer_pool(std::size_t buffer_size, std::size_t slab_size = 2 << 20,
+				bool huge_pages = false);
+
+			buffer_pool(const buffer_pool&) = delete;
+			buffer_pool& operator=(const buffer_pool&) = delete;
+
+			/**
+			 * Leases a buffer, growing the pool if no buffer is free.
+			 *
+			 * @return A lease of the buffer.
+			 * @throw std::system_error An error occurred mapping a new slab.
+			 */
+			lease acquire() { return { *this, allocate() }; }
+
+			/**
+			 * Takes a free buffer, growing the pool if no buffer is free. The buffer must later
+			 * be returned with release().
+			 *
+			 * @return A pointer to the buffer.
+			 * @throw std::system_error An error occurred mapping a new slab.
+			 */
+			std::byte *allocate();
+
+			/**
+			 * Returns a buffer to the pool.
+			 *
+			 * @param buffer A pointer to a buffer obtained from this pool.
+			 */
+			void release(std::byte *buffer) noexcept;
+
+			/**
+			 * Gets the size of each buffer.
+			 *
+			 * @return The buffer size in bytes.
+			 */
+			std::size_t buffer_size() const noexcept { return _buffer_size; }
+
+			/**
+			 * Gets the total number of buffers handed out so far, whether now free or leased.
+			 *
+			 * @return The number of buffers.
+			 */
+			std::size_t capacity() const noexcept { return _capacity.load(std::memory_order_relaxed); }
+
+		private:
+
+			struct free_buffer
+			{
+				free_buffer *next;
+			};
+
+			struct alignas(wx::cache_line_size) shard
+			{
+				std::mutex lock;
+				free_buffer *head = nullptr;
+			};
+
+			shard& local_shard() noexcept;
+			std::byte *take_free() noexcept;
+
+			std::size_t _buffer_size;
+			std::size_t _slab_size;
+			bool _huge_pages;
+			std::size_t _shard_mask;
+			std::unique_ptr<shard[]> _shards;
+			std::mutex _slabs_lock;
+			std::vector<w::mmap_handle> _slabs;
+			std::byte *_carve_next;
+			std::byte *_carve_end;
+			std::atomic<std::size_t> _capacity;
+	};
+}
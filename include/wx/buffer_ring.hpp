@@ -0,0 +1,147 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <w/io_uring.hpp>
+#include <w/posix.hpp>
+#include <wx/buffer_pool.hpp>
+
+#include <linux/io_uring.h>
+
+namespace wx
+{
+	/**
+	 * An io_uring provided-buffer ring stocked from a wx::buffer_pool.
+	 *
+	 * @remarks Receives prepared with prep_recv() (or any request passed to select()) do not
+	 *          name a buffer; the kernel takes one from the ring only once data arrives, so idle
+	 *          connections do not each pin a buffer. The buffer ID is reported in the completion
+	 *          queue entry, and take() hands the buffer over as a lease while restocking the ring
+	 *          with a fresh buffer from the pool, or recycle() puts it straight back into the
+	 *          ring if its data is no longer needed.
+	 *
+	 *          Like w::io_uring, an instance must not be used concurrently from multiple threads.
+	 *          Provided-buffer rings require Linux 5.19 or later.
+	 */
+	class buffer_ring
+	{
+		public:
+
+			/**
+			 * Creates a buffer ring, stocks it with buffers from a pool, and registers it.
+			 *
+			 * @param ring The io_uring instance, which must outlive this object.
+			 * @param pool The pool from which to take buffers, which must outlive this object.
+			 * @param entries The number of buffers in the ring, which must be a power of two no
+			 *        greater than 32768.
+			 * @param bgid The buffer group ID to register the ring as.
+			 * @throw std::invalid_argument @p entries is invalid, or the buffers of @p pool are
+			 *        too large.
+			 * @throw std::system_error An error occurred.
+			 */
+			buffer_ring(w::io_uring& ring, wx::buffer_pool& pool, unsigned entries, std::uint16_t bgid);
+
+			buffer_ring(const buffer_ring&) = delete;
+			buffer_ring& operator=(const buffer_ring&) = delete;
+
+			/**
+			 * Unregisters the ring and returns its buffers to the pool. Requests selecting
+			 * buffers from the ring must have completed.
+			 */
+			~buffer_ring();
+
+			/**
+			 * Marks a submission queue entry to take its buffer from the ring.
+			 *
+			 * @param sqe The submission queue entry to modify.
+			 */
+			void select(struct io_uring_sqe *sqe) const noexcept
+			{
+				sqe->flags |= IOSQE_BUFFER_SELECT;
+				sqe->buf_group = _bgid;
+			}
+
+			/**
+			 * Prepares a submission queue entry which receives a message on a socket into a
+			 * buffer taken from the ring.
+			 *
+			 * @param sqe The submission queue entry to prepare.
+			 * @param sockfd The socket to receive from.
+			 * @param flags A bitwise combination of flags.
+			 */
+			void prep_recv(struct io_uring_sqe *sqe, int sockfd, int flags = 0) const noexcept
+			{
+				w::prep_recv(sqe, sockfd, nullptr, static_cast<std::uint32_t>(_pool.buffer_size()), flags);
+				select(sqe);
+			}
+
+			/**
+			 * Takes the buffer reported by a completion queue entry out of the ring, replacing it
+			 * with a fresh buffer from the pool.
+			 *
+			 * @param cqe The completion queue entry of a request which selected a buffer from
+			 *        this ring.
+			 * @return A lease of the buffer, holding the `res` bytes of received data.
+			 * @throw std::invalid_argument @p cqe does not report a buffer from this ring.
+			 * @throw std::system_error An error occurred growing the pool.
+			 */
+			wx::buffer_pool::lease take(const struct io_uring_cqe& cqe);
+
+			/**
+			 * Returns the buffer reported by a completion queue entry to the ring.
+			 *
+			 * @param cqe The completion queue entry of a request which selected a buffer from
+			 *        this ring.
+			 * @throw std::invalid_argument @p cqe does not report a buffer from this ring.
+			 */
+			void recycle(const struct io_uring_cqe& cqe);
+
+			/**
+			 * Gets the buffer reported by a completion queue entry, without taking it out of
+			 * the ring.
+			 *
+			 * @param cqe The completion queue entry of a request which selected a buffer from
+			 *        this ring.
+			 * @return A pointer to the buffer.
+			 * @throw std::invalid_argument @p cqe does not report a buffer from this ring.
+			 */
+			std::byte *buffer(const struct io_uring_cqe& cqe) const { return _buffers[buffer_id(cqe)]; }
+
+			/**
+			 * Gets the buffer group ID of the ring.
+			 *
+			 * @return The buffer group ID.
+			 */
+			std::uint16_t group() const noexcept { return _bgid; }
+
+			/**
+			 * Gets the number of buffers in the ring.
+			 *
+			 * @return The number of entries.
+			 */
+			unsigned size() const noexcept { return _mask + 1; }
+
+		private:
+
+			std::uint16_t buffer_id(const struct io_uring_cqe& cqe) const;
+			void provide(std::uint16_t bid) noexcept;
+			void publish() noexcept;
+
+			w::io_uring& _ring;
+			wx::buffer_pool& _pool;
+			w::mmap_handle _memory;
+			struct io_uring_buf_ring *_br;
+			unsigned _mask;
+			std::uint16_t _bgid;
+			std::uint16_t _tail;
+			std::vector<std::byte *> _buffers;
+	};
+}
@@ -0,0 +1,22 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+
+namespace wx
+{
+	/**
+	 * The assumed size of a cache line, used to pad data written by different threads so that
+	 * it does not share a cache line.
+	 *
+	 * @remarks `std::hardware_destructive_interference_size` is deliberately not used, since its
+	 *          value may differ between compiler versions and flags, which makes it unsuitable for
+	 *          the layout of types in public headers (GCC warns about exactly this).
+	 */
+	inline constexpr std::size_t cache_line_size = 64;
+}
@@ -0,0 +1,294 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+#include <w/sockets.hpp>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+
+namespace wx
+{
+	/**
+	 * The buffer space needed for one control message of each of the given payload types, for
+	 * sizing a wx::cmsg_buffer.
+	 *
+	 * @tparam T The payload types.
+	 */
+	template <typename... T>
+	inline constexpr std::size_t cmsg_space = (CMSG_SPACE(sizeof(T)) + ... + 0);
+
+	/**
+	 * A fixed-capacity buffer of control messages (ancillary data) for w::sendmsg() and
+	 * w::recvmsg().
+	 *
+	 * @remarks To send, add control messages and then attach() the buffer to a message header;
+	 *          each add function lays out one message with the `CMSG_*` macros. To receive,
+	 *          prepare() a message header with the buffer, and after the receive walk the control
+	 *          messages with w::control_messages(), decoding them with the functions in the
+	 *          wx::cmsg namespace.
+	 *
+	 *          Typical uses are UDP generic segmentation offload, where add_udp_segment() lets a
+	 *          single send of up to 64 KiB be split into datagrams of the given size; UDP generic
+	 *          receive offload, where a socket with the `UDP_GRO` option set receives coalesced
+	 *          datagrams, and wx::cmsg::gro_segment_size() gives the size they were split at;
+	 *          and `SO_TIMESTAMPING` kernel timestamps, requested per send with
+	 *          add_timestamping() and read with wx::cmsg::timestamping().
+	 *
+	 * @tparam Capacity The size of the buffer, in bytes; see wx::cmsg_space.
+	 */
+	template <std::size_t Capacity>
+	class cmsg_buffer
+	{
+		static_assert(Capacity >= CMSG_SPACE(0), "control message buffer is too small");
+
+		public:
+
+			/**
+			 * Constructs an empty buffer.
+			 */
+			cmsg_buffer() noexcept : _size(0) { }
+
+			/**
+			 * Appends a control message with a zeroed payload, to be filled in by the caller.
+			 *
+			 * @param level The originating protocol (e.g. `SOL_SOCKET`).
+			 * @param type The protocol-specific type (e.g. `SCM_RIGHTS`).
+			 * @param len The size of the payload, in bytes.
+			 * @return A pointer to the payload.
+			 * @throw std::length_error The buffer does not have room for the message.
+			 */
+			void *reserve(int level, int type, std::size_t len)
+			{
+				if (CMSG_SPACE(len) > Capacity - _size)
+					throw std::length_error("control message buffer is full");
+
+				auto cmsg = reinterpret_cast<struct cmsghdr *>(_data + _size);
+				std::memset(cmsg, 0, CMSG_SPACE(len));
+				cmsg->cmsg_level = level;
+				cmsg->cmsg_type = type;
+				cmsg->cmsg_len = CMSG_LEN(len);
+				_size += CMSG_SPACE(len);
+
+				return CMSG_DATA(cmsg);
+			}
+
+			/**
+			 * Appends a control message.
+			 *
+			 * @tparam T The type of the payload.
+			 * @param level The originating protocol (e.g. `SOL_SOCKET`).
+			 * @param type The protocol-specific type (e.g. `SCM_RIGHTS`).
+			 * @param value The payload.
+			 * @throw std::length_error The buffer does not have room for the message.
+			 */
+			template <typename T>
+			void add(int level, int type, const T& value)
+			{
+				std::memcpy(reserve(level, type, sizeof(T)), &value, sizeof(T));
+			}
+
+			/**
+			 * Appends a `UDP_SEGMENT` control message, which has the data of a send split into
+			 * datagrams of the given size (the last of which may be shorter).
+			 *
+			 * @param segment_size The size of each datagram's payload.
+			 * @throw std::length_error The buffer does not have room for the message.
+			 */
+			void add_udp_segment(std::uint16_t segment_size) { add(SOL_UDP, UDP_SEGMENT, segment_size); }
+
+			/**
+			 * Appends an `SO_TIMESTAMPING` control message, which requests timestamps for a
+			 * send. The timestamps are reported on the socket error queue.
+			 *
+			 * @param flags A bitwise combination of `SOF_TIMESTAMPING_TX_*` flags.
+			 * @throw std::length_error The buffer does not have room for the message.
+			 */
+			void add_timestamping(std::uint32_t flags) { add(SOL_SOCKET, SO_TIMESTAMPING, flags); }
+
+			/**
+			 * Appends an `IP_PKTINFO` control message, which selects the source address and
+			 * outgoing interface of an IPv4 send.
+			 *
+			 * @param info The packet information.
+			 * @throw std::length_error The buffer does not have room for the message.
+			 */
+			void add_pktinfo(const struct in_pktinfo& info) { add(IPPROTO_IP, IP_PKTINFO, info); }
+
+			/**
+			 * Appends an `IPV6_PKTINFO` control message, which selects the source address and
+			 * outgoing interface of an IPv6 send.
+			 *
+			 * @param info The packet information.
+			 * @throw std::length_error The buffer does not have room for the message.
+			 */
+			void add_pktinfo(const struct in6_pktinfo& info) { add(IPPROTO_IPV6, IPV6_PKTINFO, info); }
+
+			/**
+			 * Appends an `SCM_RIGHTS` control message, which passes file descriptors over a
+			 * Unix domain socket.
+			 *
+			 * @param fds The file descriptors to pass.
+			 * @throw std::length_error The buffer does not have room for the message.
+			 */
+			void add_rights(std::span<const int> fds)
+			{
+				std::memcpy(reserve(SOL_SOCKET, SCM_RIGHTS, fds.size_bytes()), fds.data(), fds.size_bytes());
+			}
+
+			/**
+			 * Attaches the control messages added so far to a message header to be sent.
+			 *
+			 * @param msg The message header.
+			 */
+			void attach(struct msghdr& msg) noexcept
+			{
+				msg.msg_control = _size ? _data : nullptr;
+				msg.msg_controllen = _size;
+			}
+
+			/**
+			 * Discards any control messages, and attaches the whole buffer to a message header to
+			 * be received into.
+			 *
+			 * @param msg The message header.
+			 */
+			void prepare(struct msghdr& msg) noexcept
+			{
+				_size = 0;
+				msg.msg_control = _data;
+				msg.msg_controllen = Capacity;
+			}
+
+			/**
+			 * Discards any control messages.
+			 */
+			void clear() noexcept { _size = 0; }
+
+			/**
+			 * Gets the number of bytes of control messages added so far.
+			 *
+			 * @return The size of the control messages, in bytes.
+			 */
+			std::size_t size() const noexcept { return _size; }
+
+			/**
+			 * Gets the capacity of the buffer.
+			 *
+			 * @return The capacity, in bytes.
+			 */
+			static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+		private:
+
+			alignas(struct cmsghdr) unsigned char _data[Capacity];
+			std::size_t _size;
+	};
+
+	/**
+	 * Functions for decoding received control messages.
+	 */
+	namespace cmsg
+	{
+		/**
+		 * Copies out the payload of a control message of the given level and type.
+		 *
+		 * @tparam T The type of the payload.
+		 * @param cmsg The control message.
+		 * @param level The expected originating protocol.
+		 * @param type The expected protocol-specific type.
+		 * @return The payload, or `std::nullopt` if @p cmsg is of a different level or type,
+		 *         or too short.
+		 */
+		template <typename T>
+		std::optional<T> value(const struct cmsghdr& cmsg, int level, int type) noexcept
+		{
+			if (cmsg.cmsg_level != level || cmsg.cmsg_type != type || cmsg.cmsg_len < CMSG_LEN(sizeof(T)))
+				return std::nullopt;
+
+			T result;
+			std::memcpy(&result, CMSG_DATA(&cmsg), sizeof(T));
+			return result;
+		}
+
+		/**
+		 * Decodes a `UDP_GRO` control message, which accompanies a coalesced datagram received
+		 * on a socket with the `UDP_GRO` option set.
+		 *
+		 * @param cmsg The control message.
+		 * @return The size of the original datagrams (the last of which may be shorter), or
+		 *         `std::nullopt` if @p cmsg is not a `UDP_GRO` message.
+		 */
+		inline std::optional<int> gro_segment_size(const struct cmsghdr& cmsg) noexcept
+		{
+			return value<int>(cmsg, SOL_UDP, UDP_GRO);
+		}
+
+		/**
+		 * Decodes an `SO_TIMESTAMPING` control message.
+		 *
+		 * @param cmsg The control message.
+		 * @return The software, (deprecated) and hardware timestamps, any of which is zero if
+		 *         not generated, or `std::nullopt` if @p cmsg is not an `SO_TIMESTAMPING` message.
+		 */
+		inline std::optional<struct scm_timestamping> timestamping(const struct cmsghdr& cmsg) noexcept
+		{
+			return value<struct scm_timestamping>(cmsg, SOL_SOCKET, SCM_TIMESTAMPING);
+		}
+
+		/**
+		 * Decodes an `IP_PKTINFO` control message, which accompanies datagrams received on a
+		 * socket with the `IP_PKTINFO` option set.
+		 *
+		 * @param cmsg The control message.
+		 * @return The packet information, or `std::nullopt` if @p cmsg is not an `IP_PKTINFO`
+		 *         message.
+		 */
+		inline std::optional<struct in_pktinfo> ipv4_pktinfo(const struct cmsghdr& cmsg) noexcept
+		{
+			return value<struct in_pktinfo>(cmsg, IPPROTO_IP, IP_PKTINFO);
+		}
+
+		/**
+		 * Decodes an `IPV6_PKTINFO` control message, which accompanies datagrams received on a
+		 * socket with the `IPV6_RECVPKTINFO` option set.
+		 *
+		 * @param cmsg The control message.
+		 * @return The packet information, or `std::nullopt` if @p cmsg is not an `IPV6_PKTINFO`
+		 *         message.
+		 */
+		inline std::optional<struct in6_pktinfo> ipv6_pktinfo(const struct cmsghdr& cmsg) noexcept
+		{
+			return value<struct in6_pktinfo>(cmsg, IPPROTO_IPV6, IPV6_PKTINFO);
+		}
+
+		/**
+		 * Decodes an `SCM_RIGHTS` control message. The received file descriptors are owned by
+		 * the caller, which must close them.
+		 *
+		 * @param cmsg The control message.
+		 * @return The file descriptors, which is empty if @p cmsg is not an `SCM_RIGHTS`
+		 *         message.
+		 */
+		inline std::span<const int> rights(const struct cmsghdr& cmsg) noexcept
+		{
+			if (cmsg.cmsg_level != SOL_SOCKET || cmsg.cmsg_type != SCM_RIGHTS)
+				return { };
+
+			return { reinterpret_cast<const int *>(CMSG_DATA(&cmsg)), (cmsg.cmsg_len - CMSG_LEN(0)) / sizeof(int) };
+		}
+	}
+}
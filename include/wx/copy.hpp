@@ -0,0 +1,38 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace wx
+{
+	/**
+	 * Copies data from one file descriptor to another, using the fastest method the kernel
+	 * supports for the pair.
+	 *
+	 * @remarks The methods tried are, in order: `copy_file_range()` (between regular files,
+	 *          possibly sharing extents on filesystems which support it), `sendfile()` (from a
+	 *          regular file to anything, such as a socket), `splice()` (directly if either file
+	 *          descriptor is a pipe, or otherwise through an internal staging pipe) and finally a
+	 *          `read()`/`write()` loop. A method is abandoned in favor of the next one only if it
+	 *          fails before copying anything with an error indicating that it is unsupported for
+	 *          the pair of file descriptors.
+	 *
+	 *          The current file offsets of both file descriptors are used and advanced. This
+	 *          function is intended for blocking file descriptors.
+	 *
+	 * @param in The file descriptor to copy from.
+	 * @param out The file descriptor to copy to.
+	 * @param len The maximum number of bytes to copy. By default, data is copied until the end of
+	 *        the input.
+	 * @return The number of bytes actually copied, which is less than @p len only if the end
+	 *         of the input was reached.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t copy_fd(int in, int out, std::size_t len = std::numeric_limits<std::size_t>::max());
+}
@@ -0,0 +1,439 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <w/posix.hpp>
+#include <w/sockets.hpp>
+#include <wx/event_loop.hpp>
+
+#include <sys/socket.h>
+
+namespace wx
+{
+	template <typename T>
+	class task;
+
+	/// @cond
+	namespace detail
+	{
+		/**
+		 * Allocates memory for a coroutine frame from a per-thread pool.
+		 *
+		 * @param size The size of the frame.
+		 * @return A pointer to the memory.
+		 * @throw std::bad_alloc Memory could not be allocated.
+		 */
+		void *allocate_frame(std::size_t size);
+
+		/**
+		 * Returns memory for a coroutine frame to the pool of the calling thread.
+		 *
+		 * @param ptr A pointer returned by allocate_frame().
+		 * @param size The size passed to allocate_frame().
+		 */
+		void deallocate_frame(void *ptr, std::size_t size) noexcept;
+
+		struct frame_allocated
+		{
+			static void *operator new(std::size_t size) { return allocate_frame(size); }
+			static void operator delete(void *ptr, std::size_t size) noexcept { deallocate_frame(ptr, size); }
+		};
+
+		struct promise_base : frame_allocated
+		{
+			struct final_awaiter
+			{
+				bool await_ready() noexcept { return false; }
+
+				template <typename Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+				{
+					std::coroutine_handle<> continuation = h.promise().continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+
+				void await_resume() noexcept { }
+			};
+
+			std::suspend_always initial_suspend() noexcept { return { }; }
+			final_awaiter final_suspend() noexcept { return { }; }
+			void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+			std::coroutine_handle<> continuation;
+			std::exception_ptr exception;
+		};
+
+		template <typename T>
+		struct promise : promise_base
+		{
+			task<T> get_return_object() noexcept;
+
+			template <typename U>
+			void return_value(U&& value) { result.emplace(std::forward<U>(value)); }
+
+			T get()
+			{
+				if (exception)
+					std::rethrow_exception(exception);
+
+				return std::move(*result);
+			}
+
+			std::optional<T> result;
+		};
+
+		template <>
+		struct promise<void> : promise_base
+		{
+			task<void> get_return_object() noexcept;
+
+			void return_void() noexcept { }
+
+			void get()
+			{
+				if (exception)
+					std::rethrow_exception(exception);
+			}
+		};
+	}
+	/// @endcond
+
+	/**
+	 * A lazily-started coroutine producing a value of type @p T, which runs when it is awaited
+	 * and resumes its awaiter when it completes.
+	 *
+	 * @remarks Coroutine frames are allocated from a per-thread pool of size classes, so that
+	 *          frames of short-lived coroutines (such as the operations of wx::async_fd) are
+	 *          recycled rather than returned to the heap. Completion resumes the awaiter by
+	 *          symmetric transfer, so chains of tasks which complete synchronously do not grow
+	 *          the stack.
+	 *
+	 * @tparam T The type of the result, or `void`.
+	 */
+	template <typename T = void>
+	class task
+	{
+		public:
+
+			/**
+			 * The promise type of the coroutine.
+			 */
+			typedef detail::promise<T> promise_type;
+
+			task(const task&) = delete;
+			task& operator=(const task&) = delete;
+
+			/**
+			 * Move-constructs a task.
+			 *
+			 * @param other The task to move from, which becomes empty.
+			 */
+			task(task&& other) noexcept : _handle(std::exchange(other._handle, { })) { }
+
+			/**
+			 * Move-assigns a task, destroying the coroutine (if any) owned by this task.
+			 *
+			 * @param other The task to move from, which becomes empty.
+			 * @return A reference to this task.
+			 */
+			task& operator=(task&& other) noexcept
+			{
+				if (this != &other)
+				{
+					if (_handle)
+						_handle.destroy();
+
+					_handle = std::exchange(other._handle, { });
+				}
+
+				return *this;
+			}
+
+			/**
+			 * Destroys the coroutine (if any) owned by this task.
+			 */
+			~task()
+			{
+				if (_handle)
+					_handle.destroy();
+			}
+
+			/// @cond
+			bool await_ready() const noexcept { return false; }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+			{
+				_handle.promise().continuation = awaiter;
+				return _handle;
+			}
+
+			T await_resume() { return _handle.promise().get(); }
+			/// @endcond
+
+		private:
+
+			friend promise_type;
+
+			explicit task(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) { }
+
+			std::coroutine_handle<promise_type> _handle;
+	};
+
+	/// @cond
+	namespace detail
+	{
+		template <typename T>
+		task<T> promise<T>::get_return_object() noexcept
+		{
+			return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+		}
+
+		inline task<void> promise<void>::get_return_object() noexcept
+		{
+			return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+		}
+
+		struct detached
+		{
+			struct promise_type : frame_allocated
+			{
+				detached get_return_object() noexcept { return { }; }
+				std::suspend_never initial_suspend() noexcept { return { }; }
+				std::suspend_never final_suspend() noexcept { return { }; }
+				void return_void() noexcept { }
+				void unhandled_exception() noexcept { std::terminate(); }
+			};
+		};
+
+		inline detached run_detached(task<void> t)
+		{
+			co_await t;
+		}
+	}
+	/// @endcond
+
+	/**
+	 * Starts a task without awaiting it. The task runs on the calling thread until it first
+	 * suspends, and its frame is destroyed when it completes.
+	 *
+	 * @remarks As with `std::thread`, an exception escaping the task calls `std::terminate()`.
+	 *
+	 * @param t The task to start.
+	 */
+	inline void spawn(task<void> t)
+	{
+		detail::run_detached(std::move(t));
+	}
+
+	/**
+	 * A non-blocking file descriptor registered with an event loop, whose operations are
+	 * coroutines which suspend only when the operation would block.
+	 *
+	 * @remarks The file descriptor is registered once, edge-triggered, for both input and output.
+	 *          Each operation is first attempted immediately, and only if it fails with `EAGAIN`
+	 *          does the calling coroutine suspend until the event loop reports readiness. At most
+	 *          one coroutine may wait for input and one for output at any time. All operations
+	 *          must be awaited on the thread running the event loop, and the object must outlive
+	 *          any suspended operation.
+	 */
+	class async_fd
+	{
+		public:
+
+			/**
+			 * An awaitable which suspends until the file descriptor reports input readiness
+			 * (or an error or hangup).
+			 */
+			struct readable_awaiter
+			{
+				/// @cond
+				bool await_ready() const noexcept { return false; }
+				void await_suspend(std::coroutine_handle<> h) noexcept { owner->_reader = h; }
+				void await_resume() const noexcept { }
+
+				async_fd *owner;
+				/// @endcond
+			};
+
+			/**
+			 * An awaitable which suspends until the file descriptor reports output readiness
+			 * (or an error or hangup).
+			 */
+			struct writable_awaiter
+			{
+				/// @cond
+				bool await_ready() const noexcept { return false; }
+				void await_suspend(std::coroutine_handle<> h) noexcept { owner->_writer = h; }
+				void await_resume() const noexcept { }
+
+				async_fd *owner;
+				/// @endcond
+			};
+
+			/**
+			 * Registers a file descriptor with an event loop.
+			 *
+			 * @param loop The event loop, which must outlive this object.
+			 * @param fd The file descriptor, which must be non-blocking. Ownership is transferred
+			 *        to this object.
+			 * @throw std::system_error An error occurred.
+			 */
+			async_fd(wx::event_loop& loop, w::fd fd);
+
+			async_fd(const async_fd&) = delete;
+			async_fd& operator=(const async_fd&) = delete;
+
+			/**
+			 * Removes the file descriptor from the event loop and closes it.
+			 */
+			~async_fd();
+
+			/**
+			 * Suspends until the file descriptor reports input readiness.
+			 *
+			 * @return An awaitable.
+			 */
+			readable_awaiter readable() noexcept { return { this }; }
+
+			/**
+			 * Suspends until the file descriptor reports output readiness.
+			 *
+			 * @return An awaitable.
+			 */
+			writable_awaiter writable() noexcept { return { this }; }
+
+			/**
+			 * Reads data from the file descriptor.
+			 *
+			 * @param buf A pointer to an array where read data should be stored.
+			 * @param count The maximum number of bytes to read.
+			 * @return The number of bytes actually read, which is zero at the end of the file.
+			 * @throw std::system_error An error occurred.
+			 */
+			task<std::size_t> read(void *buf, std::size_t count);
+
+			/**
+			 * Writes data to the file descriptor.
+			 *
+			 * @param buf A pointer to the data to write.
+			 * @param count The number of bytes to write.
+			 * @return The number of bytes actually written, which may be less than @p count.
+			 * @throw std::system_error An error occurred.
+			 */
+			task<std::size_t> write(const void *buf, std::size_t count);
+
+			/**
+			 * Receives data from the socket.
+			 *
+			 * @param buf A pointer to an array where received data should be stored.
+			 * @param len The maximum number of bytes to receive.
+			 * @param flags A bitwise combination of flags.
+			 * @return The number of bytes actually received, which is zero if the peer has shut
+			 *         down the connection.
+			 * @throw std::system_error An error occurred.
+			 */
+			task<std::size_t> recv(void *buf, std::size_t len, int flags = 0);
+
+			/**
+			 * Sends data on the socket.
+			 *
+			 * @param buf A pointer to the data to send.
+			 * @param len The number of bytes to send.
+			 * @param flags A bitwise combination of flags.
+			 * @return The number of bytes actually sent, which may be less than @p len.
+			 * @throw std::system_error An error occurred.
+			 */
+			task<std::size_t> send(const void *buf, std::size_t len, int flags = 0);
+
+			/**
+			 * Accepts a connection on the socket. The new socket is non-blocking and
+			 * close-on-exec, ready to be wrapped in another async_fd.
+			 *
+			 * @tparam Address The type of @p addr.
+			 * @param addr A reference to the address of the remote endpoint.
+			 * @return The socket file descriptor of the new connection.
+			 * @throw std::system_error An error occurred.
+			 * @throw std::runtime_error The structure referenced by @p addr is not the correct
+			 *        size to hold the remote address.
+			 */
+			template <typename Address>
+			task<w::fd> accept(Address& addr)
+			{
+				for (;;)
+				{
+					std::error_code ec;
+					socklen_t addrlen = sizeof(addr);
+					w::fd fd = w::accept4(_fd, reinterpret_cast<struct sockaddr *>(&addr), &addrlen,
+						SOCK_NONBLOCK | SOCK_CLOEXEC, ec);
+
+					// Connections reset while still in the accept queue are reported as
+					// ECONNABORTED, and merely need skipping.
+
+					if (!ec)
+					{
+						if (addrlen != sizeof(addr))
+							throw std::runtime_error(
+								"provided structure is not the correct size to hold receive connect address");
+
+						co_return std::move(fd);
+					}
+					else if (w::would_block(ec))
+						co_await readable();
+					else if (ec != std::errc::connection_aborted)
+						throw std::system_error(ec, "failed to accept connection on socket");
+				}
+			}
+
+			/**
+			 * Connects the socket to an address.
+			 *
+			 * @tparam Address The type of @p addr.
+			 * @param addr A reference to the address to connect to.
+			 * @throw std::system_error An error occurred.
+			 */
+			template <typename Address>
+			task<void> connect(const Address& addr)
+			{
+				std::error_code ec;
+				w::connect(_fd, addr, ec);
+
+				if (ec == std::errc::operation_in_progress)
+				{
+					co_await writable();
+					finish_connect();
+				}
+				else if (ec)
+					throw std::system_error(ec, "failed to connect socket");
+			}
+
+			/**
+			 * Gets the file descriptor.
+			 *
+			 * @return The file descriptor.
+			 */
+			int fd() const noexcept { return _fd; }
+
+		private:
+
+			void on_events(std::uint32_t events);
+			void finish_connect();
+
+			wx::event_loop& _loop;
+			w::fd _fd;
+			std::coroutine_handle<> _reader;
+			std::coroutine_handle<> _writer;
+	};
+}
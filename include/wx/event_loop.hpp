@@ -0,0 +1,199 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+
+#include <sys/epoll.h>
+#include <time.h>
+
+namespace wx
+{
+	/**
+	 * A single-threaded reactor which dispatches readiness events from an epoll instance to
+	 * per-file-descriptor callbacks.
+	 *
+	 * @remarks Each call to run_once() performs a single `epoll_wait()` and dispatches the whole
+	 *          batch of events it returns, using a preallocated event array. The interest set of
+	 *          every registered file descriptor is cached, so modify() only calls `epoll_ctl()`
+	 *          if the interest set actually changes. Callbacks may freely add, modify and remove
+	 *          registrations (including their own) while a batch is being dispatched; events
+	 *          still pending in the batch for a removed file descriptor are discarded.
+	 *
+	 *          All members except wake() and stop() must be called from the thread running the
+	 *          loop.
+	 */
+	class event_loop
+	{
+		public:
+
+			/**
+			 * The type of a callback invoked when a registered file descriptor becomes ready.
+			 * The argument is the bitwise combination of events which occurred.
+			 */
+			typedef std::function<void(std::uint32_t events)> callback;
+
+			/**
+			 * The type of a callback invoked when a timer expires. The argument is the number of
+			 * expirations which occurred since the callback was last invoked.
+			 */
+			typedef std::function<void(std::uint64_t expirations)> timer_callback;
+
+			/**
+			 * Constructs an event loop.
+			 *
+			 * @param max_events The maximum number of events to dispatch per call to
+			 *        run_once().
+			 * @throw std::system_error An error occurred creating the epoll instance or the
+			 *        wakeup event file descriptor.
+			 */
+			explicit event_loop(std::size_t max_events = 64);
+
+			event_loop(const event_loop&) = delete;
+			event_loop& operator=(const event_loop&) = delete;
+
+			/**
+			 * Registers a file descriptor with the loop.
+			 *
+			 * @param fd The file descriptor to register. The caller retains ownership, and must
+			 *        remove() the file descriptor before closing it.
+			 * @param events A bitwise combination of events of interest (e.g. `EPOLLIN`).
+			 * @param cb The callback to invoke when any of @p events occur.
+			 * @throw std::invalid_argument @p fd is already registered.
+			 * @throw std::system_error An error occurred.
+			 */
+			void add(int fd, std::uint32_t events, callback cb);
+
+			/**
+			 * Changes the events of interest for a registered file descriptor. No system call
+			 * is made if @p events is the same as the current interest set.
+			 *
+			 * @param fd The registered file descriptor.
+			 * @param events A bitwise combination of events of interest.
+			 * @throw std::invalid_argument @p fd is not registered.
+			 * @throw std::system_error An error occurred.
+			 */
+			void modify(int fd, std::uint32_t events);
+
+			/**
+			 * Removes a file descriptor or timer from the loop. Removing a timer also closes its
+			 * timer file descriptor.
+			 *
+			 * @param fd The registered file descriptor, or a timer identifier returned by
+			 *        add_timer().
+			 * @throw std::invalid_argument @p fd is not registered.
+			 * @throw std::system_error An error occurred.
+			 */
+			void remove(int fd);
+
+			/**
+			 * Tests whether a file descriptor is registered with the loop.
+			 *
+			 * @param fd The file descriptor to test.
+			 * @return `true` if @p fd is registered.
+			 */
+			bool contains(int fd) const noexcept;
+
+			/**
+			 * Gets the events of interest for a registered file descriptor.
+			 *
+			 * @param fd The registered file descriptor.
+			 * @return The bitwise combination of events of interest.
+			 * @throw std::invalid_argument @p fd is not registered.
+			 */
+			std::uint32_t events(int fd) const;
+
+			/**
+			 * Creates a timer file descriptor owned by the loop and registers it.
+			 *
+			 * @param initial The time until the first expiration. This must be nonzero.
+			 * @param interval The repetition interval, or zero for a one-shot timer.
+			 * @param cb The callback to invoke when the timer expires.
+			 * @param clockid The identifier of the clock on which the timer should be based.
+			 * @return An identifier for the timer (which is its file descriptor), to be passed
+			 *         to remove().
+			 * @throw std::system_error An error occurred.
+			 */
+			int add_timer(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval,
+				timer_callback cb, int clockid = CLOCK_MONOTONIC);
+
+			/**
+			 * Interrupts a concurrent or subsequent call to run_once(). Multiple calls made
+			 * before the loop wakes up are coalesced into a single `eventfd` write. This function
+			 * may be called from any thread.
+			 *
+			 * @throw std::system_error An error occurred.
+			 */
+			void wake();
+
+			/**
+			 * Causes run() to return after dispatching the current batch of events. This
+			 * function may be called from any thread.
+			 *
+			 * @throw std::system_error An error occurred.
+			 */
+			void stop();
+
+			/**
+			 * Waits for events and dispatches a single batch of them.
+			 *
+			 * @param timeout The maximum time to wait, or a negative value to wait indefinitely.
+			 * @return The number of events dispatched, which may be zero. Wakeups (see wake())
+			 *         are not counted.
+			 * @throw std::system_error An error occurred.
+			 * @throw ... Any exception thrown by a callback is propagated, and the remaining
+			 *        events in the batch are discarded.
+			 */
+			std::size_t run_once(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+			/**
+			 * Dispatches events until stop() is called.
+			 *
+			 * @throw std::system_error An error occurred.
+			 * @throw ... Any exception thrown by a callback is propagated.
+			 */
+			void run();
+
+			/**
+			 * Gets the file descriptor of the underlying epoll instance.
+			 *
+			 * @return The epoll instance file descriptor.
+			 */
+			int fd() const noexcept { return _epoll; }
+
+		private:
+
+			struct registration
+			{
+				int fd;
+				std::uint32_t events;
+				bool active;
+				callback cb;
+				w::fd owned;
+			};
+
+			registration& find(int fd) const;
+
+			w::fd _epoll;
+			w::fd _wakeup;
+			std::atomic<bool> _wake_pending;
+			std::atomic<bool> _stopped;
+			std::vector<struct epoll_event> _events;
+			std::unordered_map<int, std::unique_ptr<registration>> _registrations;
+			std::vector<std::unique_ptr<registration>> _retired;
+	};
+}
@@ -0,0 +1,225 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <wx/coroutine.hpp>
+#include <wx/event_loop.hpp>
+
+namespace wx
+{
+	/**
+	 * A thread-per-core executor, which runs one worker thread pinned to each CPU, each with its
+	 * own event loop, and balances coroutines between them by work stealing.
+	 *
+	 * @remarks Each worker owns a wx::event_loop (and so its own epoll instance), a wx::mailbox
+	 *          through which other threads hand it work, and a Chase-Lev deque of runnable
+	 *          coroutines. A coroutine which awaits schedule() on a worker is pushed onto that
+	 *          worker's deque, from which the worker pops in LIFO order and idle workers steal in
+	 *          FIFO order. Between batches of coroutines, each worker polls its event loop without
+	 *          blocking, and it only blocks in the event loop once there is nothing to run or
+	 *          steal anywhere. Idle workers are only woken (through the event loop) when work is
+	 *          pushed while some worker is asleep, so busy workers make no system calls to
+	 *          balance load.
+	 *
+	 *          Work which must run on a particular worker, such as anything using its event loop,
+	 *          is never stolen: use post() or schedule_on(). A typical server accepts a connection,
+	 *          finds its worker with worker_for(), awaits schedule_on() and only then wraps the
+	 *          socket in a wx::async_fd on that worker's loop(). Coroutines using a wx::async_fd
+	 *          must not await schedule(), since they could then be resumed on another worker.
+	 *
+	 *          Callables and coroutines still queued when the executor stops are neither run nor
+	 *          destroyed. An exception escaping a posted callable or a spawned task calls
+	 *          `std::terminate()`.
+	 */
+	class executor
+	{
+		public:
+
+			/**
+			 * The index returned by current_worker() on a thread which is not a worker of the
+			 * executor.
+			 */
+			static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+			/**
+			 * An awaitable which reschedules the awaiting coroutine on the executor.
+			 */
+			struct schedule_awaiter
+			{
+				/// @cond
+				bool await_ready() const noexcept { return false; }
+				void await_suspend(std::coroutine_handle<> h) { owner->enqueue(h); }
+				void await_resume() const noexcept { }
+
+				executor *owner;
+				/// @endcond
+			};
+
+			/**
+			 * An awaitable which resumes the awaiting coroutine on a particular worker.
+			 */
+			struct schedule_on_awaiter
+			{
+				/// @cond
+				bool await_ready() const noexcept { return owner->current_worker() == worker; }
+				void await_suspend(std::coroutine_handle<> h) { owner->post(worker, [h] { h.resume(); }); }
+				void await_resume() const noexcept { }
+
+				executor *owner;
+				std::size_t worker;
+				/// @endcond
+			};
+
+			/**
+			 * Starts the worker threads.
+			 *
+			 * @param threads The number of workers, or zero for one per CPU on which the calling
+			 *        thread is allowed to run. Worker @e i is pinned to the @e i th such CPU
+			 *        (wrapping around if there are more workers than CPUs).
+			 * @param mailbox_capacity The capacity of the mailbox of each worker.
+			 * @throw std::system_error An error occurred creating or pinning the workers.
+			 */
+			explicit executor(std::size_t threads = 0, std::size_t mailbox_capacity = 1024);
+
+			executor(const executor&) = delete;
+			executor& operator=(const executor&) = delete;
+
+			/**
+			 * Stops the workers and waits for them to exit.
+			 */
+			~executor();
+
+			/**
+			 * Suspends the awaiting coroutine and makes it runnable on the executor. On a worker,
+			 * the coroutine goes onto that worker's deque, where it may be stolen; elsewhere, it
+			 * is handed to the workers in turn.
+			 *
+			 * @return An awaitable.
+			 */
+			schedule_awaiter schedule() noexcept { return { this }; }
+
+			/**
+			 * Resumes the awaiting coroutine on a particular worker. The coroutine does not
+			 * suspend if it is already running on that worker.
+			 *
+			 * @param worker The index of the worker.
+			 * @return An awaitable.
+			 */
+			schedule_on_awaiter schedule_on(std::size_t worker) noexcept { return { this, worker }; }
+
+			/**
+			 * Starts a task on the executor without awaiting it.
+			 *
+			 * @param t The task to start.
+			 * @throw std::system_error An error occurred waking a worker.
+			 */
+			void spawn(task<void> t)
+			{
+				detail::run_detached(start(std::move(t)));
+			}
+
+			/**
+			 * Runs a callable on a particular worker. This function may be called from any
+			 * thread, and blocks while the mailbox of the worker is full (unless called from the
+			 * worker itself).
+			 *
+			 * @param worker The index of the worker.
+			 * @param f The callable to run.
+			 * @throw std::out_of_range @p worker is not a valid worker index.
+			 * @throw std::system_error An error occurred waking the worker.
+			 */
+			void post(std::size_t worker, std::function<void()> f);
+
+			/**
+			 * Finds the worker pinned to the CPU which last processed incoming packets for a
+			 * socket (as reported by `SO_INCOMING_CPU`), so that a connection can be handled on
+			 * the core its packets already arrive on.
+			 *
+			 * @param sockfd The socket file descriptor.
+			 * @return The index of the worker, or of an arbitrary (but consistent) worker if no
+			 *         worker is pinned to that CPU.
+			 * @throw std::system_error An error occurred.
+			 */
+			std::size_t worker_for(int sockfd) const;
+
+			/**
+			 * Gets the event loop of a worker, which may only be used on that worker.
+			 *
+			 * @param worker The index of the worker.
+			 * @return The event loop.
+			 */
+			wx::event_loop& loop(std::size_t worker) noexcept;
+
+			/**
+			 * Gets the CPU to which a worker is pinned.
+			 *
+			 * @param worker The index of the worker.
+			 * @return The CPU number.
+			 */
+			int cpu(std::size_t worker) const noexcept;
+
+			/**
+			 * Gets the index of the worker running the calling thread.
+			 *
+			 * @return The worker index, or npos if the calling thread is not a worker of this
+			 *         executor.
+			 */
+			std::size_t current_worker() const noexcept;
+
+			/**
+			 * Gets the number of workers.
+			 *
+			 * @return The number of workers.
+			 */
+			std::size_t size() const noexcept { return _workers.size(); }
+
+			/**
+			 * Causes the workers to exit once they have finished what they are currently running.
+			 * This function may be called from any thread, including a worker.
+			 *
+			 * @throw std::system_error An error occurred waking the workers.
+			 */
+			void stop();
+
+			/**
+			 * Waits for the workers to exit after a call to stop(). This function must not be
+			 * called from a worker.
+			 */
+			void join();
+
+		private:
+
+			struct worker;
+
+			task<void> start(task<void> t)
+			{
+				co_await schedule();
+				co_await t;
+			}
+
+			void enqueue(std::coroutine_handle<> h);
+			void wake_one();
+			bool steal(worker& self);
+			void run(worker& self);
+
+			std::vector<std::unique_ptr<worker>> _workers;
+			std::vector<std::thread> _threads;
+			std::vector<std::size_t> _cpu_workers;
+			std::atomic<bool> _stopping;
+			std::atomic<std::size_t> _sleepers;
+			std::atomic<std::size_t> _next;
+	};
+}
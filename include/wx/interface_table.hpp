@@ -0,0 +1,174 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <wx/netlink.hpp>
+
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace wx
+{
+	/**
+	 * A cached snapshot of the network interfaces and their addresses, indexed by name and by
+	 * interface index, which is invalidated by netlink notifications.
+	 *
+	 * @remarks The snapshot is taken with w::getifaddrs() and flattened into contiguous arrays,
+	 *          so a lookup is a single hash probe with no system call. The table subscribes to
+	 *          link and address change notifications (`RTMGRP_LINK`, `RTMGRP_IPV4_IFADDR` and
+	 *          `RTMGRP_IPV6_IFADDR`) on a wx::netlink_socket, which poll() drains without blocking.
+	 *          Any change (or a lost notification) marks the snapshot stale, and it is taken again
+	 *          on the next lookup, so a burst of changes costs a single refresh. Register fd()
+	 *          with an event loop (such as wx::event_loop) and call poll() when it is readable, or
+	 *          call poll() before lookups which must observe recent changes.
+	 *
+	 *          Pointers and spans returned by lookups remain valid until the next refresh. This
+	 *          class is not thread-safe.
+	 */
+	class interface_table
+	{
+		public:
+
+			/**
+			 * An address assigned to an interface.
+			 */
+			struct address
+			{
+				/**
+				 * The address, whose `sa_family` is `AF_INET` or `AF_INET6`.
+				 */
+				union
+				{
+					struct sockaddr sa;
+					struct sockaddr_in in;
+					struct sockaddr_in6 in6;
+				};
+
+				/**
+				 * The length of the network prefix, in bits.
+				 */
+				unsigned prefix_length;
+			};
+
+			/**
+			 * A network interface.
+			 */
+			struct interface
+			{
+				/**
+				 * The name of the interface.
+				 */
+				char name[IF_NAMESIZE];
+
+				/**
+				 * The index of the interface.
+				 */
+				unsigned index;
+
+				/**
+				 * The interface flags (e.g. `IFF_UP`).
+				 */
+				unsigned flags;
+
+				/**
+				 * The addresses assigned to the interface, in the order reported by the kernel.
+				 */
+				std::span<const address> addresses;
+			};
+
+			/**
+			 * Subscribes to netlink notifications and takes a snapshot of the interfaces.
+			 *
+			 * @throw std::system_error An error occurred.
+			 */
+			interface_table();
+
+			interface_table(const interface_table&) = delete;
+			interface_table& operator=(const interface_table&) = delete;
+
+			/**
+			 * Looks up an interface by name.
+			 *
+			 * @param name The name of the interface.
+			 * @return A pointer to the interface, or `nullptr` if there is no such interface.
+			 * @throw std::system_error An error occurred refreshing a stale snapshot.
+			 */
+			const interface *find(std::string_view name);
+
+			/**
+			 * Looks up an interface by index.
+			 *
+			 * @param index The index of the interface.
+			 * @return A pointer to the interface, or `nullptr` if there is no such interface.
+			 * @throw std::system_error An error occurred refreshing a stale snapshot.
+			 */
+			const interface *find(unsigned index);
+
+			/**
+			 * Gets the first IPv6 link-local address of an interface, as wx::ipv6::get_link_local_address()
+			 * does. The scope of the returned address is set to the interface.
+			 *
+			 * @param name The name of the interface.
+			 * @return The link-local address, or `std::nullopt` if there is no such interface or
+			 *         it has no link-local address.
+			 * @throw std::system_error An error occurred refreshing a stale snapshot.
+			 */
+			std::optional<struct sockaddr_in6> link_local_address(std::string_view name);
+
+			/**
+			 * Gets all the interfaces, in the order in which they were first reported by the
+			 * kernel.
+			 *
+			 * @return A span of the interfaces.
+			 * @throw std::system_error An error occurred refreshing a stale snapshot.
+			 */
+			std::span<const interface> interfaces();
+
+			/**
+			 * Drains pending netlink notifications without blocking, and marks the snapshot
+			 * stale if any of them reports a change.
+			 *
+			 * @return `true` if the snapshot is stale.
+			 * @throw std::system_error An error occurred.
+			 */
+			bool poll();
+
+			/**
+			 * Takes a new snapshot immediately.
+			 *
+			 * @throw std::system_error An error occurred.
+			 */
+			void refresh();
+
+			/**
+			 * Gets the netlink socket file descriptor, which becomes readable when notifications
+			 * are pending.
+			 *
+			 * @return The netlink socket file descriptor.
+			 */
+			int fd() const noexcept { return _netlink.fd(); }
+
+		private:
+
+			void refresh_if_stale();
+
+			wx::netlink_socket _netlink;
+			bool _stale;
+			std::vector<interface> _interfaces;
+			std::vector<address> _addresses;
+			std::unordered_map<std::string_view, std::size_t> _by_name;
+			std::unordered_map<unsigned, std::size_t> _by_index;
+	};
+}
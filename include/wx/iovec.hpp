@@ -0,0 +1,180 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include <sys/uio.h>
+
+namespace wx
+{
+	/**
+	 * A fixed-capacity array of `struct iovec` segments, for gathering a message from several
+	 * pieces (such as a protocol header and a body) into a single w::writev() or w::sendmsg()
+	 * call without copying or allocating.
+	 *
+	 * @remarks The builder only refers to the pieces, which must outlive its use. Empty pieces
+	 *          are skipped.
+	 *
+	 * @tparam N The maximum number of segments.
+	 */
+	template <std::size_t N>
+	class iovec_builder
+	{
+		static_assert(N > 0, "iovec builder must have room for at least one segment");
+
+		public:
+
+			/**
+			 * Constructs an empty builder.
+			 */
+			iovec_builder() noexcept : _count(0), _bytes(0) { }
+
+			/**
+			 * Appends a segment.
+			 *
+			 * @param base A pointer to the data.
+			 * @param len The number of bytes.
+			 * @return A reference to this builder.
+			 * @throw std::length_error The builder already holds @p N segments.
+			 */
+			iovec_builder& add(const void *base, std::size_t len)
+			{
+				if (!len)
+					return *this;
+
+				if (_count == N)
+					throw std::length_error("iovec builder is full");
+
+				_iov[_count++] = { const_cast<void *>(base), len };
+				_bytes += len;
+				return *this;
+			}
+
+			/**
+			 * Appends a segment.
+			 *
+			 * @param str The data.
+			 * @return A reference to this builder.
+			 * @throw std::length_error The builder already holds @p N segments.
+			 */
+			iovec_builder& add(std::string_view str) { return add(str.data(), str.size()); }
+
+			/**
+			 * Appends a segment.
+			 *
+			 * @tparam T The element type, which should be trivially copyable.
+			 * @tparam Extent The extent of the span.
+			 * @param data The data.
+			 * @return A reference to this builder.
+			 * @throw std::length_error The builder already holds @p N segments.
+			 */
+			template <typename T, std::size_t Extent>
+			iovec_builder& add(std::span<T, Extent> data) { return add(data.data(), data.size_bytes()); }
+
+			/**
+			 * Removes all segments.
+			 */
+			void clear() noexcept
+			{
+				_count = 0;
+				_bytes = 0;
+			}
+
+			/**
+			 * Gets the segments added so far.
+			 *
+			 * @return A span of the segments, which wx::write_all() and wx::send_all() advance in
+			 *         place.
+			 */
+			std::span<struct iovec> segments() noexcept { return { _iov.data(), _count }; }
+
+			/**
+			 * Gets a pointer to the first segment, for passing to w::writev().
+			 *
+			 * @return A pointer to the segments.
+			 */
+			const struct iovec *data() const noexcept { return _iov.data(); }
+
+			/**
+			 * Gets the number of segments added so far.
+			 *
+			 * @return The number of segments.
+			 */
+			std::size_t size() const noexcept { return _count; }
+
+			/**
+			 * Gets the total length of the segments added so far.
+			 *
+			 * @return The number of bytes.
+			 */
+			std::size_t bytes() const noexcept { return _bytes; }
+
+			/**
+			 * Gets the capacity of the builder.
+			 *
+			 * @return The maximum number of segments.
+			 */
+			static constexpr std::size_t capacity() noexcept { return N; }
+
+		private:
+
+			std::array<struct iovec, N> _iov;
+			std::size_t _count;
+			std::size_t _bytes;
+	};
+
+	/**
+	 * Advances an array of segments past data which has been transferred, as after a short
+	 * w::writev().
+	 *
+	 * @param iov The segments. Segments which were transferred completely are dropped from the
+	 *        front, and the first remaining segment is adjusted to start after the transferred
+	 *        part, in place.
+	 * @param n The number of bytes transferred, which must not exceed the total length of
+	 *        @p iov.
+	 * @return The remaining segments, which is empty once everything has been transferred.
+	 */
+	std::span<struct iovec> advance(std::span<struct iovec> iov, std::size_t n) noexcept;
+
+	/**
+	 * Writes all the data in an array of segments to a file descriptor, calling w::writev()
+	 * until the whole of it has been written.
+	 *
+	 * @remarks Each call passes at most `IOV_MAX` segments. Calls interrupted by a signal
+	 *          (`EINTR`) are restarted. This function is intended for blocking file descriptors;
+	 *          on a non-blocking one, `EAGAIN` is thrown like any other error.
+	 *
+	 * @param fd The file descriptor to write to.
+	 * @param iov The segments to write. They are advanced in place with wx::advance(), so if an
+	 *        error is thrown, the data which remains to be written can be found from them.
+	 * @return The number of bytes written.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t write_all(int fd, std::span<struct iovec> iov);
+
+	/**
+	 * Sends all the data in an array of segments on a stream socket, calling w::sendmsg()
+	 * until the whole of it has been sent.
+	 *
+	 * @remarks Each call passes at most `IOV_MAX` segments. Calls interrupted by a signal
+	 *          (`EINTR`) are restarted. This function is intended for blocking sockets; on a
+	 *          non-blocking one, `EAGAIN` is thrown like any other error.
+	 *
+	 * @param sockfd The socket to send on.
+	 * @param iov The segments to send. They are advanced in place with wx::advance(), so if an
+	 *        error is thrown, the data which remains to be sent can be found from them.
+	 * @param flags The flags to pass to each call, such as `MSG_NOSIGNAL`.
+	 * @return The number of bytes sent.
+	 * @throw std::system_error An error occurred.
+	 */
+	std::size_t send_all(int sockfd, std::span<struct iovec> iov, int flags = 0);
+}
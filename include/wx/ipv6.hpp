@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include <charconv>
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 #include <netinet/ip6.h>
 
@@ -37,6 +40,50 @@ namespace wx::ipv6
 	 */
 	struct sockaddr_in6 get_link_local_address(const char *interface_name);
 
+	/**
+	 * The maximum length of the string representation of an IPv6 address produced by
+	 * to_chars(), excluding any terminator.
+	 */
+	inline constexpr std::size_t max_string_length = 45;
+
+	/**
+	 * Formats an IPv6 address into a buffer without allocating, in the same form as
+	 * `inet_ntop()`: lowercase hexadecimal groups without leading zeros, with the longest run of
+	 * two or more zero groups shortened to `::`, and IPv4-mapped and IPv4-compatible addresses
+	 * ending in dotted decimal notation.
+	 *
+	 * @param first A pointer to the start of the buffer.
+	 * @param last A pointer to the end of the buffer. A buffer of max_string_length characters
+	 *        is always large enough.
+	 * @param address The IPv6 address to format.
+	 * @return A pointer past the last character written (no terminator is written) and no error
+	 *         on success, or @p last and `std::errc::value_too_large` if the buffer is too small.
+	 */
+	std::to_chars_result to_chars(char *first, char *last, const in6_addr& address) noexcept;
+
+	/**
+	 * Parses the text representation of an IPv6 address, as accepted by `inet_pton()`, without
+	 * allocating. The address must begin at @p first, but parsing stops at the first character
+	 * which cannot continue it (such as a `%` scope or `]`).
+	 *
+	 * @param first A pointer to the start of the string.
+	 * @param last A pointer to the end of the string.
+	 * @param address Set to the parsed address on success, and left unchanged otherwise.
+	 * @return A pointer past the last character of the address and no error on success, or
+	 *         @p first and `std::errc::invalid_argument` if the string does not begin with a
+	 *         valid address.
+	 */
+	std::from_chars_result from_chars(const char *first, const char *last, in6_addr& address) noexcept;
+
+	/**
+	 * Parses the text representation of an IPv6 address, which must make up the whole string.
+	 *
+	 * @param str The string to parse.
+	 * @return The parsed address.
+	 * @throw std::runtime_error @p str is not a valid IPv6 address.
+	 */
+	in6_addr parse(std::string_view str);
+
 	/**
 	 * Produces a string representation of an IPv6 address.
 	 *
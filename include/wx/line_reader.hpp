@@ -0,0 +1,105 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include <w/posix.hpp>
+
+namespace wx
+{
+	/**
+	 * Reads delimited records, such as the lines of a log file or the rows of a procfs table,
+	 * from a file descriptor or from memory, without copying them out.
+	 *
+	 * @remarks Records are returned as views into an internal buffer, which is refilled with
+	 *          large `read()` calls as it is consumed; records which straddle a refill are moved
+	 *          to the start of the buffer, and the buffer grows if a single record does not fit.
+	 *          Memory use is therefore bounded by the block size (or the longest record), however
+	 *          large the input. Delimiters are found with `memchr()`, which the C library
+	 *          vectorizes, and each byte is scanned only once.
+	 *
+	 *          The records can be parsed in place with wx::number() or wx::parse_integers():
+	 *
+	 *              wx::line_reader reader("/proc/self/mountinfo");
+	 *              std::string_view line;
+	 *
+	 *              while (reader.next(line))
+	 *                  ...
+	 *
+	 *          A record does not include its delimiter. The last record is returned even if it is
+	 *          not followed by a delimiter, but an empty input, or a final delimiter at the end of
+	 *          the input, produces no empty record.
+	 */
+	class line_reader
+	{
+		public:
+
+			/**
+			 * Opens a file to read records from.
+			 *
+			 * @param path The path of the file. Sequential access is advised to the kernel, which
+			 *        enlarges its readahead window.
+			 * @param delimiter The byte which separates records.
+			 * @param block_size The number of bytes requested from the kernel per read.
+			 * @throw std::system_error An error occurred.
+			 */
+			explicit line_reader(const char *path, char delimiter = '\n', std::size_t block_size = 1 << 18);
+
+			/**
+			 * Reads records from an open file descriptor, starting at its current offset.
+			 *
+			 * @param fd The file descriptor, which is not owned by the reader and must outlive
+			 *        it.
+			 * @param delimiter The byte which separates records.
+			 * @param block_size The number of bytes requested from the kernel per read.
+			 */
+			explicit line_reader(int fd, char delimiter = '\n', std::size_t block_size = 1 << 18);
+
+			line_reader(const line_reader&) = delete;
+			line_reader& operator=(const line_reader&) = delete;
+
+			/**
+			 * Creates a reader of records in memory, such as the view of a wx::mapped_file.
+			 * Nothing is copied, and the records stay valid as long as @p data does.
+			 *
+			 * @param data The data.
+			 * @param delimiter The byte which separates records.
+			 * @return The reader.
+			 */
+			static line_reader from_memory(std::string_view data, char delimiter = '\n') noexcept;
+
+			/**
+			 * Gets the next record.
+			 *
+			 * @param record Set to a view of the record. Unless the reader reads from memory, the
+			 *        view is only valid until the next call.
+			 * @return `true` if a record was read, or `false` at the end of the input.
+			 * @throw std::system_error A read error occurred.
+			 */
+			bool next(std::string_view& record);
+
+		private:
+
+			line_reader(std::string_view data, char delimiter) noexcept;
+
+			void refill();
+
+			w::fd _owned;
+			int _fd;
+			char _delimiter;
+			std::size_t _block_size;
+			std::unique_ptr<char[]> _buffer;
+			std::size_t _capacity;
+			const char *_next;
+			const char *_scan;
+			const char *_end;
+			bool _eof;
+	};
+}
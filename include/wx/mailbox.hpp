@@ -0,0 +1,271 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+#include <wx/cache_line.hpp>
+
+#include <sys/eventfd.h>
+
+namespace wx
+{
+	/**
+	 * A bounded, lock-free, multiple-producer/single-consumer queue with an event file descriptor
+	 * which is only signalled when the consumer is waiting.
+	 *
+	 * @remarks Any number of threads may call try_push(); all other members must be called from a
+	 *          single consumer thread. The consumer waits by registering fd() for `EPOLLIN` with
+	 *          an epoll instance (or wx::event_loop) and calling drain() when it becomes readable.
+	 *          drain() leaves the mailbox "parked" once it is empty, and only the first push into
+	 *          a parked mailbox writes to the event file descriptor, so producers make no system
+	 *          call at all while the consumer is busy, and a burst of pushes costs at most one
+	 *          wakeup.
+	 *
+	 *          The queue is the bounded array queue described by Dmitry Vyukov, with a sequence
+	 *          number per slot, and the producer and consumer positions on separate cache lines.
+	 *
+	 * @tparam T The type of the queued values, which must be nothrow move constructible.
+	 */
+	template <typename T>
+	class mailbox
+	{
+		static_assert(std::is_nothrow_move_constructible_v<T>,
+			"mailbox values must be nothrow move constructible");
+
+		public:
+
+			/**
+			 * Constructs an empty mailbox.
+			 *
+			 * @param capacity The maximum number of queued values, which is rounded up to a power
+			 *        of two.
+			 * @throw std::invalid_argument @p capacity is zero.
+			 * @throw std::system_error An error occurred creating the event file descriptor.
+			 */
+			explicit mailbox(std::size_t capacity)
+				: _event(w::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+				  _parked(true),
+				  _tail(0),
+				  _head(0)
+			{
+				if (!capacity)
+					throw std::invalid_argument("mailbox capacity must be nonzero");
+
+				capacity = std::bit_ceil(capacity);
+				_mask = capacity - 1;
+				_cells = std::make_unique<cell[]>(capacity);
+
+				for (std::size_t i = 0; i < capacity; ++i)
+					_cells[i].seq.store(i, std::memory_order_relaxed);
+			}
+
+			mailbox(const mailbox&) = delete;
+			mailbox& operator=(const mailbox&) = delete;
+
+			/**
+			 * Destroys the mailbox and any values still queued.
+			 */
+			~mailbox()
+			{
+				while (try_pop())
+					;
+			}
+
+			/**
+			 * Enqueues a value. This function may be called from any thread.
+			 *
+			 * @param value The value to enqueue, which is only moved from if the push succeeds.
+			 * @return `true` if the value was enqueued, or `false` if the mailbox is full.
+			 * @throw std::system_error An error occurred signalling the event file descriptor.
+			 */
+			bool try_push(T&& value)
+			{
+				std::size_t pos = _tail.load(std::memory_order_relaxed);
+				cell *c;
+
+				for (;;)
+				{
+					c = &_cells[pos & _mask];
+					std::size_t seq = c->seq.load(std::memory_order_acquire);
+					auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+					if (diff == 0)
+					{
+						if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+							break;
+					}
+					else if (diff < 0)
+						return false;
+					else
+						pos = _tail.load(std::memory_order_relaxed);
+				}
+
+				new (c->storage) T(std::move(value));
+				c->seq.store(pos + 1, std::memory_order_release);
+
+				// Pairs with the fence in park(): either the consumer sees the value published
+				// above, or we see that it is parked (and only one producer gets to wake it).
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (_parked.load(std::memory_order_relaxed) && _parked.exchange(false))
+					w::eventfd_write(_event, 1);
+
+				return true;
+			}
+
+			/**
+			 * Enqueues a copy of a value. This function may be called from any thread.
+			 *
+			 * @param value The value to enqueue.
+			 * @return `true` if the value was enqueued, or `false` if the mailbox is full.
+			 * @throw std::system_error An error occurred signalling the event file descriptor.
+			 * @throw ... Any exception thrown by copying @p value is propagated.
+			 */
+			bool try_push(const T& value)
+			{
+				T copy(value);
+				return try_push(std::move(copy));
+			}
+
+			/**
+			 * Dequeues a value, if one is available. This function may only be called by the
+			 * consumer.
+			 *
+			 * @return The dequeued value, or `std::nullopt` if the mailbox is empty.
+			 */
+			std::optional<T> try_pop() noexcept
+			{
+				std::size_t pos = _head.load(std::memory_order_relaxed);
+				cell& c = _cells[pos & _mask];
+
+				if (c.seq.load(std::memory_order_acquire) != pos + 1)
+					return std::nullopt;
+
+				T *ptr = std::launder(reinterpret_cast<T *>(c.storage));
+				std::optional<T> value(std::move(*ptr));
+				ptr->~T();
+
+				c.seq.store(pos + _mask + 1, std::memory_order_release);
+				_head.store(pos + 1, std::memory_order_relaxed);
+				return value;
+			}
+
+			/**
+			 * Consumes the event file descriptor and dequeues every available value, then parks
+			 * the mailbox so that the next push signals the event file descriptor. This function
+			 * may only be called by the consumer.
+			 *
+			 * @tparam F The type of @p f.
+			 * @param f A callable to invoke with each dequeued value, as a `T&&`.
+			 * @return The number of values dequeued.
+			 * @throw std::system_error An error occurred reading the event file descriptor.
+			 * @throw ... Any exception thrown by @p f is propagated, leaving the mailbox unparked;
+			 *        drain() should be called again to consume the remaining values.
+			 */
+			template <typename F>
+			std::size_t drain(F&& f)
+			{
+				std::error_code ec;
+				w::eventfd_read(_event, ec);
+
+				if (ec && !w::would_block(ec))
+					throw std::system_error(ec, "failed to read mailbox event file descriptor");
+
+				_parked.store(false, std::memory_order_relaxed);
+				std::size_t count = 0;
+
+				do
+				{
+					while (std::optional<T> value = try_pop())
+					{
+						++count;
+						f(std::move(*value));
+					}
+				}
+				while (!park());
+
+				return count;
+			}
+
+			/**
+			 * Marks the consumer as waiting, so that the next push signals the event file
+			 * descriptor. This function may only be called by the consumer, and is only needed
+			 * when values are dequeued with try_pop() rather than drain().
+			 *
+			 * @return `true` if the mailbox was parked, or `false` if values arrived in the
+			 *         meantime (in which case the mailbox is not parked, and they should be
+			 *         dequeued before trying again).
+			 */
+			bool park() noexcept
+			{
+				_parked.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (empty())
+					return true;
+
+				_parked.store(false, std::memory_order_relaxed);
+				return false;
+			}
+
+			/**
+			 * Tests whether the mailbox is empty. This function may only be called by the
+			 * consumer.
+			 *
+			 * @return `true` if no value is available to dequeue.
+			 */
+			bool empty() const noexcept
+			{
+				std::size_t pos = _head.load(std::memory_order_relaxed);
+				return _cells[pos & _mask].seq.load(std::memory_order_acquire) != pos + 1;
+			}
+
+			/**
+			 * Gets the capacity of the mailbox.
+			 *
+			 * @return The maximum number of queued values.
+			 */
+			std::size_t capacity() const noexcept { return _mask + 1; }
+
+			/**
+			 * Gets the event file descriptor, which becomes readable when a value is pushed into a
+			 * parked mailbox.
+			 *
+			 * @return The event file descriptor.
+			 */
+			int fd() const noexcept { return _event; }
+
+		private:
+
+			struct cell
+			{
+				std::atomic<std::size_t> seq;
+				alignas(T) unsigned char storage[sizeof(T)];
+			};
+
+			w::fd _event;
+			std::unique_ptr<cell[]> _cells;
+			std::size_t _mask;
+			alignas(wx::cache_line_size) std::atomic<bool> _parked;
+			alignas(wx::cache_line_size) std::atomic<std::size_t> _tail;
+			alignas(wx::cache_line_size) std::atomic<std::size_t> _head;
+	};
+}
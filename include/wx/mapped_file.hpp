@@ -0,0 +1,121 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <string_view>
+
+#include <w/posix.hpp>
+
+#include <sys/mman.h>
+
+namespace wx
+{
+	/**
+	 * A read-only view of the contents of a file, mapped into memory.
+	 *
+	 * @remarks The file is mapped privately, so its pages are shared through the page cache with
+	 *          every other process mapping or reading the same file. The view reflects the file's
+	 *          size at the time it was mapped; accessing it after the file has been truncated
+	 *          raises `SIGBUS`. Empty files produce an empty view without a mapping, as do
+	 *          files whose size is not reported by the kernel (such as those in procfs), which
+	 *          should be read with wx::read_file_as_string() instead.
+	 */
+	class mapped_file
+	{
+		public:
+
+			/**
+			 * Constructs an empty view.
+			 */
+			mapped_file() noexcept = default;
+
+			/**
+			 * Opens and maps a file.
+			 *
+			 * @param path The path of the file to map.
+			 * @param advice The expected access pattern, as passed to `madvise()` (e.g.
+			 *        `MADV_SEQUENTIAL`, `MADV_RANDOM` or `MADV_WILLNEED`).
+			 * @param flags Additional `mmap()` flags (e.g. `MAP_POPULATE` to prefault the whole
+			 *        file up front).
+			 * @throw std::invalid_argument The file is not a regular file.
+			 * @throw std::system_error An error occurred.
+			 */
+			explicit mapped_file(const char *path, int advice = MADV_NORMAL, int flags = 0);
+
+			/**
+			 * Maps an open file. The file descriptor is not needed after the constructor returns.
+			 *
+			 * @param fd The file descriptor of the file to map, which must be open for reading.
+			 * @param advice The expected access pattern, as passed to `madvise()`.
+			 * @param flags Additional `mmap()` flags.
+			 * @throw std::invalid_argument The file is not a regular file.
+			 * @throw std::system_error An error occurred.
+			 */
+			mapped_file(int fd, int advice, int flags);
+
+			/**
+			 * Gives the kernel advice about the access pattern of part of the file. The range is
+			 * extended outward to page boundaries.
+			 *
+			 * @param advice The expected access pattern, as passed to `madvise()`.
+			 * @param offset The offset of the start of the range.
+			 * @param length The number of bytes in the range, which is clamped to the end of the
+			 *        file.
+			 * @throw std::system_error An error occurred.
+			 */
+			void advise(int advice, std::size_t offset = 0,
+				std::size_t length = std::numeric_limits<std::size_t>::max());
+
+			/**
+			 * Gets a pointer to the contents of the file.
+			 *
+			 * @return A pointer to the contents, or `nullptr` if the view is empty.
+			 */
+			const std::byte *data() const noexcept
+			{
+				return static_cast<const std::byte *>(_mapping.get().address);
+			}
+
+			/**
+			 * Gets the size of the file.
+			 *
+			 * @return The number of bytes in the view.
+			 */
+			std::size_t size() const noexcept { return _mapping.get().length; }
+
+			/**
+			 * Tests whether the view is empty.
+			 *
+			 * @return `true` if the view is empty.
+			 */
+			bool empty() const noexcept { return !size(); }
+
+			/**
+			 * Gets the contents of the file as characters.
+			 *
+			 * @return A view of the contents.
+			 */
+			std::string_view view() const noexcept
+			{
+				return { reinterpret_cast<const char *>(data()), size() };
+			}
+
+			/**
+			 * Gets the contents of the file as bytes.
+			 *
+			 * @return A view of the contents.
+			 */
+			std::span<const std::byte> bytes() const noexcept { return { data(), size() }; }
+
+		private:
+
+			w::mmap_handle _mapping;
+	};
+}
@@ -0,0 +1,147 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <w/posix.hpp>
+#include <wx/cache_line.hpp>
+
+namespace wx
+{
+	/**
+	 * A ring buffer whose memory is mapped twice, back to back, so that the readable and the
+	 * writable parts are always contiguous, however they wrap around the end of the buffer.
+	 *
+	 * @remarks The buffer is a `memfd_create()` file mapped at two adjacent addresses, so that
+	 *          byte `i` and byte `i + capacity()` are the same memory. A stream parser can
+	 *          therefore look at everything readable as one span without copying the part which
+	 *          wrapped around, and each socket read fills all the free space with a single
+	 *          call:
+	 *
+	 *              auto space = ring.writable();
+	 *              ring.commit(w::recv(fd, space.data(), space.size()));
+	 *
+	 *              auto data = ring.readable();
+	 *              ring.consume(parse(data.data(), data.size()));
+	 *
+	 *          The read and write positions are atomic, so that one producer thread (calling
+	 *          writable() and commit()) and one consumer thread (calling readable() and consume())
+	 *          may use the ring concurrently without locking; a single thread may also do both.
+	 *          The spans returned stay valid until the matching commit() or consume().
+	 */
+	class mirrored_ring
+	{
+		public:
+
+			/**
+			 * Creates a ring buffer.
+			 *
+			 * @param capacity The minimum capacity of the buffer, which is rounded up to a
+			 *        power of two no smaller than the page size.
+			 * @throw std::invalid_argument @p capacity is zero or too large.
+			 * @throw std::system_error An error occurred.
+			 */
+			explicit mirrored_ring(std::size_t capacity);
+
+			mirrored_ring(const mirrored_ring&) = delete;
+			mirrored_ring& operator=(const mirrored_ring&) = delete;
+
+			/**
+			 * Gets the free space of the buffer, for the producer to write into.
+			 *
+			 * @return A span of the free space, which is empty if the buffer is full.
+			 */
+			std::span<std::byte> writable() noexcept
+			{
+				std::uint64_t head = _head.load(std::memory_order_relaxed);
+				std::uint64_t tail = _tail.load(std::memory_order_acquire);
+
+				return { _base + (head & _mask), static_cast<std::size_t>(_mask + 1 - (head - tail)) };
+			}
+
+			/**
+			 * Makes data written into the free space readable.
+			 *
+			 * @param n The number of bytes written at the start of the span returned by
+			 *        writable(), which must not exceed its size.
+			 */
+			void commit(std::size_t n) noexcept
+			{
+				_head.store(_head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+			}
+
+			/**
+			 * Gets the data in the buffer, for the consumer to read.
+			 *
+			 * @return A span of the readable data, which is empty if the buffer is empty.
+			 */
+			std::span<const std::byte> readable() const noexcept
+			{
+				std::uint64_t tail = _tail.load(std::memory_order_relaxed);
+				std::uint64_t head = _head.load(std::memory_order_acquire);
+
+				return { _base + (tail & _mask), static_cast<std::size_t>(head - tail) };
+			}
+
+			/**
+			 * Discards data which has been read, making its space free.
+			 *
+			 * @param n The number of bytes at the start of the span returned by readable()
+			 *        which have been read, which must not exceed its size.
+			 */
+			void consume(std::size_t n) noexcept
+			{
+				_tail.store(_tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+			}
+
+			/**
+			 * Gets the number of readable bytes. When called by neither the producer nor the
+			 * consumer, the result may be stale by the time it is returned.
+			 *
+			 * @return The number of readable bytes.
+			 */
+			std::size_t size() const noexcept
+			{
+				// The tail is loaded first: it never passes the head, so a head loaded later is
+				// at least as far along, and the difference cannot wrap around. The producer may
+				// have refilled space freed after the tail was loaded, though, so the difference
+				// is clamped to the capacity.
+
+				std::uint64_t tail = _tail.load(std::memory_order_acquire);
+				std::uint64_t head = _head.load(std::memory_order_acquire);
+
+				return static_cast<std::size_t>(std::min(head - tail, _mask + 1));
+			}
+
+			/**
+			 * Tests whether the buffer is empty.
+			 *
+			 * @return `true` if there is nothing to read.
+			 */
+			bool empty() const noexcept { return !size(); }
+
+			/**
+			 * Gets the capacity of the buffer.
+			 *
+			 * @return The capacity, in bytes.
+			 */
+			std::size_t capacity() const noexcept { return static_cast<std::size_t>(_mask + 1); }
+
+		private:
+
+			w::mmap_handle _mapping;
+			std::byte *_base;
+			std::uint64_t _mask;
+			alignas(wx::cache_line_size) std::atomic<std::uint64_t> _head;
+			alignas(wx::cache_line_size) std::atomic<std::uint64_t> _tail;
+	};
+}
@@ -0,0 +1,317 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <w/sockets.hpp>
+
+namespace wx
+{
+	/**
+	 * A reusable set of message headers for sending and receiving datagrams in batches with
+	 * `recvmmsg()` and `sendmmsg()`.
+	 *
+	 * @remarks The `mmsghdr`, `iovec`, address and control arrays are allocated once, in a single
+	 *          contiguous block, when the batch is constructed, and are reused by every call. Each
+	 *          message has a single data buffer supplied by the caller with set_buffer() or
+	 *          set_buffers(). Only the entries touched by the previous call are reinitialized
+	 *          before each receive.
+	 *
+	 * @tparam N The maximum number of messages per batch.
+	 * @tparam Address The type of the per-message peer addresses (e.g. `sockaddr_in6`), as used
+	 *         by the typed w::recvfrom() and w::sendto() templates.
+	 * @tparam ControlSize The size, in bytes, of the ancillary data buffer of each message, or
+	 *         zero for none.
+	 */
+	template <std::size_t N, typename Address, std::size_t ControlSize = 0>
+	class mmsg_batch
+	{
+		static_assert(N > 0, "batch must hold at least one message");
+
+		public:
+
+			/**
+			 * Constructs a batch with no data buffers.
+			 */
+			mmsg_batch()
+				: _storage(std::make_unique<storage>()),
+				  _dirty(N)
+			{
+				std::memset(_storage.get(), 0, sizeof(storage));
+
+				for (std::size_t i = 0; i < N; ++i)
+				{
+					struct msghdr& hdr = _storage->msgs[i].msg_hdr;
+					hdr.msg_name = &_storage->addresses[i];
+					hdr.msg_iov = &_storage->iov[i];
+					hdr.msg_iovlen = 1;
+
+					if constexpr (ControlSize != 0)
+						hdr.msg_control = _storage->control[i].data;
+				}
+			}
+
+			/**
+			 * Constructs a batch whose data buffers are consecutive slices of a single region.
+			 *
+			 * @param buffers A pointer to a region of at least `N * stride` bytes.
+			 * @param stride The size of each message's data buffer.
+			 */
+			mmsg_batch(void *buffers, std::size_t stride)
+				: mmsg_batch()
+			{
+				set_buffers(buffers, stride);
+			}
+
+			/**
+			 * Sets the data buffer of a single message.
+			 *
+			 * @param i The index of the message.
+			 * @param buf A pointer to the buffer.
+			 * @param len The size of the buffer, which is the maximum number of bytes received
+			 *        into this message.
+			 */
+			void set_buffer(std::size_t i, void *buf, std::size_t len) noexcept
+			{
+				_storage->iov[i].iov_base = buf;
+				_storage->iov[i].iov_len = len;
+				_storage->capacity[i] = len;
+			}
+
+			/**
+			 * Sets the data buffers of all messages to consecutive slices of a single region.
+			 *
+			 * @param buffers A pointer to a region of at least `N * stride` bytes.
+			 * @param stride The size of each message's data buffer.
+			 */
+			void set_buffers(void *buffers, std::size_t stride) noexcept
+			{
+				for (std::size_t i = 0; i < N; ++i)
+					set_buffer(i, static_cast<std::byte *>(buffers) + i * stride, stride);
+			}
+
+			/**
+			 * Gets the peer address of a message. After a receive, this is the source address;
+			 * before a send, it should be set to the destination address.
+			 *
+			 * @param i The index of the message.
+			 * @return A reference to the address.
+			 */
+			Address& address(std::size_t i) noexcept { return _storage->addresses[i]; }
+
+			/**
+			 * Gets the peer address of a message.
+			 *
+			 * @param i The index of the message.
+			 * @return A reference to the address.
+			 */
+			const Address& address(std::size_t i) const noexcept { return _storage->addresses[i]; }
+
+			/**
+			 * Gets the data received into, or sent from, a message by the last call.
+			 *
+			 * @param i The index of the message.
+			 * @return The message data.
+			 */
+			std::span<const std::byte> data(std::size_t i) const noexcept
+			{
+				return { static_cast<const std::byte *>(_storage->iov[i].iov_base), _storage->msgs[i].msg_len };
+			}
+
+			/**
+			 * Gets the message header of a message, for access to ancillary data and flags.
+			 *
+			 * @param i The index of the message.
+			 * @return A reference to the message header.
+			 */
+			struct mmsghdr& operator[](std::size_t i) noexcept { return _storage->msgs[i]; }
+
+			/**
+			 * Gets the message header of a message.
+			 *
+			 * @param i The index of the message.
+			 * @return A reference to the message header.
+			 */
+			const struct mmsghdr& operator[](std::size_t i) const noexcept { return _storage->msgs[i]; }
+
+			/**
+			 * Sets the length of the data to be sent from a message. The data must already be in
+			 * the message's buffer.
+			 *
+			 * @param i The index of the message.
+			 * @param len The number of bytes to send, which must not exceed the buffer size.
+			 */
+			void set_length(std::size_t i, std::size_t len) noexcept
+			{
+				_storage->iov[i].iov_len = len;
+			}
+
+			/**
+			 * Receives a batch of messages.
+			 *
+			 * @param sockfd The socket to receive from.
+			 * @param flags A bitwise combination of flags (e.g. `MSG_WAITFORONE`).
+			 * @return The headers of the messages received. The `msg_len` member of each holds
+			 *         the number of bytes received into it.
+			 * @throw std::runtime_error The address type is not the correct size to hold the
+			 *        source address of a received message.
+			 * @throw std::system_error An error occurred. This includes `EAGAIN` on non-blocking
+			 *        sockets.
+			 */
+			std::span<struct mmsghdr> recv(int sockfd, int flags = 0)
+			{
+				reset();
+				unsigned count = w::recvmmsg(sockfd, _storage->msgs, N, flags);
+				_dirty = count;
+
+				if (!addresses_valid(count))
+					throw std::runtime_error(
+						"provided structure is not the correct size to hold receive source address");
+
+				return { _storage->msgs, count };
+			}
+
+			/**
+			 * Receives a batch of messages without throwing. This overload is intended for
+			 * non-blocking sockets, where `EAGAIN` is reported through @p ec rather than as an
+			 * exception.
+			 *
+			 * @param sockfd The socket to receive from.
+			 * @param flags A bitwise combination of flags (e.g. `MSG_WAITFORONE`).
+			 * @param ec Set to the error which occurred, or cleared on success. If the address
+			 *        type is not the correct size to hold the source address of a received
+			 *        message, @p ec is set to `EINVAL`.
+			 * @return The headers of the messages received, which is empty if an error
+			 *         occurred.
+			 */
+			std::span<struct mmsghdr> recv(int sockfd, int flags, std::error_code& ec) noexcept
+			{
+				reset();
+				unsigned count = w::recvmmsg(sockfd, _storage->msgs, N, flags, nullptr, ec);
+				_dirty = count;
+
+				if (!ec && !addresses_valid(count))
+				{
+					ec = std::make_error_code(std::errc::invalid_argument);
+					return { };
+				}
+
+				return { _storage->msgs, count };
+			}
+
+			/**
+			 * Sends the first @p count messages of the batch, each to its address() and with the
+			 * length given to set_length(). No ancillary data is sent; to send some, fill in the
+			 * headers through operator[]() and pass them to w::sendmmsg() directly.
+			 *
+			 * @param sockfd The socket to send from.
+			 * @param count The number of messages to send, which is clamped to @p N.
+			 * @param flags A bitwise combination of flags.
+			 * @return The number of messages sent, which may be less than @p count.
+			 * @throw std::system_error An error occurred before any message was sent.
+			 */
+			std::size_t send(int sockfd, std::size_t count, int flags = 0)
+			{
+				count = prepare_send(count);
+				return w::sendmmsg(sockfd, _storage->msgs, static_cast<unsigned>(count), flags);
+			}
+
+			/**
+			 * Sends the first @p count messages of the batch without throwing.
+			 *
+			 * @param sockfd The socket to send from.
+			 * @param count The number of messages to send, which is clamped to @p N.
+			 * @param flags A bitwise combination of flags.
+			 * @param ec Set to the error which occurred, or cleared on success.
+			 * @return The number of messages sent, which may be less than @p count, or zero if
+			 *         an error occurred.
+			 */
+			std::size_t send(int sockfd, std::size_t count, int flags, std::error_code& ec) noexcept
+			{
+				count = prepare_send(count);
+				return w::sendmmsg(sockfd, _storage->msgs, static_cast<unsigned>(count), flags, ec);
+			}
+
+			/**
+			 * Gets the maximum number of messages per batch.
+			 *
+			 * @return The maximum number of messages.
+			 */
+			static constexpr std::size_t size() noexcept { return N; }
+
+		private:
+
+			struct alignas(struct cmsghdr) control_block
+			{
+				unsigned char data[ControlSize ? ControlSize : 1];
+			};
+
+			struct storage
+			{
+				struct mmsghdr msgs[N];
+				struct iovec iov[N];
+				std::size_t capacity[N];
+				Address addresses[N];
+				control_block control[ControlSize ? N : 1];
+			};
+
+			void reset() noexcept
+			{
+				// The kernel overwrites the address and control lengths of each message it
+				// fills in, and send() shortens the data lengths, so only that many entries need
+				// to be restored.
+
+				for (std::size_t i = 0; i < _dirty; ++i)
+				{
+					struct msghdr& hdr = _storage->msgs[i].msg_hdr;
+					hdr.msg_namelen = sizeof(Address);
+					hdr.msg_controllen = ControlSize;
+					hdr.msg_flags = 0;
+					_storage->iov[i].iov_len = _storage->capacity[i];
+				}
+
+				_dirty = 0;
+			}
+
+			std::size_t prepare_send(std::size_t count) noexcept
+			{
+				count = std::min(count, N);
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					struct msghdr& hdr = _storage->msgs[i].msg_hdr;
+					hdr.msg_namelen = sizeof(Address);
+					hdr.msg_controllen = 0;
+				}
+
+				_dirty = std::max(_dirty, count);
+				return count;
+			}
+
+			bool addresses_valid(unsigned count) const noexcept
+			{
+				for (unsigned i = 0; i < count; ++i)
+					if (_storage->msgs[i].msg_hdr.msg_namelen != sizeof(Address))
+						return false;
+
+				return true;
+			}
+
+			std::unique_ptr<storage> _storage;
+			std::size_t _dirty;
+	};
+}
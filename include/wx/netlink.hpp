@@ -0,0 +1,130 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <w/netlink.hpp>
+#include <w/posix.hpp>
+
+#include <linux/netlink.h>
+#include <sys/socket.h>
+
+namespace wx
+{
+	/**
+	 * A non-blocking netlink socket which receives notifications in batches.
+	 *
+	 * @remarks Each call to drain() receives every pending datagram, up to a batch at a time per
+	 *          w::recvmmsg() call, into buffers allocated once at construction, and hands each
+	 *          message to a handler. A large socket receive buffer (see the constructor) makes
+	 *          it less likely that a burst of notifications overflows the socket, but if it does,
+	 *          the kernel drops notifications and reports `ENOBUFS`; this is recorded rather than
+	 *          thrown, and reported by overrun(), since the only sensible response is usually to
+	 *          resynchronize with a dump request.
+	 *
+	 *          Register fd() with an event loop (such as wx::event_loop) for `EPOLLIN`, and call
+	 *          drain() when it is readable. This class is not thread-safe.
+	 */
+	class netlink_socket
+	{
+		public:
+
+			/**
+			 * Opens a netlink socket and subscribes to multicast groups.
+			 *
+			 * @param protocol The netlink protocol, such as `NETLINK_ROUTE`.
+			 * @param groups A bitmask of the multicast groups to subscribe to, such as
+			 *        `RTMGRP_LINK | RTMGRP_IPV4_ROUTE`.
+			 * @param receive_buffer The socket receive buffer size to request, in bytes, or zero
+			 *        to keep the system default.
+			 * @param batch The maximum number of datagrams to receive per system call.
+			 * @param datagram_size The size of the buffer for each datagram, which bounds the
+			 *        messages which can be received (the kernel sends at most 8 KiB per datagram
+			 *        unless the page size is larger).
+			 * @throw std::system_error An error occurred.
+			 */
+			explicit netlink_socket(int protocol, std::uint32_t groups = 0,
+				int receive_buffer = 1 << 20, unsigned batch = 16, std::size_t datagram_size = 16384);
+
+			netlink_socket(const netlink_socket&) = delete;
+			netlink_socket& operator=(const netlink_socket&) = delete;
+
+			/**
+			 * Receives every pending datagram without blocking, and calls a handler with each
+			 * complete message in them.
+			 *
+			 * @tparam Handler A function object callable with a `const struct nlmsghdr&`.
+			 * @param handler The handler.
+			 * @return The number of messages handled.
+			 * @throw std::system_error An error other than an overrun occurred.
+			 */
+			template <typename Handler>
+			std::size_t drain(Handler&& handler)
+			{
+				std::size_t count = 0;
+
+				while (unsigned received = receive_batch())
+				{
+					for (unsigned i = 0; i < received; ++i)
+					{
+						for (const struct nlmsghdr& message : w::netlink_messages(datagram(i), _headers[i].msg_len))
+						{
+							handler(message);
+							++count;
+						}
+					}
+				}
+
+				return count;
+			}
+
+			/**
+			 * Sends a request to the kernel, such as an `RTM_GETLINK` dump request. The sequence
+			 * number of the request is assigned by this function.
+			 *
+			 * @param message The request, followed by its payload.
+			 * @return The sequence number assigned to the request, which is echoed by the
+			 *         replies.
+			 * @throw std::system_error An error occurred.
+			 */
+			std::uint32_t send(struct nlmsghdr& message);
+
+			/**
+			 * Tests whether notifications have been lost since the last call to this function,
+			 * and clears the indication.
+			 *
+			 * @return `true` if the socket receive buffer overflowed.
+			 */
+			bool overrun() noexcept { return std::exchange(_overrun, false); }
+
+			/**
+			 * Gets the socket file descriptor.
+			 *
+			 * @return The socket file descriptor.
+			 */
+			int fd() const noexcept { return _socket; }
+
+		private:
+
+			unsigned receive_batch();
+
+			const std::byte *datagram(unsigned i) const noexcept { return _buffers.get() + i * _datagram_size; }
+
+			w::fd _socket;
+			std::size_t _datagram_size;
+			std::unique_ptr<std::byte[]> _buffers;
+			std::vector<struct iovec> _iovecs;
+			std::vector<struct mmsghdr> _headers;
+			std::uint32_t _sequence;
+			bool _overrun;
+	};
+}
@@ -0,0 +1,260 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <w/iterators.hpp>
+#include <w/posix.hpp>
+
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+/// @cond
+namespace wx::detail
+{
+	inline bool valid_tpacket3_hdr(const struct tpacket3_hdr *cur, std::size_t remaining)
+	{
+		return remaining >= sizeof(struct tpacket3_hdr) &&
+			cur->tp_mac <= remaining &&
+			cur->tp_snaplen <= remaining - cur->tp_mac;
+	}
+
+	inline const struct tpacket3_hdr *get_next_tpacket3_hdr(const struct tpacket3_hdr *cur, std::size_t& remaining)
+	{
+		// The kernel sets the offset of the last frame in a block to zero, which ends the
+		// iteration just like reaching the end of the block.
+
+		std::size_t offset = cur->tp_next_offset;
+		if (!offset || offset > remaining)
+			offset = remaining;
+
+		remaining -= offset;
+		return reinterpret_cast<const struct tpacket3_hdr *>(reinterpret_cast<const std::byte *>(cur) + offset);
+	}
+}
+/// @endcond
+
+namespace wx
+{
+	/**
+	 * A range of the frames in a block of a wx::packet_ring.
+	 */
+	typedef w::const_sized_list<struct tpacket3_hdr, wx::detail::valid_tpacket3_hdr, wx::detail::get_next_tpacket3_hdr> packet_frame_list;
+
+	/**
+	 * Gets the frames in a block retired by the kernel.
+	 *
+	 * @param block A reference to the block descriptor at the start of the block.
+	 * @return A range of the frames, which is empty if the block timed out before any packet
+	 *         arrived.
+	 */
+	inline packet_frame_list packet_frames(const struct tpacket_block_desc& block) noexcept
+	{
+		const struct tpacket_hdr_v1& hdr = block.hdr.bh1;
+		auto base = reinterpret_cast<const std::byte *>(&block);
+
+		return {
+			reinterpret_cast<const struct tpacket3_hdr *>(base + hdr.offset_to_first_pkt),
+			hdr.blk_len > hdr.offset_to_first_pkt ? hdr.blk_len - hdr.offset_to_first_pkt : 0
+		};
+	}
+
+	/**
+	 * Gets the captured bytes of a frame, starting at its link-layer header.
+	 *
+	 * @param frame A reference to the frame header.
+	 * @return A span of the captured bytes, which may be fewer than the length of the packet
+	 *         on the wire (`tp_len`).
+	 */
+	inline std::span<const std::byte> packet_data(const struct tpacket3_hdr& frame) noexcept
+	{
+		return { reinterpret_cast<const std::byte *>(&frame) + frame.tp_mac, frame.tp_snaplen };
+	}
+
+	/**
+	 * A packet socket receiving into a `TPACKET_V3` ring shared with the kernel, so that packets
+	 * are captured without a system call or a copy per packet.
+	 *
+	 * @remarks The ring is an array of blocks, each of which the kernel fills with as many
+	 *          packets as fit and then retires to user space, either when it is full or when the
+	 *          retire timeout expires. next_block() returns the current block once it has been
+	 *          retired, its frames are visited in place with packet_frames(), and release() hands
+	 *          it back to the kernel. drain() does all three for a batch of blocks:
+	 *
+	 *              wx::packet_ring ring("eth0");
+	 *
+	 *              ring.drain([](const struct tpacket3_hdr& frame) {
+	 *                  process(wx::packet_data(frame));
+	 *              });
+	 *
+	 *          When no block is ready, the socket (fd()) becomes readable once one is, so it can
+	 *          be registered with an epoll instance (or wx::event_loop) for `EPOLLIN`.
+	 *
+	 *          To spread capture across the workers of a wx::executor, create one ring per
+	 *          worker on the same interface and have each join_fanout() the same group, in
+	 *          worker order. With the default `PACKET_FANOUT_CPU` mode, the kernel delivers each
+	 *          packet to the ring whose index is the number of the CPU receiving it (modulo the
+	 *          number of rings), so when worker @e i is pinned to CPU @e i each packet is handled
+	 *          on the CPU its interrupt arrived on. Each ring is then only used by its worker,
+	 *          through that worker's loop():
+	 *
+	 *              executor.post(i, [&executor, &ring = rings[i], i] {
+	 *                  executor.loop(i).add(ring.fd(), EPOLLIN, [&ring](std::uint32_t) {
+	 *                      ring.drain(process);
+	 *                  });
+	 *              });
+	 *
+	 *          Opening a packet socket requires the `CAP_NET_RAW` capability.
+	 */
+	class packet_ring
+	{
+		public:
+
+			/**
+			 * Creates a packet socket, sets up and maps its receive ring, and binds it.
+			 *
+			 * @param interface The name of the interface to capture from, or `nullptr` or an
+			 *        empty string to capture from all interfaces.
+			 * @param block_size The size of each block, in bytes, which is rounded up to a
+			 *        multiple of the page size. A block must be large enough for the largest
+			 *        packet.
+			 * @param block_count The number of blocks in the ring.
+			 * @param retire_timeout The time after which the kernel retires a block which is not
+			 *        yet full, or zero to let the kernel derive it from the link speed.
+			 * @param protocol The link-layer protocol to capture, in host byte order (e.g.
+			 *        `ETH_P_IP`, or `ETH_P_ALL` for everything).
+			 * @throw std::invalid_argument @p block_size or @p block_count is zero or too large.
+			 * @throw std::system_error An error occurred (e.g. the interface does not exist, or
+			 *        the process lacks `CAP_NET_RAW`).
+			 */
+			explicit packet_ring(const char *interface, std::size_t block_size = 1 << 22,
+				std::size_t block_count = 64,
+				std::chrono::milliseconds retire_timeout = std::chrono::milliseconds(60),
+				int protocol = ETH_P_ALL);
+
+			/**
+			 * Joins a fanout group, which spreads the packets received by the interface between
+			 * the sockets in the group instead of delivering each to all of them.
+			 *
+			 * @param group The ID of the group, which is shared by all sockets of the group in
+			 *        the network namespace.
+			 * @param mode The way the kernel picks a socket for each packet (e.g.
+			 *        `PACKET_FANOUT_CPU`, `PACKET_FANOUT_HASH` or `PACKET_FANOUT_QM`), optionally
+			 *        combined with flags such as `PACKET_FANOUT_FLAG_DEFRAG`.
+			 * @throw std::system_error An error occurred (e.g. the group exists with another
+			 *        mode).
+			 */
+			void join_fanout(std::uint16_t group, std::uint16_t mode = PACKET_FANOUT_CPU);
+
+			/**
+			 * Gets the current block if the kernel has retired it.
+			 *
+			 * @return A pointer to the block descriptor at the start of the block, or `nullptr`
+			 *         if the kernel is still filling it. The block stays valid until release().
+			 */
+			const struct tpacket_block_desc *next_block() const noexcept
+			{
+				auto block = reinterpret_cast<struct tpacket_block_desc *>(_base + _current * _block_size);
+
+				if (!(std::atomic_ref(block->hdr.bh1.block_status).load(std::memory_order_acquire) & TP_STATUS_USER))
+					return nullptr;
+
+				return block;
+			}
+
+			/**
+			 * Returns the current block to the kernel and moves on to the next one. The behavior
+			 * is undefined unless next_block() returned the current block.
+			 */
+			void release() noexcept
+			{
+				auto block = reinterpret_cast<struct tpacket_block_desc *>(_base + _current * _block_size);
+				std::atomic_ref(block->hdr.bh1.block_status).store(TP_STATUS_KERNEL, std::memory_order_release);
+
+				if (++_current == _block_count)
+					_current = 0;
+			}
+
+			/**
+			 * Visits the frames of up to @p max retired blocks, releasing each block after its
+			 * frames have been visited.
+			 *
+			 * @tparam F The type of @p f.
+			 * @param f A callable to invoke with each frame, as a `const struct tpacket3_hdr&`.
+			 * @param max The maximum number of blocks to visit.
+			 * @return The number of frames visited.
+			 * @throw ... Any exception thrown by @p f is propagated, and the block being visited
+			 *        is not released, so that its frames are visited again by the next call.
+			 */
+			template <typename F>
+			std::size_t drain(F&& f, std::size_t max = static_cast<std::size_t>(-1))
+			{
+				std::size_t count = 0;
+
+				for (std::size_t i = 0; i < max; ++i)
+				{
+					const struct tpacket_block_desc *block = next_block();
+					if (!block)
+						break;
+
+					for (const struct tpacket3_hdr& frame : wx::packet_frames(*block))
+					{
+						f(frame);
+						++count;
+					}
+
+					release();
+				}
+
+				return count;
+			}
+
+			/**
+			 * Gets the packet counters of the socket, and resets them.
+			 *
+			 * @return The numbers of packets received and dropped, and of times the ring was
+			 *         full, since the last call.
+			 * @throw std::system_error An error occurred.
+			 */
+			struct tpacket_stats_v3 statistics();
+
+			/**
+			 * Gets the packet socket.
+			 *
+			 * @return The socket file descriptor.
+			 */
+			int fd() const noexcept { return _socket; }
+
+			/**
+			 * Gets the size of each block.
+			 *
+			 * @return The size of each block, in bytes.
+			 */
+			std::size_t block_size() const noexcept { return _block_size; }
+
+			/**
+			 * Gets the number of blocks in the ring.
+			 *
+			 * @return The number of blocks.
+			 */
+			std::size_t block_count() const noexcept { return _block_count; }
+
+		private:
+
+			w::fd _socket;
+			w::mmap_handle _mapping;
+			std::byte *_base;
+			std::size_t _block_size;
+			std::size_t _block_count;
+			std::size_t _current;
+	};
+}
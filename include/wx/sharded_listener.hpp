@@ -0,0 +1,144 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <w/posix.hpp>
+#include <w/sockets.hpp>
+
+#include <sys/socket.h>
+
+namespace wx
+{
+	/**
+	 * A set of listening TCP sockets bound to the same address with `SO_REUSEPORT`, one per
+	 * worker thread (a "shard"), so that the kernel distributes incoming connections between
+	 * separate accept queues instead of having every worker contend on one.
+	 *
+	 * @remarks Each listening socket is non-blocking, and is intended to be registered with the
+	 *          epoll instance (or wx::event_loop) of the worker owning the shard. On readiness,
+	 *          drain() accepts a batch of connections with `accept4()`, so that new sockets are
+	 *          created non-blocking and close-on-exec without extra system calls.
+	 *
+	 *          By default, the kernel picks a shard by hashing each connection's addresses and
+	 *          ports. steer_by_cpu() replaces this with a program selecting the shard whose index
+	 *          is the number of the CPU handling the incoming packet (modulo the number of
+	 *          shards), which keeps each connection on one CPU when worker @e i is pinned to
+	 *          CPU @e i and receive interrupts are spread across the same CPUs.
+	 */
+	class sharded_listener
+	{
+		public:
+
+			/**
+			 * Creates, binds and listens on one socket per shard.
+			 *
+			 * @param addr A pointer to the address to listen on. If its port is zero, an
+			 *        ephemeral port is chosen by the kernel and shared by all shards.
+			 * @param addrlen The size of the structure pointed to by @p addr, in bytes.
+			 * @param shards The number of shards, which must be nonzero.
+			 * @param backlog The maximum length of each shard's accept queue.
+			 * @throw std::invalid_argument @p shards is zero, or the address family of @p addr
+			 *        is not `AF_INET` or `AF_INET6`.
+			 * @throw std::system_error An error occurred.
+			 */
+			sharded_listener(const struct sockaddr *addr, socklen_t addrlen, std::size_t shards,
+				int backlog = SOMAXCONN);
+
+			/**
+			 * Creates, binds and listens on one socket per shard.
+			 *
+			 * @tparam Address The type of @p addr (e.g. w::ipv4_address or w::ipv6_address).
+			 * @param addr A reference to the address to listen on. If its port is zero, an
+			 *        ephemeral port is chosen by the kernel and shared by all shards.
+			 * @param shards The number of shards, which must be nonzero.
+			 * @param backlog The maximum length of each shard's accept queue.
+			 * @throw std::invalid_argument @p shards is zero, or the address family of @p addr
+			 *        is not `AF_INET` or `AF_INET6`.
+			 * @throw std::system_error An error occurred.
+			 */
+			template <typename Address>
+			sharded_listener(const Address& addr, std::size_t shards, int backlog = SOMAXCONN)
+				: sharded_listener(reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr),
+					shards, backlog)
+			{
+			}
+
+			/**
+			 * Attaches a classic BPF program to the group of sockets which steers each incoming
+			 * connection to the shard matching the current CPU number, modulo the number of
+			 * shards.
+			 *
+			 * @throw std::system_error An error occurred (e.g. the kernel predates Linux 4.5).
+			 */
+			void steer_by_cpu();
+
+			/**
+			 * Accepts up to @p max pending connections on a shard without blocking.
+			 *
+			 * @tparam F The type of @p f.
+			 * @param shard The index of the shard to accept on.
+			 * @param f A callable to invoke with each accepted socket, as a `w::fd&&`.
+			 * @param max The maximum number of connections to accept.
+			 * @param flags The flags to pass to `accept4()` for the new sockets.
+			 * @return The number of connections accepted.
+			 * @throw std::system_error An error occurred.
+			 * @throw ... Any exception thrown by @p f is propagated.
+			 */
+			template <typename F>
+			std::size_t drain(std::size_t shard, F&& f, std::size_t max = 64,
+				int flags = SOCK_NONBLOCK | SOCK_CLOEXEC)
+			{
+				std::size_t count = 0;
+				int listener = _sockets[shard];
+
+				while (count < max)
+				{
+					std::error_code ec;
+					w::fd fd = w::accept4(listener, nullptr, nullptr, flags, ec);
+
+					// Connections reset while still in the accept queue are reported as
+					// ECONNABORTED, and merely need skipping.
+
+					if (w::would_block(ec))
+						break;
+					else if (ec == std::errc::connection_aborted || ec == std::errc::interrupted)
+						continue;
+					else if (ec)
+						throw std::system_error(ec, "failed to accept connection on socket");
+
+					++count;
+					f(std::move(fd));
+				}
+
+				return count;
+			}
+
+			/**
+			 * Gets the number of shards.
+			 *
+			 * @return The number of shards.
+			 */
+			std::size_t size() const noexcept { return _sockets.size(); }
+
+			/**
+			 * Gets the listening socket of a shard.
+			 *
+			 * @param shard The index of the shard.
+			 * @return The listening socket file descriptor.
+			 */
+			int fd(std::size_t shard) const noexcept { return _sockets[shard]; }
+
+		private:
+
+			std::vector<w::fd> _sockets;
+	};
+}
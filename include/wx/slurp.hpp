@@ -9,48 +9,94 @@
 #include <filesystem>
 #include <string>
 #include <string_view>
+#include <vector>
+
+#include <w/posix.hpp>
 
 namespace wx
 {
+    /**
+     * Reads the contents of a file into a caller-supplied string, reusing its storage.
+     *
+     * @remarks This function attempts to minimize allocations and copies. For regular files, the
+     *          size is obtained up front so that the contents are read with a single allocation
+     *          and as few `read()` calls as possible. The size of other files need not be known
+     *          in advance, so this function also supports streamed files such as `sysfs` entries
+     *          and pipes, which are read into a buffer that grows as needed. In both cases the
+     *          existing capacity of @p contents is used first, so reading files of similar size
+     *          repeatedly into the same string does not allocate.
+     *
+     * @param path The path of the file to read.
+     * @param contents The string to replace with the contents of the file.
+     * @throw std::system_error The file cannot be opened or a read error occurred.
+     *
+     * @see slurp()
+     */
+    void read_file_as_string(const char *path, std::string& contents);
+
+    /**
+     * @copydoc read_file_as_string(const char *, std::string&)
+     */
+    inline void read_file_as_string(const std::string& path, std::string& contents) { read_file_as_string(path.c_str(), contents); }
+
     /**
      * Reads the contents of a file as a string.
      *
-     * @remarks This function attempts to minimize allocations and copies. It reads directly into
-     *          a std::string buffer which is dynamically resized as needed. The size of the file
-     *          need not be known in advance, so this function supports streamed files such as
-     *          `sysfs` entries and pipes.
+     * @remarks See read_file_as_string(const char *, std::string&) for details.
      *
      * @param path The path of the file to read.
      * @return The contents of the file as a string.
-     * @throw std::ios_base::failure The file cannot be opened or a read error occurred.
+     * @throw std::system_error The file cannot be opened or a read error occurred.
      *
      * @see slurp()
      */
     std::string read_file_as_string(const char *path);
 
     /**
-     * @copydoc read_file_as_string
+     * @copydoc read_file_as_string(const char *)
      */
     inline std::string read_file_as_string(const std::string& path) { return read_file_as_string(path.c_str()); }
 
+    /**
+     * Reads the contents of a file into a caller-supplied string, reusing its storage, and
+     * removes trailing whitespace.
+     *
+     * @param path The path of the file to read.
+     * @param contents The string to replace with the contents of the file.
+     * @throw std::system_error The file cannot be opened or a read error occurred.
+     *
+     * @see read_file_as_string()
+     */
+    void slurp(const char *path, std::string& contents);
+
+    /**
+     * @copydoc slurp(const char *, std::string&)
+     */
+    inline void slurp(const std::string& path, std::string& contents) { slurp(path.c_str(), contents); }
+
+    /**
+     * @copydoc slurp(const char *, std::string&)
+     */
+    inline void slurp(const std::filesystem::path& path, std::string& contents) { slurp(path.c_str(), contents); }
+
     /**
      * Reads the contents of a file as a string with trailing whitespace removed.
      *
      * @param path The path of the file to read.
      * @return The contents of the file as a string.
-     * @throw std::ios_base::failure The file cannot be opened or a read error occurred.
+     * @throw std::system_error The file cannot be opened or a read error occurred.
      *
      * @see read_file_as_string()
      */
     std::string slurp(const char *path);
 
     /**
-     * @copydoc slurp
+     * @copydoc slurp(const char *)
      */
     inline std::string slurp(const std::string& path) { return slurp(path.c_str()); }
 
     /**
-     * @copydoc slurp
+     * @copydoc slurp(const char *)
      */
     inline std::string slurp(const std::filesystem::path& path) { return slurp(path.c_str()); }
 
@@ -72,4 +118,131 @@ namespace wx
      * @copydoc spew
      */
     inline void spew(const std::filesystem::path& path, std::string_view str) { return spew(path.c_str(), str); }
+
+    /**
+     * Atomically replaces the contents of a file with a string, so that readers see either the
+     * old or the new contents, never a partially written file.
+     *
+     * @remarks The string is written to an unnamed `O_TMPFILE` in the directory of @p path
+     *          (or, on filesystems which do not support it, to a uniquely named file beside
+     *          @p path), preallocated with `fallocate()` and written with large `write()` calls.
+     *          The file is then linked into place or, if @p path exists, linked under a
+     *          temporary name and renamed over it. The new file is created with mode 0666, less
+     *          the umask; the mode and ownership of a replaced file are not preserved.
+     *
+     *          Without @p sync, the replacement is atomic with respect to other processes but
+     *          not to a system crash, after which @p path may hold the old contents, the new
+     *          contents or, on some filesystems, an empty file. With @p sync, the data is flushed
+     *          with `fdatasync()` before the file is put in place, and the directory is flushed
+     *          with `fsync()` after. To replace many files, wx::spew_batch is faster.
+     *
+     * @param path The path of the file to replace or create.
+     * @param str The new contents of the file.
+     * @param sync Whether to flush the new contents and the directory to the storage device
+     *        before returning.
+     * @throw std::system_error An error occurred. @p path is left unchanged.
+     */
+    void spew_atomic(const char *path, std::string_view str, bool sync = false);
+
+    /**
+     * @copydoc spew_atomic
+     */
+    inline void spew_atomic(const std::string& path, std::string_view str, bool sync = false) { spew_atomic(path.c_str(), str, sync); }
+
+    /**
+     * @copydoc spew_atomic
+     */
+    inline void spew_atomic(const std::filesystem::path& path, std::string_view str, bool sync = false) { spew_atomic(path.c_str(), str, sync); }
+
+    /**
+     * Replaces the contents of a set of files durably, flushing them with one `syncfs()` per
+     * filesystem instead of one `fdatasync()` per file, as for checkpointing a snapshot.
+     *
+     * @remarks Each add() writes a file as wx::spew_atomic() does, but leaves it unnamed (or
+     *          under its temporary name) with its file descriptor held open. commit() then
+     *          flushes each filesystem involved, puts every file in place, and flushes each
+     *          filesystem again to make the new names durable. Each file is replaced atomically,
+     *          but the set as a whole is not: if commit() throws, the files before the failing
+     *          one have been replaced. Files which have been added but not committed are
+     *          discarded when the batch is destroyed.
+     *
+     *          Since a file descriptor is held for each uncommitted file, very large batches
+     *          should be committed in parts to stay within `RLIMIT_NOFILE`.
+     */
+    class spew_batch
+    {
+        public:
+
+            /**
+             * Constructs an empty batch.
+             */
+            spew_batch() noexcept = default;
+
+            spew_batch(const spew_batch&) = delete;
+            spew_batch(spew_batch&&) noexcept = default;
+            spew_batch& operator=(const spew_batch&) = delete;
+
+            /**
+             * Discards any files which have been added but not committed.
+             *
+             * @param other The batch to move from.
+             * @return A reference to this batch.
+             */
+            spew_batch& operator=(spew_batch&& other) noexcept;
+
+            /**
+             * Discards any files which have been added but not committed.
+             */
+            ~spew_batch();
+
+            /**
+             * Writes the new contents of a file, to be put in place by commit().
+             *
+             * @param path The path of the file to replace or create.
+             * @param str The new contents of the file.
+             * @throw std::system_error An error occurred.
+             */
+            void add(const char *path, std::string_view str);
+
+            /**
+             * @copydoc add
+             */
+            void add(const std::string& path, std::string_view str) { add(path.c_str(), str); }
+
+            /**
+             * @copydoc add
+             */
+            void add(const std::filesystem::path& path, std::string_view str) { add(path.c_str(), str); }
+
+            /**
+             * Durably replaces the files which have been added, and empties the batch.
+             *
+             * @throw std::system_error An error occurred. The files which have not been put in
+             *        place yet remain in the batch.
+             */
+            void commit();
+
+            /**
+             * Discards the files which have been added but not committed.
+             */
+            void clear() noexcept;
+
+            /**
+             * Gets the number of files which have been added but not committed.
+             *
+             * @return The number of files.
+             */
+            std::size_t size() const noexcept { return _files.size(); }
+
+        private:
+
+            struct staged_file
+            {
+                w::fd file;
+                std::string path;
+                std::string temp;
+            };
+
+            std::vector<staged_file> _files;
+    };
 }
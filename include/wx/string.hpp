@@ -7,19 +7,142 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
 #include <cctype>
-#include <cerrno>
-#include <cstdlib>
+#include <charconv>
+#include <cstddef>
 #include <limits>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <type_traits>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace wx
 {
+    /// @cond
+    namespace detail
+    {
+        constexpr bool is_space(char ch) noexcept
+        {
+            return ch == ' ' || (ch >= '\t' && ch <= '\r');
+        }
+
+        // Removes the leading whitespace and sign accepted by strtol() and strtod(), neither of
+        // which std::from_chars() accepts, and returns whether the sign was negative.
+        inline bool strip_sign(std::string_view& str) noexcept
+        {
+            std::size_t i = 0;
+            while (i < str.size() && is_space(str[i]))
+                ++i;
+
+            bool negative = i < str.size() && str[i] == '-';
+            if (i < str.size() && (str[i] == '+' || str[i] == '-'))
+                ++i;
+
+            str.remove_prefix(i);
+            return negative;
+        }
+
+        constexpr bool has_hex_prefix(std::string_view str) noexcept
+        {
+            return str.size() >= 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X');
+        }
+
+        // Converts a magnitude without sign or prefix, with the same checks as number().
+        template <typename T>
+        T parse_integer(std::string_view digits, bool negative, int base)
+        {
+            typedef std::make_unsigned_t<T> U;
+
+            if (base < 2 || base > 36)
+                throw std::runtime_error("invalid numeric string");
+
+            U magnitude = 0;
+            const char *last = digits.data() + digits.size();
+            auto [ptr, ec] = std::from_chars(digits.data(), last, magnitude, base);
+
+            if (ec == std::errc::invalid_argument || ptr != last)
+                throw std::runtime_error("invalid numeric string");
+            else if (ec == std::errc::result_out_of_range)
+                throw std::range_error("number is out of range");
+
+            if constexpr (std::is_signed_v<T>)
+            {
+                constexpr U limit = static_cast<U>(std::numeric_limits<T>::max());
+
+                if (magnitude > limit + (negative ? 1 : 0))
+                    throw std::range_error("number is out of range");
+
+                return negative ? static_cast<T>(U(0) - magnitude) : static_cast<T>(magnitude);
+            }
+            else
+            {
+                if (negative && magnitude)
+                    throw std::range_error("number is out of range");
+
+                return magnitude;
+            }
+        }
+
+        // Gets the length of the run of bytes at the start of [first, last) which are decimal
+        // digits (or whitespace), classifying 16 bytes at a time where SSE2 is available.
+        template <bool Space>
+        std::size_t run_length(const char *first, const char *last) noexcept
+        {
+            const char *p = first;
+
+#if defined(__SSE2__)
+            while (last - p >= 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                __m128i match;
+
+                if constexpr (Space)
+                    match = _mm_or_si128(
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                        _mm_and_si128(
+                            _mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+                            _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1))));
+                else
+                    match = _mm_and_si128(
+                        _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+
+                auto mask = static_cast<unsigned>(_mm_movemask_epi8(match));
+                if (mask != 0xffff)
+                    return static_cast<std::size_t>(p - first) + static_cast<std::size_t>(std::countr_one(mask));
+
+                p += 16;
+            }
+#endif
+
+            if constexpr (Space)
+                while (p != last && is_space(*p))
+                    ++p;
+            else
+                while (p != last && *p >= '0' && *p <= '9')
+                    ++p;
+
+            return static_cast<std::size_t>(p - first);
+        }
+    }
+    /// @endcond
+
     /**
      * Parses a string as a numeric value with strict formatting and range checks.
      *
+     * @remarks As with `strtol()`, leading whitespace and a sign are accepted, and a base of 16
+     *          accepts a `0x` prefix; a base of zero selects base 16 for a `0x` prefix, base 8
+     *          for a leading zero, and base 10 otherwise. The whole of the remaining string must
+     *          be a valid number. The conversion uses `std::from_chars()`, so it neither depends
+     *          on the locale nor touches `errno`, and never allocates.
+     *
      * @tparam T The numeric type to convert to.
      * @param str The string to convert.
      * @param base The numeric base.
@@ -28,41 +151,49 @@ namespace wx
      * @throw std::runtime_error The string is invalid.
      */
     template <typename T>
-    typename std::enable_if<std::is_integral_v<T> && std::is_unsigned_v<T>, T>::type
-    number(const char *str, int base = 10)
+    typename std::enable_if<std::is_integral_v<T>, T>::type
+    number(std::string_view str, int base = 10)
     {
-        char *end;
-        errno = 0;
-        unsigned long long l = std::strtoull(str, &end, base);
-        if (end == str || *end)
-            throw std::runtime_error("invalid numeric string");
-        else if (l > std::numeric_limits<T>::max() || (l == std::numeric_limits<unsigned long long>::max() && errno == ERANGE))
-            throw std::range_error("number is out of range");
-        return l;
+        bool negative = detail::strip_sign(str);
+
+        if ((base == 0 || base == 16) && detail::has_hex_prefix(str))
+        {
+            str.remove_prefix(2);
+            base = 16;
+        }
+        else if (base == 0)
+            base = str.size() > 1 && str[0] == '0' ? 8 : 10;
+
+        return detail::parse_integer<T>(str, negative, base);
     }
 
     /**
      * @copydoc number
      */
     template <typename T>
-    typename std::enable_if<std::is_integral_v<T> && std::is_signed_v<T>, T>::type
+    typename std::enable_if<std::is_integral_v<T>, T>::type
     number(const char *str, int base = 10)
     {
-        char *end;
-        errno = 0;
-        long long l = std::strtoll(str, &end, base);
-        if (end == str || *end)
-            throw std::runtime_error("invalid numeric string");
-        else if (l > std::numeric_limits<T>::max() || (l == std::numeric_limits<long long>::max() && errno == ERANGE))
-            throw std::range_error("number is out of range");
-        else if (l < std::numeric_limits<T>::min() || (l == std::numeric_limits<long long>::min() && errno == ERANGE))
-            throw std::range_error("number is out of range");
-        return l;
+        return number<T>(std::string_view(str), base);
+    }
+
+    /**
+     * @copydoc number
+     */
+    template <typename T>
+    typename std::enable_if<std::is_integral_v<T>, T>::type
+    number(const std::string& str, int base = 10)
+    {
+        return number<T>(std::string_view(str), base);
     }
 
     /**
      * Parses a string as a numeric value with strict formatting and range checks.
      *
+     * @remarks As with `strtod()`, leading whitespace and a sign are accepted, as are
+     *          hexadecimal (`0x`-prefixed) numbers, infinities and NaNs. The conversion uses
+     *          `std::from_chars()`, so the decimal point is always `.` regardless of the locale.
+     *
      * @tparam T The numeric type to convert to.
      * @param str The string to convert.
      * @return The parsed value.
@@ -71,42 +202,98 @@ namespace wx
      */
     template <typename T>
     typename std::enable_if<std::is_floating_point_v<T>, T>::type
-    number(const char *str)
+    number(std::string_view str)
     {
-        char *end;
-        errno = 0;
-        double d = std::strtod(str, &end);
-        if (end == str || *end)
+        bool negative = detail::strip_sign(str);
+        auto format = std::chars_format::general;
+
+        if (detail::has_hex_prefix(str))
+        {
+            str.remove_prefix(2);
+            format = std::chars_format::hex;
+        }
+
+        // std::from_chars() accepts a minus sign of its own, which must not follow ours.
+        if (!str.empty() && str[0] == '-')
+            throw std::runtime_error("invalid numeric string");
+
+        T value = 0;
+        const char *last = str.data() + str.size();
+        auto [ptr, ec] = std::from_chars(str.data(), last, value, format);
+
+        if (ec == std::errc::invalid_argument || ptr != last)
             throw std::runtime_error("invalid numeric string");
-        else if (errno == ERANGE)
+        else if (ec == std::errc::result_out_of_range)
             throw std::range_error("number is out of range");
-        return d;
+
+        return negative ? -value : value;
     }
 
     /**
-     * @copydoc number
+     * @copydoc number(std::string_view)
      */
     template <typename T>
-    typename std::enable_if<std::is_integral_v<T>, T>::type
-    number(const std::string& str, int base = 10)
+    typename std::enable_if<std::is_floating_point_v<T>, T>::type
+    number(const char *str)
     {
-        return number<T>(str.c_str(), base);
+        return number<T>(std::string_view(str));
     }
 
     /**
-     * Parses a string as a numeric value with strict formatting and range checks.
-     *
-     * @tparam T The numeric type to convert to.
-     * @param str The string to convert.
-     * @return The parsed value.
-     * @throw std::range_error The string is valid but the number is out of range.
-     * @throw std::runtime_error The string is invalid.
+     * @copydoc number(std::string_view)
      */
     template <typename T>
     typename std::enable_if<std::is_floating_point_v<T>, T>::type
     number(const std::string& str)
     {
-        return number<T>(str.c_str());
+        return number<T>(std::string_view(str));
+    }
+
+    /**
+     * Parses a run of whitespace-separated decimal integers, such as a row of a procfs table.
+     *
+     * @remarks Each integer may have a sign, and is checked as by number(). Whitespace and digits
+     *          are classified 16 bytes at a time where SSE2 is available, and nothing is
+     *          allocated.
+     *
+     * @tparam T The integral type to convert to.
+     * @param str The string to parse.
+     * @param out The span to store the parsed integers in. Parsing stops once it is full, and
+     *        anything after the last integer stored is ignored.
+     * @return The number of integers stored in @p out.
+     * @throw std::range_error An integer is out of range.
+     * @throw std::runtime_error The string contains something other than integers and
+     *        whitespace.
+     */
+    template <typename T>
+    typename std::enable_if<std::is_integral_v<T>, std::size_t>::type
+    parse_integers(std::string_view str, std::span<T> out)
+    {
+        const char *p = str.data();
+        const char *last = p + str.size();
+        std::size_t count = 0;
+
+        while (count < out.size())
+        {
+            p += detail::run_length<true>(p, last);
+            if (p == last)
+                break;
+
+            bool negative = *p == '-';
+            if (*p == '+' || *p == '-')
+                ++p;
+
+            const char *digits = p;
+            p += detail::run_length<false>(p, last);
+
+            if (p != last && !detail::is_space(*p))
+                throw std::runtime_error("invalid numeric string");
+
+            out[count++] = detail::parse_integer<T>(
+                std::string_view(digits, static_cast<std::size_t>(p - digits)), negative, 10);
+        }
+
+        return count;
     }
 
     /**
@@ -126,4 +313,20 @@ namespace wx
 
         return str;
     }
+
+    /**
+     * Removes trailing whitespace from a string view.
+     *
+     * @param str The string view from which to remove trailing whitespace.
+     * @return A view of @p str without its trailing whitespace.
+     */
+    static inline std::string_view rtrim(std::string_view str) noexcept
+    {
+        auto from = std::find_if(
+            str.rbegin(),
+            str.rend(),
+            [](unsigned char ch) { return !std::isspace(ch) && ch != '\0'; });
+
+        return str.substr(0, str.rend() - from);
+    }
 }
@@ -0,0 +1,180 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <w/posix.hpp>
+
+#include <time.h>
+
+namespace wx
+{
+	/**
+	 * A hierarchical timer wheel which multiplexes any number of timers onto a single timer file
+	 * descriptor.
+	 *
+	 * @remarks Time is divided into ticks of a fixed resolution. Timers are kept in 8 levels of 64
+	 *          slots each, where level @e n holds timers expiring within 64^(n+1) ticks, and are
+	 *          moved down a level at a time as their expiration approaches. Scheduling, cancelling
+	 *          and rescheduling a timer are O(1), and timer nodes come from a pool which grows as
+	 *          needed but never shrinks, so a steady state performs no allocations. Timers never
+	 *          expire early, but may expire up to one tick (plus the slack) late.
+	 *
+	 *          The timer file descriptor is only reprogrammed when the earliest deadline moves
+	 *          earlier, or after timers have been processed; cancelling a timer leaves it
+	 *          programmed, which at worst causes one spurious wakeup. To use the wheel with
+	 *          wx::event_loop, register fd() for `EPOLLIN` and call expire() when it is ready.
+	 *
+	 *          This class is not thread-safe.
+	 */
+	class timer_wheel
+	{
+		public:
+
+			/**
+			 * The type of a timer identifier. Identifiers are never reused, and zero is never a
+			 * valid identifier.
+			 */
+			typedef std::uint64_t timer_id;
+
+			/**
+			 * The type of the callback invoked when a timer expires. The arguments are the
+			 * identifier of the timer, which is no longer valid, and its user data.
+			 */
+			typedef std::function<void(timer_id id, void *user_data)> handler;
+
+			/**
+			 * Constructs a timer wheel.
+			 *
+			 * @param on_expire The callback to invoke for each expired timer.
+			 * @param resolution The duration of a tick, which must be positive.
+			 * @param slack The amount by which expirations may be rounded up so that nearby
+			 *        expirations are handled in a single wakeup, or zero for none.
+			 * @param clockid The identifier of the clock on which timers are based.
+			 * @throw std::invalid_argument @p resolution is not positive.
+			 * @throw std::system_error An error occurred creating the timer file descriptor.
+			 */
+			explicit timer_wheel(handler on_expire,
+				std::chrono::nanoseconds resolution = std::chrono::milliseconds(1),
+				std::chrono::nanoseconds slack = std::chrono::nanoseconds(0),
+				int clockid = CLOCK_MONOTONIC);
+
+			timer_wheel(const timer_wheel&) = delete;
+			timer_wheel& operator=(const timer_wheel&) = delete;
+
+			/**
+			 * Schedules a timer.
+			 *
+			 * @param timeout The time from now until the timer expires.
+			 * @param user_data A value to pass to the callback.
+			 * @return The identifier of the new timer.
+			 * @throw std::system_error An error occurred reprogramming the timer file
+			 *        descriptor.
+			 */
+			timer_id schedule(std::chrono::nanoseconds timeout, void *user_data = nullptr);
+
+			/**
+			 * Changes the expiration of a pending timer.
+			 *
+			 * @param id The identifier of the timer.
+			 * @param timeout The time from now until the timer expires.
+			 * @return `true` if the timer was rescheduled, or `false` if it has already expired
+			 *         or been cancelled.
+			 * @throw std::system_error An error occurred reprogramming the timer file
+			 *        descriptor.
+			 */
+			bool reschedule(timer_id id, std::chrono::nanoseconds timeout);
+
+			/**
+			 * Cancels a pending timer.
+			 *
+			 * @param id The identifier of the timer.
+			 * @return `true` if the timer was cancelled, or `false` if it has already expired or
+			 *         been cancelled.
+			 */
+			bool cancel(timer_id id) noexcept;
+
+			/**
+			 * Invokes the callback for every timer which has expired, and reprograms the timer
+			 * file descriptor for the next one. Callbacks may schedule, reschedule and cancel
+			 * timers.
+			 *
+			 * @return The number of timers which expired.
+			 * @throw std::system_error An error occurred.
+			 * @throw ... Any exception thrown by the callback is propagated. Timers which were
+			 *        due but not yet processed remain pending, and are processed by the next
+			 *        call.
+			 */
+			std::size_t expire();
+
+			/**
+			 * Gets the number of pending timers.
+			 *
+			 * @return The number of pending timers.
+			 */
+			std::size_t size() const noexcept { return _size; }
+
+			/**
+			 * Gets the timer file descriptor, which becomes readable when timers may have
+			 * expired.
+			 *
+			 * @return The timer file descriptor.
+			 */
+			int fd() const noexcept { return _timer; }
+
+		private:
+
+			static constexpr unsigned level_bits = 6;
+			static constexpr unsigned slots_per_level = 1u << level_bits;
+			static constexpr unsigned levels = 8;
+			static constexpr std::uint32_t nil = std::numeric_limits<std::uint32_t>::max();
+
+			// The list of due timers is kept as an extra slot after those of the wheel, so that
+			// callbacks can cancel due timers like any other.
+			static constexpr std::uint32_t due_slot = levels * slots_per_level;
+
+			struct node
+			{
+				std::uint64_t expires;
+				void *user_data;
+				std::uint32_t next;
+				std::uint32_t prev;
+				std::uint32_t generation;
+				std::uint32_t slot;
+			};
+
+			std::uint64_t now_ticks() const;
+			std::uint64_t deadline(std::chrono::nanoseconds timeout) const;
+			node *find(timer_id id) noexcept;
+			void link(std::uint32_t index, std::uint32_t slot) noexcept;
+			void unlink(std::uint32_t index) noexcept;
+			void place(std::uint32_t index) noexcept;
+			void collect(std::uint64_t now) noexcept;
+			std::uint64_t next_wakeup() const noexcept;
+			void arm(std::uint64_t tick);
+
+			handler _on_expire;
+			int _clockid;
+			std::int64_t _resolution;
+			std::uint64_t _slack;
+			std::int64_t _epoch;
+			std::uint64_t _now;
+			std::uint64_t _armed;
+			std::size_t _size;
+			w::fd _timer;
+			std::vector<node> _nodes;
+			std::uint32_t _free;
+			std::uint32_t _heads[due_slot + 1];
+			std::uint64_t _occupied[levels];
+	};
+}
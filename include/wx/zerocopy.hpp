@@ -0,0 +1,149 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace wx
+{
+	/**
+	 * Sends data on a socket with `MSG_ZEROCOPY` and tracks the completion notifications which
+	 * tell when the sent buffers may be reused.
+	 *
+	 * @remarks Every successful zero-copy send is assigned a sequential 32-bit identifier, which
+	 *          can be obtained with next_id() just before the send. The buffer passed to a send
+	 *          must not be modified or freed until reap() reports a range containing its
+	 *          identifier.
+	 *
+	 *          Completions are queued on the socket's error queue, which is signalled by
+	 *          `EPOLLERR`. With the event loop extension, reap() can therefore be called from the
+	 *          socket's callback whenever `EPOLLERR` is reported (`EPOLLERR` is always reported by
+	 *          epoll, without being requested):
+	 *
+	 *          @code
+	 *          loop.add(sockfd, EPOLLOUT, [&](std::uint32_t events)
+	 *          {
+	 *              if (events & EPOLLERR)
+	 *                  sender.reap(on_complete);
+	 *              ...
+	 *          });
+	 *          @endcode
+	 *
+	 *          Zero-copy transmission only pays off for large sends (typically 10 KB or more);
+	 *          the kernel may also fall back to copying (for example over loopback), which is
+	 *          reported to the completion callback.
+	 */
+	class zerocopy_sender
+	{
+		public:
+
+			/**
+			 * The type of a callback invoked for each completed range of sends. The arguments
+			 * are the first and last (inclusive) identifiers of the range, and whether the kernel
+			 * copied the data instead of sending it in place.
+			 */
+			typedef std::function<void(std::uint32_t first, std::uint32_t last, bool copied)> completion_callback;
+
+			/**
+			 * Enables zero-copy transmission on a socket.
+			 *
+			 * @param sockfd The socket, which remains owned by the caller.
+			 * @throw std::system_error An error occurred enabling `SO_ZEROCOPY`.
+			 */
+			explicit zerocopy_sender(int sockfd);
+
+			/**
+			 * Gets the identifier which will be assigned to the next successful send.
+			 *
+			 * @return The next identifier.
+			 */
+			std::uint32_t next_id() const noexcept { return _next_id; }
+
+			/**
+			 * Gets the number of sends whose completions have not yet been reaped.
+			 *
+			 * @return The number of outstanding sends.
+			 */
+			std::uint32_t pending() const noexcept { return _next_id - _completed; }
+
+			/**
+			 * Sends data with `MSG_ZEROCOPY`.
+			 *
+			 * @param buf A pointer to the data, which must remain valid and unmodified until its
+			 *        send completes.
+			 * @param len The number of bytes to send.
+			 * @param flags A bitwise combination of additional flags.
+			 * @return The number of bytes actually sent.
+			 * @throw std::system_error An error occurred. This includes `EAGAIN` on non-blocking
+			 *        sockets, and `ENOBUFS` if the socket's optmem limit was reached.
+			 */
+			std::size_t send(const void *buf, std::size_t len, int flags = 0);
+
+			/**
+			 * Sends data with `MSG_ZEROCOPY` without throwing.
+			 *
+			 * @param buf A pointer to the data, which must remain valid and unmodified until its
+			 *        send completes.
+			 * @param len The number of bytes to send.
+			 * @param flags A bitwise combination of additional flags.
+			 * @param ec Set to the error which occurred, or cleared on success.
+			 * @return The number of bytes actually sent, or zero if an error occurred.
+			 */
+			std::size_t send(const void *buf, std::size_t len, int flags, std::error_code& ec) noexcept;
+
+			/**
+			 * Sends a message with `MSG_ZEROCOPY`.
+			 *
+			 * @param msg A pointer to the message, whose buffers must remain valid and
+			 *        unmodified until its send completes.
+			 * @param flags A bitwise combination of additional flags.
+			 * @return The number of bytes actually sent.
+			 * @throw std::system_error An error occurred.
+			 */
+			std::size_t sendmsg(const struct msghdr *msg, int flags = 0);
+
+			/**
+			 * Sends a message with `MSG_ZEROCOPY` without throwing.
+			 *
+			 * @param msg A pointer to the message, whose buffers must remain valid and
+			 *        unmodified until its send completes.
+			 * @param flags A bitwise combination of additional flags.
+			 * @param ec Set to the error which occurred, or cleared on success.
+			 * @return The number of bytes actually sent, or zero if an error occurred.
+			 */
+			std::size_t sendmsg(const struct msghdr *msg, int flags, std::error_code& ec) noexcept;
+
+			/**
+			 * Reads all queued completion notifications from the socket's error queue without
+			 * blocking. Other kinds of queued errors are discarded.
+			 *
+			 * @param cb The callback to invoke for each completed range.
+			 * @return The number of sends completed.
+			 * @throw std::system_error An error occurred.
+			 */
+			std::size_t reap(const completion_callback& cb);
+
+			/**
+			 * Gets the socket.
+			 *
+			 * @return The socket file descriptor.
+			 */
+			int fd() const noexcept { return _sockfd; }
+
+		private:
+
+			int _sockfd;
+			std::uint32_t _next_id;
+			std::uint32_t _completed;
+	};
+}
@@ -0,0 +1,155 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include <w/fd_table.hpp>
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+
+namespace
+{
+	// Set once close_range() has been found to be unsupported (before Linux 5.9), so that it is
+	// not tried for every run.
+	std::atomic<bool> close_range_unsupported { false };
+
+	void close_run(std::size_t first, std::size_t count) noexcept
+	{
+		if (count > 1 && !close_range_unsupported.load(std::memory_order_relaxed))
+		{
+			std::error_code ec;
+			w::close_range(static_cast<unsigned>(first), static_cast<unsigned>(first + count - 1), 0, ec);
+
+			if (!ec)
+				return;
+
+			close_range_unsupported.store(true, std::memory_order_relaxed);
+		}
+
+		for (std::size_t fd = first; fd < first + count; ++fd)
+			::close(static_cast<int>(fd));
+	}
+}
+
+w::fd_table::fd_table(fd_table&& other) noexcept
+	: _bits(std::move(other._bits)),
+	  _size(std::exchange(other._size, 0))
+{
+	other._bits.clear();
+}
+
+w::fd_table& w::fd_table::operator=(fd_table&& other) noexcept
+{
+	if (&other != this)
+	{
+		close();
+		_bits = std::move(other._bits);
+		_size = std::exchange(other._size, 0);
+		other._bits.clear();
+	}
+
+	return *this;
+}
+
+void w::fd_table::insert(w::fd&& fd)
+{
+	if (!fd)
+		return;
+
+	auto i = static_cast<std::size_t>(fd.get());
+
+	if (i / 64 >= _bits.size())
+		_bits.resize(std::max(i / 64 + 1, _bits.size() * 2));
+
+	std::uint64_t bit = std::uint64_t { 1 } << (i % 64);
+
+	// Another handle can only own the same file descriptor by mistake, in which case the
+	// table keeps its single ownership and the duplicate is dropped without closing it.
+
+	if (!(_bits[i / 64] & bit))
+	{
+		_bits[i / 64] |= bit;
+		++_size;
+	}
+
+	fd.release();
+}
+
+w::fd w::fd_table::extract(int fd) noexcept
+{
+	if (!contains(fd))
+		return { };
+
+	auto i = static_cast<std::size_t>(fd);
+	_bits[i / 64] &= ~(std::uint64_t { 1 } << (i % 64));
+	--_size;
+
+	return fd;
+}
+
+void w::fd_table::close() noexcept
+{
+	// Descriptors are coalesced into runs of consecutive numbers, taking whole words at a time
+	// where they are full, as they are in a dense table.
+
+	std::size_t first = 0, count = 0;
+
+	for (std::size_t word = 0; word < _bits.size(); ++word)
+	{
+		std::uint64_t bits = _bits[word];
+
+		if (bits == ~std::uint64_t { 0 } && (!count || first + count == word * 64))
+		{
+			if (!count)
+				first = word * 64;
+
+			count += 64;
+			continue;
+		}
+
+		for (; bits; bits &= bits - 1)
+		{
+			std::size_t fd = word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+
+			if (count && fd == first + count)
+				++count;
+			else
+			{
+				if (count)
+					close_run(first, count);
+
+				first = fd;
+				count = 1;
+			}
+		}
+	}
+
+	if (count)
+		close_run(first, count);
+
+	_bits.clear();
+	_size = 0;
+}
+
+std::vector<int> w::fd_table::release()
+{
+	std::vector<int> fds;
+	fds.reserve(_size);
+	for_each([&](int fd) { fds.push_back(fd); });
+
+	_bits.clear();
+	_size = 0;
+	return fds;
+}
@@ -0,0 +1,402 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <w/instrumentation.hpp>
+
+namespace
+{
+	constexpr std::size_t sub_buckets = 4;
+
+	// Each counter is only written by the thread which owns it, so a relaxed load and store is
+	// enough, and avoids a locked instruction; other threads only ever read it.
+
+	struct counter
+	{
+		std::atomic<std::uint64_t> value { 0 };
+
+		void add(std::uint64_t n) noexcept
+		{
+			value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+		}
+
+		std::uint64_t get() const noexcept { return value.load(std::memory_order_relaxed); }
+	};
+
+	struct alignas(64) site_counters
+	{
+		counter calls;
+		counter errors;
+		counter bytes;
+		counter errors_by_class[w::instrumentation::error_class_count];
+		counter latency[w::instrumentation::histogram_buckets];
+	};
+
+	struct thread_counters
+	{
+		site_counters sites[w::instrumentation::site_count];
+	};
+
+	// The counters of live threads are registered here, and the counters of exited threads are
+	// folded into the retired totals.
+
+	std::mutex registry_lock;
+	std::vector<thread_counters *> registry;
+	thread_counters retired;
+
+	void accumulate(w::instrumentation::site_snapshot& to, const site_counters& from) noexcept
+	{
+		to.calls += from.calls.get();
+		to.errors += from.errors.get();
+		to.bytes += from.bytes.get();
+
+		for (std::size_t i = 0; i < w::instrumentation::error_class_count; ++i)
+			to.errors_by_class[i] += from.errors_by_class[i].get();
+
+		for (std::size_t i = 0; i < w::instrumentation::histogram_buckets; ++i)
+			to.latency[i] += from.latency[i].get();
+	}
+
+	// As with the coroutine frame pool, the pointer is trivially destructible, so that calls
+	// made from other thread-local destructors after the cleanup below has run are still safe;
+	// they are simply not recorded.
+
+	thread_local thread_counters *local;
+	thread_local bool local_closed;
+
+	struct local_cleanup
+	{
+		~local_cleanup()
+		{
+			local_closed = true;
+
+			if (!local)
+				return;
+
+			std::lock_guard<std::mutex> guard(registry_lock);
+			registry.erase(std::find(registry.begin(), registry.end(), local));
+
+			for (std::size_t s = 0; s < w::instrumentation::site_count; ++s)
+			{
+				site_counters& to = retired.sites[s];
+				const site_counters& from = local->sites[s];
+
+				to.calls.add(from.calls.get());
+				to.errors.add(from.errors.get());
+				to.bytes.add(from.bytes.get());
+
+				for (std::size_t i = 0; i < w::instrumentation::error_class_count; ++i)
+					to.errors_by_class[i].add(from.errors_by_class[i].get());
+
+				for (std::size_t i = 0; i < w::instrumentation::histogram_buckets; ++i)
+					to.latency[i].add(from.latency[i].get());
+			}
+
+			delete std::exchange(local, nullptr);
+		}
+	};
+
+	thread_local local_cleanup cleanup;
+
+	thread_counters *local_counters() noexcept
+	{
+		if (local || local_closed)
+			return local;
+
+		// Touching the cleanup object registers its destructor for this thread.
+		(void) &cleanup;
+
+		auto counters = new (std::nothrow) thread_counters;
+		if (!counters)
+			return nullptr;
+
+		try
+		{
+			std::lock_guard<std::mutex> guard(registry_lock);
+			registry.push_back(counters);
+		}
+		catch (...)
+		{
+			delete counters;
+			return nullptr;
+		}
+
+		return local = counters;
+	}
+
+	std::size_t bucket(std::uint64_t ns) noexcept
+	{
+		if (ns < sub_buckets)
+			return ns;
+
+		// Below the top two bits of the value, the next two select one of four linear
+		// sub-buckets within its power of two.
+
+		std::size_t msb = std::bit_width(ns) - 1;
+		std::size_t sub = (ns >> (msb - 2)) & (sub_buckets - 1);
+		return std::min((msb - 1) * sub_buckets + sub, w::instrumentation::histogram_buckets - 1);
+	}
+
+	void append(std::string& out, std::uint64_t value)
+	{
+		out += std::to_string(value);
+	}
+}
+
+void w::instrumentation::detail::record(site s, std::chrono::steady_clock::duration elapsed,
+	int errnum, std::uint64_t bytes) noexcept
+{
+	thread_counters *counters = local_counters();
+	if (!counters)
+		return;
+
+	site_counters& c = counters->sites[static_cast<std::size_t>(s)];
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+	c.calls.add(1);
+	c.latency[bucket(ns > 0 ? static_cast<std::uint64_t>(ns) : 0)].add(1);
+
+	if (errnum)
+	{
+		c.errors.add(1);
+		c.errors_by_class[static_cast<std::size_t>(w::instrumentation::classify(errnum))].add(1);
+	}
+	else if (bytes)
+		c.bytes.add(bytes);
+}
+
+w::instrumentation::error_class w::instrumentation::classify(int errnum) noexcept
+{
+	switch (errnum)
+	{
+		case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+		case EWOULDBLOCK:
+#endif
+			return error_class::would_block;
+
+		case EINTR:
+			return error_class::interrupted;
+
+		case EINPROGRESS:
+		case EALREADY:
+			return error_class::in_progress;
+
+		case ECONNABORTED:
+		case ECONNREFUSED:
+		case ECONNRESET:
+		case EHOSTUNREACH:
+		case ENETDOWN:
+		case ENETRESET:
+		case ENETUNREACH:
+		case ENOTCONN:
+		case EPIPE:
+		case ETIMEDOUT:
+			return error_class::connection;
+
+		case EMFILE:
+		case ENFILE:
+		case ENOBUFS:
+		case ENOMEM:
+		case ENOSPC:
+		case EDQUOT:
+			return error_class::resource;
+
+		case EACCES:
+		case EPERM:
+			return error_class::permission;
+
+		case ENOENT:
+		case ENODEV:
+		case ENXIO:
+		case ESRCH:
+		case EADDRNOTAVAIL:
+			return error_class::not_found;
+
+		case EBADF:
+		case EFAULT:
+		case EINVAL:
+		case ENOTSOCK:
+		case EOPNOTSUPP:
+		case ENOTTY:
+			return error_class::invalid;
+
+		default:
+			return error_class::other;
+	}
+}
+
+const char *w::instrumentation::name(site s) noexcept
+{
+	static constexpr const char *names[] =
+	{
+#define CPPWRAP_SITE(name) #name,
+		CPPWRAP_INSTRUMENTED_WRAPPERS(CPPWRAP_SITE)
+#undef CPPWRAP_SITE
+	};
+
+	return names[static_cast<std::size_t>(s)];
+}
+
+const char *w::instrumentation::name(error_class c) noexcept
+{
+	static constexpr const char *names[error_class_count] =
+	{
+		"would_block",
+		"interrupted",
+		"in_progress",
+		"connection",
+		"resource",
+		"permission",
+		"not_found",
+		"invalid",
+		"other",
+	};
+
+	return names[static_cast<std::size_t>(c)];
+}
+
+std::chrono::nanoseconds w::instrumentation::bucket_lower_bound(std::size_t bucket) noexcept
+{
+	if (bucket < sub_buckets)
+		return std::chrono::nanoseconds(bucket);
+
+	std::size_t msb = bucket / sub_buckets + 1;
+	std::size_t sub = bucket % sub_buckets;
+	return std::chrono::nanoseconds(static_cast<std::int64_t>((sub_buckets + sub) << (msb - 2)));
+}
+
+std::chrono::nanoseconds w::instrumentation::site_snapshot::percentile(double p) const noexcept
+{
+	if (!calls)
+		return std::chrono::nanoseconds(0);
+
+	std::uint64_t total = 0;
+	for (std::uint64_t n : latency)
+		total += n;
+
+	// The rank is rounded up, so that any nonzero percentile falls in a nonempty bucket.
+
+	auto rank = static_cast<std::uint64_t>(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(total) + 0.999999);
+	rank = std::max<std::uint64_t>(rank, 1);
+
+	std::uint64_t seen = 0;
+	for (std::size_t i = 0; i < histogram_buckets; ++i)
+	{
+		seen += latency[i];
+		if (seen >= rank)
+			return bucket_lower_bound(i);
+	}
+
+	return bucket_lower_bound(histogram_buckets - 1);
+}
+
+std::vector<w::instrumentation::site_snapshot> w::instrumentation::snapshot()
+{
+	std::vector<site_snapshot> sites(site_count);
+
+	for (std::size_t s = 0; s < site_count; ++s)
+		sites[s].site = static_cast<site>(s);
+
+	{
+		std::lock_guard<std::mutex> guard(registry_lock);
+
+		for (std::size_t s = 0; s < site_count; ++s)
+		{
+			accumulate(sites[s], retired.sites[s]);
+
+			for (thread_counters *counters : registry)
+				accumulate(sites[s], counters->sites[s]);
+		}
+	}
+
+	std::erase_if(sites, [](const site_snapshot& s) { return !s.calls; });
+	return sites;
+}
+
+std::string w::instrumentation::to_json(std::span<const site_snapshot> sites)
+{
+	std::string out = "{\"sites\":[";
+
+	for (const site_snapshot& s : sites)
+	{
+		if (&s != sites.data())
+			out += ',';
+
+		out += "{\"name\":\"";
+		out += name(s.site);
+		out += "\",\"calls\":";
+		append(out, s.calls);
+		out += ",\"errors\":";
+		append(out, s.errors);
+		out += ",\"bytes\":";
+		append(out, s.bytes);
+
+		out += ",\"errors_by_class\":{";
+		bool first = true;
+
+		for (std::size_t i = 0; i < error_class_count; ++i)
+		{
+			if (!s.errors_by_class[i])
+				continue;
+
+			if (!first)
+				out += ',';
+
+			out += '"';
+			out += name(static_cast<error_class>(i));
+			out += "\":";
+			append(out, s.errors_by_class[i]);
+			first = false;
+		}
+
+		out += "},\"latency_ns\":{\"p50\":";
+		append(out, static_cast<std::uint64_t>(s.percentile(50).count()));
+		out += ",\"p90\":";
+		append(out, static_cast<std::uint64_t>(s.percentile(90).count()));
+		out += ",\"p99\":";
+		append(out, static_cast<std::uint64_t>(s.percentile(99).count()));
+		out += ",\"max\":";
+		append(out, static_cast<std::uint64_t>(s.percentile(100).count()));
+
+		out += "},\"histogram\":[";
+		first = true;
+
+		for (std::size_t i = 0; i < histogram_buckets; ++i)
+		{
+			if (!s.latency[i])
+				continue;
+
+			if (!first)
+				out += ',';
+
+			out += '[';
+			append(out, static_cast<std::uint64_t>(bucket_lower_bound(i).count()));
+			out += ',';
+			append(out, s.latency[i]);
+			out += ']';
+			first = false;
+		}
+
+		out += "]}";
+	}
+
+	out += "]}";
+	return out;
+}
@@ -0,0 +1,195 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+#include <wx/arena.hpp>
+
+namespace
+{
+	std::size_t read_huge_page_size() noexcept
+	{
+		std::error_code ec;
+		w::fd file = w::open("/proc/meminfo", O_RDONLY | O_CLOEXEC, ec);
+
+		if (ec)
+			return 0;
+
+		// The line we need is near the end, but the whole file fits comfortably in the buffer.
+
+		char buf[8192];
+		std::size_t size = 0;
+
+		while (size < sizeof(buf) - 1)
+		{
+			std::size_t n = w::read(file, buf + size, sizeof(buf) - 1 - size, ec);
+
+			if (ec || !n)
+				break;
+
+			size += n;
+		}
+
+		buf[size] = '\0';
+
+		const char *line = std::strstr(buf, "Hugepagesize:");
+		if (!line)
+			return 0;
+
+		return static_cast<std::size_t>(std::strtoull(line + 13, nullptr, 10)) * 1024;
+	}
+
+	std::size_t page_size() noexcept
+	{
+		static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		return size;
+	}
+}
+
+std::size_t wx::huge_page_size() noexcept
+{
+	static const std::size_t size = read_huge_page_size();
+	return size;
+}
+
+wx::arena::arena(std::size_t block_size, bool huge_pages, int numa_node)
+	: _huge_pages(huge_pages),
+	  _numa_node(numa_node),
+	  _current(0),
+	  _next(nullptr),
+	  _end(nullptr),
+	  _allocated(0),
+	  _reserved(0)
+{
+	std::size_t granularity = huge_pages && wx::huge_page_size() ? wx::huge_page_size() : page_size();
+	_block_size = wx::round_up(block_size ? block_size : 1, granularity);
+}
+
+void wx::arena::reset() noexcept
+{
+	for (const w::mmap_handle& block : _oversized)
+		_reserved -= block.get().length;
+
+	_oversized.clear();
+	_current = 0;
+	_allocated = 0;
+
+	if (_blocks.empty())
+		_next = _end = nullptr;
+	else
+	{
+		_next = static_cast<std::byte *>(_blocks.front().get().address);
+		_end = _next + _block_size;
+	}
+}
+
+void wx::arena::release() noexcept
+{
+	_blocks.clear();
+	_oversized.clear();
+	_reserved = 0;
+	reset();
+}
+
+void *wx::arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	if (!bytes)
+		bytes = 1;
+
+	auto aligned = reinterpret_cast<std::byte *>(wx::round_up(reinterpret_cast<std::uintptr_t>(_next), alignment));
+
+	if (_next && aligned <= _end && bytes <= static_cast<std::size_t>(_end - aligned))
+	{
+		_allocated += static_cast<std::size_t>(aligned + bytes - _next);
+		_next = aligned + bytes;
+		return aligned;
+	}
+
+	// Mappings are page-aligned, so only larger alignments need padding at the start.
+
+	std::size_t padding = alignment > page_size() ? alignment : 0;
+
+	if (bytes > std::numeric_limits<std::size_t>::max() - padding - _block_size)
+		throw std::bad_alloc();
+
+	if (bytes + padding > _block_size)
+	{
+		std::size_t granularity = _huge_pages && wx::huge_page_size() ? wx::huge_page_size() : page_size();
+		_oversized.reserve(_oversized.size() + 1);
+		_oversized.push_back(map_block(wx::round_up(bytes + padding, granularity)));
+
+		auto base = reinterpret_cast<std::uintptr_t>(_oversized.back().get().address);
+		_allocated += bytes + padding;
+		return reinterpret_cast<void *>(wx::round_up(base, alignment));
+	}
+
+	// Move on to the next block, reusing one kept by reset() if there is one.
+
+	if (!_next || _current + 1 >= _blocks.size())
+	{
+		_blocks.reserve(_blocks.size() + 1);
+		_blocks.push_back(map_block(_block_size));
+		_current = _blocks.size() - 1;
+	}
+	else
+		++_current;
+
+	_next = static_cast<std::byte *>(_blocks[_current].get().address);
+	_end = _next + _block_size;
+
+	aligned = reinterpret_cast<std::byte *>(wx::round_up(reinterpret_cast<std::uintptr_t>(_next), alignment));
+	_allocated += static_cast<std::size_t>(aligned + bytes - _next);
+	_next = aligned + bytes;
+	return aligned;
+}
+
+w::mmap_handle wx::arena::map_block(std::size_t length)
+{
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	std::error_code ec;
+	w::mmap_handle block;
+
+	if (_huge_pages && wx::huge_page_size() && length % wx::huge_page_size() == 0)
+	{
+		block = w::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | wx::map_huge_flags(0), -1, 0, ec);
+
+		if (ec)
+		{
+			block = w::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+			w::madvise(block.get().address, length, MADV_HUGEPAGE, ec);
+		}
+	}
+	else
+		block = w::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+	if (_numa_node >= 0)
+	{
+		constexpr std::size_t bits = std::numeric_limits<unsigned long>::digits;
+		auto node = static_cast<std::size_t>(_numa_node);
+
+		std::vector<unsigned long> nodemask(node / bits + 1);
+		nodemask[node / bits] = 1UL << (node % bits);
+
+		w::mbind(block.get().address, length, MPOL_BIND, nodemask.data(), nodemask.size() * bits + 1);
+	}
+
+	_reserved += length;
+	return block;
+}
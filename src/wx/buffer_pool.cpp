@@ -0,0 +1,163 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <sys/mman.h>
+
+#include <w/posix.hpp>
+#include <wx/buffer_pool.hpp>
+#include <wx/cache_line.hpp>
+
+namespace
+{
+	constexpr std::size_t huge_page_size = 2 << 20;
+
+	std::atomic<std::size_t> next_thread { 0 };
+	thread_local std::size_t thread_number = next_thread.fetch_add(1, std::memory_order_relaxed);
+	thread_local std::size_t steal_offset = 1;
+
+	std::size_t round_up(std::size_t value, std::size_t multiple) noexcept
+	{
+		return (value + multiple - 1) / multiple * multiple;
+	}
+}
+
+wx::buffer_pool::buffer_pool(std::size_t buffer_size, std::size_t slab_size, bool huge_pages)
+	: _buffer_size(round_up(buffer_size, wx::cache_line_size)),
+	  _huge_pages(huge_pages),
+	  _carve_next(nullptr),
+	  _carve_end(nullptr),
+	  _capacity(0)
+{
+	if (!buffer_size)
+		throw std::invalid_argument("buffer size must be nonzero");
+
+	_slab_size = round_up(std::max(slab_size, _buffer_size), _buffer_size);
+
+	if (_huge_pages)
+		_slab_size = round_up(_slab_size, huge_page_size);
+
+	std::size_t shards = std::bit_ceil(std::max(std::thread::hardware_concurrency(), 1u));
+	_shard_mask = shards - 1;
+	_shards = std::make_unique<shard[]>(shards);
+}
+
+wx::buffer_pool::shard& wx::buffer_pool::local_shard() noexcept
+{
+	return _shards[thread_number & _shard_mask];
+}
+
+std::byte *wx::buffer_pool::allocate()
+{
+	if (std::byte *buffer = take_free())
+		return buffer;
+
+	// Buffers are carved from the current slab one at a time, so that a slab's pages are only
+	// touched as its buffers are first used.
+
+	std::lock_guard<std::mutex> guard(_slabs_lock);
+
+	if (_carve_next == _carve_end)
+	{
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+		std::error_code ec;
+		w::mmap_handle slab;
+
+		if (_huge_pages)
+		{
+			slab = w::mmap(nullptr, _slab_size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0, ec);
+
+			if (ec)
+			{
+				slab = w::mmap(nullptr, _slab_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+				w::madvise(slab.get().address, _slab_size, MADV_HUGEPAGE, ec);
+			}
+		}
+		else
+			slab = w::mmap(nullptr, _slab_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+		auto base = static_cast<std::byte *>(slab.get().address);
+		_slabs.push_back(std::move(slab));
+		_carve_next = base;
+		_carve_end = base + _slab_size / _buffer_size * _buffer_size;
+	}
+
+	std::byte *buffer = _carve_next;
+	_carve_next += _buffer_size;
+	_capacity.fetch_add(1, std::memory_order_relaxed);
+	return buffer;
+}
+
+void wx::buffer_pool::release(std::byte *buffer) noexcept
+{
+	shard& s = local_shard();
+	auto node = reinterpret_cast<free_buffer *>(buffer);
+	std::lock_guard<std::mutex> guard(s.lock);
+
+	node->next = s.head;
+	s.head = node;
+}
+
+std::byte *wx::buffer_pool::take_free() noexcept
+{
+	shard& local = local_shard();
+
+	{
+		std::lock_guard<std::mutex> guard(local.lock);
+
+		if (free_buffer *buffer = local.head)
+		{
+			local.head = buffer->next;
+			return reinterpret_cast<std::byte *>(buffer);
+		}
+	}
+
+	if (!_shard_mask)
+		return nullptr;
+
+	// The whole free list of one other shard is taken at once, so that a thread consuming the
+	// buffers freed by another takes the other thread's lock once per batch. The thread keeps
+	// stealing from the same shard for as long as it finds buffers there.
+
+	std::size_t offset = steal_offset;
+	shard& victim = _shards[(thread_number + offset) & _shard_mask];
+	free_buffer *stolen;
+
+	{
+		std::lock_guard<std::mutex> guard(victim.lock);
+		stolen = victim.head;
+		victim.head = nullptr;
+	}
+
+	if (!stolen)
+	{
+		steal_offset = offset % _shard_mask + 1;
+		return nullptr;
+	}
+
+	if (free_buffer *rest = stolen->next)
+	{
+		free_buffer *tail = rest;
+		while (tail->next)
+			tail = tail->next;
+
+		std::lock_guard<std::mutex> guard(local.lock);
+		tail->next = local.head;
+		local.head = rest;
+	}
+
+	return reinterpret_cast<std::byte *>(stolen);
+}
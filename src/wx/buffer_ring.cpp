@@ -0,0 +1,140 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+
+#include <w/io_uring.hpp>
+#include <w/posix.hpp>
+#include <wx/buffer_pool.hpp>
+#include <wx/buffer_ring.hpp>
+
+wx::buffer_ring::buffer_ring(w::io_uring& ring, wx::buffer_pool& pool, unsigned entries,
+	std::uint16_t bgid)
+	: _ring(ring),
+	  _pool(pool),
+	  _br(nullptr),
+	  _mask(entries - 1),
+	  _bgid(bgid),
+	  _tail(0)
+{
+	if (!entries || !std::has_single_bit(entries) || entries > 32768)
+		throw std::invalid_argument("buffer ring size must be a power of two no greater than 32768");
+
+	if (pool.buffer_size() > std::numeric_limits<std::uint32_t>::max())
+		throw std::invalid_argument("buffer size is too large for buffer ring");
+
+	_memory = w::mmap(nullptr, entries * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	_br = static_cast<struct io_uring_buf_ring *>(_memory.get().address);
+
+	_buffers.reserve(entries);
+
+	try
+	{
+		while (_buffers.size() < entries)
+			_buffers.push_back(_pool.allocate());
+	}
+	catch (...)
+	{
+		for (std::byte *buffer : _buffers)
+			_pool.release(buffer);
+
+		throw;
+	}
+
+	for (unsigned i = 0; i < entries; ++i)
+		provide(static_cast<std::uint16_t>(i));
+
+	publish();
+
+	struct io_uring_buf_reg reg { };
+	reg.ring_addr = reinterpret_cast<std::uintptr_t>(_br);
+	reg.ring_entries = entries;
+	reg.bgid = bgid;
+
+	try
+	{
+		_ring.register_buf_ring(reg);
+	}
+	catch (...)
+	{
+		for (std::byte *buffer : _buffers)
+			_pool.release(buffer);
+
+		throw;
+	}
+}
+
+wx::buffer_ring::~buffer_ring()
+{
+	try
+	{
+		_ring.unregister_buf_ring(_bgid);
+	}
+	catch (const std::system_error&)
+	{
+	}
+
+	for (std::byte *buffer : _buffers)
+		_pool.release(buffer);
+}
+
+std::uint16_t wx::buffer_ring::buffer_id(const struct io_uring_cqe& cqe) const
+{
+	if (!(cqe.flags & IORING_CQE_F_BUFFER))
+		throw std::invalid_argument("completion queue entry does not report a buffer");
+
+	auto bid = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+	if (bid > _mask)
+		throw std::invalid_argument("completion queue entry reports a buffer from another ring");
+
+	return bid;
+}
+
+void wx::buffer_ring::provide(std::uint16_t bid) noexcept
+{
+	// The tail of the ring overlays the reserved field of the first entry, so that field must
+	// never be written.
+
+	struct io_uring_buf& buf = _br->bufs[_tail & _mask];
+	buf.addr = reinterpret_cast<std::uintptr_t>(_buffers[bid]);
+	buf.len = static_cast<std::uint32_t>(_pool.buffer_size());
+	buf.bid = bid;
+	++_tail;
+}
+
+void wx::buffer_ring::publish() noexcept
+{
+	std::atomic_ref<std::uint16_t>(_br->tail).store(_tail, std::memory_order_release);
+}
+
+wx::buffer_pool::lease wx::buffer_ring::take(const struct io_uring_cqe& cqe)
+{
+	std::uint16_t bid = buffer_id(cqe);
+	std::byte *fresh = _pool.allocate();
+
+	wx::buffer_pool::lease taken(_pool, std::exchange(_buffers[bid], fresh));
+	provide(bid);
+	publish();
+	return taken;
+}
+
+void wx::buffer_ring::recycle(const struct io_uring_cqe& cqe)
+{
+	provide(buffer_id(cqe));
+	publish();
+}
@@ -0,0 +1,176 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+#include <system_error>
+
+#include <fcntl.h>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+#include <wx/copy.hpp>
+
+namespace
+{
+	// The largest amount requested from the kernel in a single call, which keeps well clear of
+	// the kernel's own per-call limit of just under 2 GiB.
+	constexpr std::size_t max_chunk = std::size_t { 1 } << 30;
+
+	// The size requested for the splice staging pipe. The kernel silently caps unprivileged
+	// requests at /proc/sys/fs/pipe-max-size, and failure leaves the default size in place.
+	constexpr int staging_pipe_size = 1 << 20;
+
+	// The size of the user space buffer used by the read/write fallback.
+	constexpr std::size_t fallback_buffer_size = 1 << 16;
+
+	bool unsupported(const std::error_code& ec) noexcept
+	{
+		return ec == std::errc::invalid_argument ||
+			ec == std::errc::function_not_supported ||
+			ec == std::errc::cross_device_link ||
+			ec == std::errc::operation_not_supported ||
+			ec == std::errc::bad_file_descriptor;
+	}
+
+	// Each of the kernel paths below returns false without copying anything if it is not
+	// supported for the pair of file descriptors, and otherwise copies as much as it can,
+	// adding to copied.
+
+	bool copy_with_copy_file_range(int in, int out, std::size_t len, std::size_t& copied)
+	{
+		while (copied < len)
+		{
+			std::error_code ec;
+			std::size_t n = w::copy_file_range(in, nullptr, out, nullptr,
+				std::min(len - copied, max_chunk), 0, ec);
+
+			// Some pseudo-filesystems (e.g. procfs and sysfs on older kernels) report a zero
+			// length instead of an error, which is indistinguishable from an empty file, so a
+			// zero first result hands over to the next method to decide.
+
+			if (!copied && (ec ? unsupported(ec) : n == 0))
+				return false;
+			else if (ec)
+				throw std::system_error(ec, "failed to copy file range");
+			else if (!n)
+				break;
+
+			copied += n;
+		}
+
+		return true;
+	}
+
+	bool copy_with_sendfile(int in, int out, std::size_t len, std::size_t& copied)
+	{
+		while (copied < len)
+		{
+			std::error_code ec;
+			std::size_t n = w::sendfile(out, in, nullptr, std::min(len - copied, max_chunk), ec);
+
+			if (!copied && ec && unsupported(ec))
+				return false;
+			else if (ec)
+				throw std::system_error(ec, "failed to send file");
+			else if (!n)
+				break;
+
+			copied += n;
+		}
+
+		return true;
+	}
+
+	bool copy_with_splice(int in, int out, std::size_t len, std::size_t& copied)
+	{
+		// Try a direct splice first, which works if either side is a pipe.
+
+		while (copied < len)
+		{
+			std::error_code ec;
+			std::size_t n = w::splice(in, nullptr, out, nullptr,
+				std::min(len - copied, max_chunk), SPLICE_F_MOVE | SPLICE_F_MORE, ec);
+
+			if (!copied && ec == std::errc::invalid_argument)
+				break;
+			else if (ec)
+				throw std::system_error(ec, "failed to splice data");
+			else if (!n)
+				return true;
+
+			copied += n;
+		}
+
+		if (copied)
+			return true;
+
+		// Neither side is a pipe, so stage the data through one.
+
+		auto [pipe_in, pipe_out] = w::pipe();
+
+		std::error_code ec;
+		w::fcntl(pipe_out, F_SETPIPE_SZ, staging_pipe_size, ec);
+
+		while (copied < len)
+		{
+			std::size_t staged = w::splice(in, nullptr, pipe_out, nullptr,
+				std::min(len - copied, max_chunk), SPLICE_F_MOVE | SPLICE_F_MORE, ec);
+
+			if (!copied && ec && unsupported(ec))
+				return false;
+			else if (ec)
+				throw std::system_error(ec, "failed to splice data");
+			else if (!staged)
+				break;
+
+			while (staged)
+			{
+				std::size_t n = w::splice(pipe_in, nullptr, out, nullptr, staged,
+					SPLICE_F_MOVE | SPLICE_F_MORE);
+
+				staged -= n;
+				copied += n;
+			}
+		}
+
+		return true;
+	}
+
+	void copy_with_read_write(int in, int out, std::size_t len, std::size_t& copied)
+	{
+		auto buffer = std::make_unique<char[]>(fallback_buffer_size);
+
+		while (copied < len)
+		{
+			std::size_t n = w::read(in, buffer.get(), std::min(len - copied, fallback_buffer_size));
+
+			if (!n)
+				break;
+
+			for (std::size_t written = 0; written < n; )
+				written += w::write(out, buffer.get() + written, n - written);
+
+			copied += n;
+		}
+	}
+}
+
+std::size_t wx::copy_fd(int in, int out, std::size_t len)
+{
+	std::size_t copied = 0;
+
+	if (!len ||
+		copy_with_copy_file_range(in, out, len, copied) ||
+		copy_with_sendfile(in, out, len, copied) ||
+		copy_with_splice(in, out, len, copied))
+		return copied;
+
+	copy_with_read_write(in, out, len, copied);
+	return copied;
+}
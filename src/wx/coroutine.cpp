@@ -0,0 +1,218 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <w/posix.hpp>
+#include <w/sockets.hpp>
+#include <wx/coroutine.hpp>
+#include <wx/event_loop.hpp>
+
+namespace
+{
+	// Frames are rounded up to a multiple of the granularity and cached per size class, up to
+	// a maximum frame size and a maximum number of cached frames per class; anything else goes
+	// straight to the heap.
+
+	constexpr std::size_t granularity = 64;
+	constexpr std::size_t size_classes = 32;
+	constexpr std::size_t max_cached = 256;
+
+	struct free_frame
+	{
+		free_frame *next;
+	};
+
+	struct frame_pool
+	{
+		free_frame *heads[size_classes];
+		std::size_t counts[size_classes];
+	};
+
+	// The pool itself is trivially destructible, so that frames freed during thread exit after
+	// the cleanup below has run (e.g. from other thread-local destructors) are still handled
+	// safely; such frames go straight back to the heap.
+
+	thread_local frame_pool pool;
+	thread_local bool pool_closed;
+
+	struct frame_pool_cleanup
+	{
+		~frame_pool_cleanup()
+		{
+			pool_closed = true;
+
+			for (std::size_t i = 0; i < size_classes; ++i)
+			{
+				while (free_frame *frame = pool.heads[i])
+				{
+					pool.heads[i] = frame->next;
+					::operator delete(static_cast<void *>(frame));
+				}
+			}
+		}
+	};
+
+	thread_local frame_pool_cleanup cleanup;
+
+	std::size_t size_class(std::size_t size) noexcept
+	{
+		return (size + granularity - 1) / granularity - 1;
+	}
+}
+
+void *wx::detail::allocate_frame(std::size_t size)
+{
+	std::size_t index = size_class(size);
+
+	if (index < size_classes && !pool_closed)
+	{
+		// Touching the cleanup object registers its destructor for this thread.
+		(void) &cleanup;
+
+		if (free_frame *frame = pool.heads[index])
+		{
+			pool.heads[index] = frame->next;
+			--pool.counts[index];
+			return frame;
+		}
+
+		return ::operator new((index + 1) * granularity);
+	}
+
+	return ::operator new(size);
+}
+
+void wx::detail::deallocate_frame(void *ptr, std::size_t size) noexcept
+{
+	std::size_t index = size_class(size);
+
+	if (index < size_classes && !pool_closed && pool.counts[index] < max_cached)
+	{
+		// Frames may be freed on a thread other than the one which allocated them.
+		(void) &cleanup;
+
+		auto frame = static_cast<free_frame *>(ptr);
+		frame->next = pool.heads[index];
+		pool.heads[index] = frame;
+		++pool.counts[index];
+		return;
+	}
+
+	::operator delete(ptr);
+}
+
+wx::async_fd::async_fd(wx::event_loop& loop, w::fd fd)
+	: _loop(loop),
+	  _fd(std::move(fd))
+{
+	_loop.add(_fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+		[this](std::uint32_t events) { on_events(events); });
+}
+
+wx::async_fd::~async_fd()
+{
+	_loop.remove(_fd);
+}
+
+void wx::async_fd::on_events(std::uint32_t events)
+{
+	// Both waiters are taken before either is resumed, since the first may destroy this object.
+
+	std::coroutine_handle<> reader, writer;
+
+	if (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP))
+		reader = std::exchange(_reader, { });
+
+	if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+		writer = std::exchange(_writer, { });
+
+	if (reader)
+		reader.resume();
+
+	if (writer)
+		writer.resume();
+}
+
+void wx::async_fd::finish_connect()
+{
+	int error = w::getsockopt<int>(_fd, SOL_SOCKET, SO_ERROR);
+
+	if (error)
+		throw std::system_error(error, std::generic_category(), "failed to connect socket");
+}
+
+wx::task<std::size_t> wx::async_fd::read(void *buf, std::size_t count)
+{
+	for (;;)
+	{
+		std::error_code ec;
+		std::size_t n = w::read(_fd, buf, count, ec);
+
+		if (!ec)
+			co_return n;
+		else if (!w::would_block(ec))
+			throw std::system_error(ec, "read error");
+
+		co_await readable();
+	}
+}
+
+wx::task<std::size_t> wx::async_fd::write(const void *buf, std::size_t count)
+{
+	for (;;)
+	{
+		std::error_code ec;
+		std::size_t n = w::write(_fd, buf, count, ec);
+
+		if (!ec)
+			co_return n;
+		else if (!w::would_block(ec))
+			throw std::system_error(ec, "write error");
+
+		co_await writable();
+	}
+}
+
+wx::task<std::size_t> wx::async_fd::recv(void *buf, std::size_t len, int flags)
+{
+	for (;;)
+	{
+		std::error_code ec;
+		std::size_t n = w::recv(_fd, buf, len, flags, ec);
+
+		if (!ec)
+			co_return n;
+		else if (!w::would_block(ec))
+			throw std::system_error(ec, "failed to receive from socket");
+
+		co_await readable();
+	}
+}
+
+wx::task<std::size_t> wx::async_fd::send(const void *buf, std::size_t len, int flags)
+{
+	for (;;)
+	{
+		std::error_code ec;
+		std::size_t n = w::send(_fd, buf, len, flags, ec);
+
+		if (!ec)
+			co_return n;
+		else if (!w::would_block(ec))
+			throw std::system_error(ec, "failed to send to socket");
+
+		co_await writable();
+	}
+}
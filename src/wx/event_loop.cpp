@@ -0,0 +1,168 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+#include <wx/event_loop.hpp>
+
+wx::event_loop::event_loop(std::size_t max_events)
+	: _epoll(w::epoll_create1(EPOLL_CLOEXEC)),
+	  _wakeup(w::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+	  _wake_pending(false),
+	  _stopped(false),
+	  _events(max_events ? max_events : 1)
+{
+	// The wakeup file descriptor is the only registration with a null user data pointer, which
+	// keeps it out of the registration table and lets run_once() recognize it cheaply.
+
+	w::epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, EPOLLIN);
+}
+
+wx::event_loop::registration& wx::event_loop::find(int fd) const
+{
+	auto it = _registrations.find(fd);
+	if (it == _registrations.end())
+		throw std::invalid_argument("file descriptor is not registered with event loop");
+	return *it->second;
+}
+
+void wx::event_loop::add(int fd, std::uint32_t events, callback cb)
+{
+	if (_registrations.count(fd))
+		throw std::invalid_argument("file descriptor is already registered with event loop");
+
+	auto reg = std::make_unique<registration>(registration { fd, events, true, std::move(cb), { } });
+	w::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, events, static_cast<void *>(reg.get()));
+	_registrations.emplace(fd, std::move(reg));
+}
+
+void wx::event_loop::modify(int fd, std::uint32_t events)
+{
+	registration& reg = find(fd);
+
+	if (reg.events == events)
+		return;
+
+	w::epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, events, static_cast<void *>(&reg));
+	reg.events = events;
+}
+
+void wx::event_loop::remove(int fd)
+{
+	auto it = _registrations.find(fd);
+	if (it == _registrations.end())
+		throw std::invalid_argument("file descriptor is not registered with event loop");
+
+	w::epoll_ctl(_epoll, EPOLL_CTL_DEL, fd);
+
+	// The registration may still be referenced by pending events in the batch currently being
+	// dispatched (possibly by the very callback calling us), so it is retired rather than
+	// destroyed, and flagged so that any such events are ignored.
+
+	std::unique_ptr<registration> reg = std::move(it->second);
+	_registrations.erase(it);
+	reg->active = false;
+	reg->owned.close();
+	_retired.push_back(std::move(reg));
+}
+
+bool wx::event_loop::contains(int fd) const noexcept
+{
+	return _registrations.count(fd) != 0;
+}
+
+std::uint32_t wx::event_loop::events(int fd) const
+{
+	return find(fd).events;
+}
+
+int wx::event_loop::add_timer(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval,
+	timer_callback cb, int clockid)
+{
+	w::fd timer = w::timerfd_create(clockid, TFD_NONBLOCK | TFD_CLOEXEC);
+	w::timerfd_settime(timer, 0, interval, initial);
+
+	int fd = timer;
+	add(fd, EPOLLIN, [fd, cb = std::move(cb)](std::uint32_t)
+	{
+		std::uint64_t expirations;
+		w::read(fd, &expirations, sizeof(expirations));
+		cb(expirations);
+	});
+
+	_registrations[fd]->owned = std::move(timer);
+	return fd;
+}
+
+void wx::event_loop::wake()
+{
+	if (!_wake_pending.exchange(true))
+		w::eventfd_write(_wakeup, 1);
+}
+
+void wx::event_loop::stop()
+{
+	_stopped.store(true);
+	wake();
+}
+
+std::size_t wx::event_loop::run_once(std::chrono::milliseconds timeout)
+{
+	_retired.clear();
+
+	std::error_code ec;
+	unsigned count = w::epoll_wait(_epoll, _events.data(), static_cast<int>(_events.size()), timeout, ec);
+
+	if (ec == std::errc::interrupted)
+		return 0;
+	else if (ec)
+		throw std::system_error(ec, "failed to wait on epoll instance");
+
+	std::size_t dispatched = 0;
+
+	for (unsigned i = 0; i < count; ++i)
+	{
+		auto reg = static_cast<registration *>(_events[i].data.ptr);
+
+		if (!reg)
+		{
+			// The flag must only be cleared once the counter has been drained: a wake() in
+			// between would otherwise have its write consumed here while leaving the flag set,
+			// and every later wake() would skip its write. A wake() after the read but before
+			// the store skips its write, which is harmless since the loop is already awake.
+
+			w::eventfd_read(_wakeup, ec);
+			_wake_pending.store(false);
+		}
+		else if (reg->active)
+		{
+			reg->cb(_events[i].events);
+			++dispatched;
+		}
+	}
+
+	return dispatched;
+}
+
+void wx::event_loop::run()
+{
+	while (!_stopped.load())
+		run_once();
+
+	_stopped.store(false);
+}
@@ -0,0 +1,458 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <w/linux.hpp>
+#include <w/sockets.hpp>
+#include <wx/cache_line.hpp>
+#include <wx/executor.hpp>
+#include <wx/mailbox.hpp>
+
+namespace
+{
+	// The maximum number of coroutines a worker resumes from its own deque before polling its
+	// event loop again.
+	constexpr std::size_t batch_size = 64;
+
+	// The work-stealing deque of Chase and Lev, with the memory orderings given by Lê et al.,
+	// "Correct and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013). Only the owner
+	// pushes and pops (at the bottom); any thread may steal (from the top). The array grows as
+	// needed, and arrays which have been replaced are kept until the deque is destroyed, since a
+	// thief may still be reading from them.
+
+	class work_deque
+	{
+		public:
+
+			explicit work_deque(std::size_t capacity = 256)
+				: _top(0),
+				  _bottom(0)
+			{
+				_arrays.push_back(std::make_unique<array>(capacity));
+				_array.store(_arrays.back().get(), std::memory_order_relaxed);
+			}
+
+			void push(void *item)
+			{
+				std::int64_t b = _bottom.load(std::memory_order_relaxed);
+				std::int64_t t = _top.load(std::memory_order_acquire);
+				array *a = _array.load(std::memory_order_relaxed);
+
+				if (b - t > static_cast<std::int64_t>(a->mask))
+				{
+					auto bigger = std::make_unique<array>((a->mask + 1) * 2);
+
+					for (std::int64_t i = t; i < b; ++i)
+						bigger->put(i, a->get(i));
+
+					a = bigger.get();
+					_arrays.push_back(std::move(bigger));
+					_array.store(a, std::memory_order_release);
+				}
+
+				a->put(b, item);
+				_bottom.store(b + 1, std::memory_order_release);
+			}
+
+			void *pop() noexcept
+			{
+				std::int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+				array *a = _array.load(std::memory_order_relaxed);
+				_bottom.store(b, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				std::int64_t t = _top.load(std::memory_order_relaxed);
+
+				if (t > b)
+				{
+					_bottom.store(b + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				void *item = a->get(b);
+
+				// Taking the last item races with thieves, and is settled on the top index.
+
+				if (t == b)
+				{
+					if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+						std::memory_order_relaxed))
+						item = nullptr;
+
+					_bottom.store(b + 1, std::memory_order_relaxed);
+				}
+
+				return item;
+			}
+
+			void *steal() noexcept
+			{
+				std::int64_t t = _top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				std::int64_t b = _bottom.load(std::memory_order_acquire);
+
+				if (t >= b)
+					return nullptr;
+
+				array *a = _array.load(std::memory_order_acquire);
+				void *item = a->get(t);
+
+				if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+					std::memory_order_relaxed))
+					return nullptr;
+
+				return item;
+			}
+
+			bool empty() const noexcept
+			{
+				std::int64_t b = _bottom.load(std::memory_order_seq_cst);
+				std::int64_t t = _top.load(std::memory_order_seq_cst);
+				return b <= t;
+			}
+
+		private:
+
+			struct array
+			{
+				explicit array(std::size_t capacity)
+					: mask(capacity - 1),
+					  items(std::make_unique<std::atomic<void *>[]>(capacity))
+				{
+				}
+
+				void *get(std::int64_t i) const noexcept
+				{
+					return items[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed);
+				}
+
+				void put(std::int64_t i, void *item) noexcept
+				{
+					items[static_cast<std::size_t>(i) & mask].store(item, std::memory_order_relaxed);
+				}
+
+				std::size_t mask;
+				std::unique_ptr<std::atomic<void *>[]> items;
+			};
+
+			alignas(wx::cache_line_size) std::atomic<std::int64_t> _top;
+			alignas(wx::cache_line_size) std::atomic<std::int64_t> _bottom;
+			std::atomic<array *> _array;
+			std::vector<std::unique_ptr<array>> _arrays;
+	};
+
+	thread_local const wx::executor *current_executor = nullptr;
+	thread_local std::size_t current_index = wx::executor::npos;
+
+	void resume(void *address)
+	{
+		std::coroutine_handle<>::from_address(address).resume();
+	}
+}
+
+struct wx::executor::worker
+{
+	worker(std::size_t index, int cpu, std::size_t mailbox_capacity)
+		: index(index),
+		  cpu(cpu),
+		  mailbox(mailbox_capacity),
+		  sleeping(false)
+	{
+	}
+
+	std::size_t index;
+	int cpu;
+	wx::event_loop loop;
+	wx::mailbox<std::function<void()>> mailbox;
+	std::vector<std::function<void()>> deferred;
+	work_deque deque;
+	std::error_code error;
+	alignas(wx::cache_line_size) std::atomic<bool> sleeping;
+};
+
+wx::executor::executor(std::size_t threads, std::size_t mailbox_capacity)
+	: _stopping(false),
+	  _sleepers(0),
+	  _next(0)
+{
+	cpu_set_t allowed = w::sched_getaffinity(0);
+	std::vector<int> cpus;
+
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		if (CPU_ISSET(cpu, &allowed))
+			cpus.push_back(cpu);
+
+	if (!threads)
+		threads = cpus.size();
+
+	_cpu_workers.assign(CPU_SETSIZE, npos);
+
+	for (std::size_t i = 0; i < threads; ++i)
+	{
+		int cpu = cpus[i % cpus.size()];
+		_workers.push_back(std::make_unique<worker>(i, cpu, mailbox_capacity));
+
+		if (_cpu_workers[static_cast<std::size_t>(cpu)] == npos)
+			_cpu_workers[static_cast<std::size_t>(cpu)] = i;
+	}
+
+	// Each worker pins itself and registers its mailbox before reporting in, so that failures
+	// can be thrown from here.
+
+	std::latch ready(static_cast<std::ptrdiff_t>(threads));
+
+	auto body = [this, &ready](worker& self)
+	{
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		CPU_SET(self.cpu, &mask);
+		w::sched_setaffinity(0, mask, self.error);
+
+		if (!self.error)
+		{
+			try
+			{
+				self.loop.add(self.mailbox.fd(), EPOLLIN, [&self](std::uint32_t)
+				{
+					self.mailbox.drain([](std::function<void()>&& f) { f(); });
+				});
+			}
+			catch (const std::system_error& e)
+			{
+				self.error = e.code();
+			}
+		}
+
+		bool failed = static_cast<bool>(self.error);
+		ready.count_down();
+
+		if (!failed)
+			run(self);
+	};
+
+	try
+	{
+		for (auto& w : _workers)
+			_threads.emplace_back(body, std::ref(*w));
+	}
+	catch (...)
+	{
+		ready.count_down(static_cast<std::ptrdiff_t>(threads - _threads.size()));
+		ready.wait();
+		stop();
+		join();
+		throw;
+	}
+
+	ready.wait();
+
+	for (auto& w : _workers)
+	{
+		if (w->error)
+		{
+			std::error_code ec = w->error;
+			stop();
+			join();
+			throw std::system_error(ec, "failed to start executor worker");
+		}
+	}
+}
+
+wx::executor::~executor()
+{
+	stop();
+	join();
+}
+
+void wx::executor::post(std::size_t worker, std::function<void()> f)
+{
+	if (worker >= _workers.size())
+		throw std::out_of_range("executor worker index is out of range");
+
+	auto& target = *_workers[worker];
+
+	// A worker posting to itself cannot wait for its own mailbox to drain, so the callable is
+	// deferred until the worker next returns to its run loop.
+
+	if (current_executor == this && current_index == worker)
+	{
+		target.deferred.push_back(std::move(f));
+		return;
+	}
+
+	while (!target.mailbox.try_push(std::move(f)))
+		std::this_thread::yield();
+}
+
+std::size_t wx::executor::worker_for(int sockfd) const
+{
+	int cpu = w::getsockopt<int>(sockfd, SOL_SOCKET, SO_INCOMING_CPU);
+
+	if (cpu < 0)
+		return 0;
+
+	auto index = static_cast<std::size_t>(cpu);
+
+	if (index < _cpu_workers.size() && _cpu_workers[index] != npos)
+		return _cpu_workers[index];
+
+	return index % _workers.size();
+}
+
+wx::event_loop& wx::executor::loop(std::size_t worker) noexcept
+{
+	return _workers[worker]->loop;
+}
+
+int wx::executor::cpu(std::size_t worker) const noexcept
+{
+	return _workers[worker]->cpu;
+}
+
+std::size_t wx::executor::current_worker() const noexcept
+{
+	return current_executor == this ? current_index : npos;
+}
+
+void wx::executor::stop()
+{
+	_stopping.store(true, std::memory_order_release);
+
+	for (auto& w : _workers)
+		w->loop.wake();
+}
+
+void wx::executor::join()
+{
+	for (auto& t : _threads)
+		if (t.joinable())
+			t.join();
+}
+
+void wx::executor::enqueue(std::coroutine_handle<> h)
+{
+	if (current_executor != this)
+	{
+		std::size_t worker = _next.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+		post(worker, [h] { h.resume(); });
+		return;
+	}
+
+	_workers[current_index]->deque.push(h.address());
+
+	// Pairs with the fence in run(): either a worker going to sleep sees the new coroutine, or
+	// we see that it is asleep and wake it to steal.
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (_sleepers.load(std::memory_order_relaxed))
+		wake_one();
+}
+
+void wx::executor::wake_one()
+{
+	for (auto& w : _workers)
+	{
+		if (w->sleeping.load(std::memory_order_relaxed) && w->sleeping.exchange(false))
+		{
+			w->loop.wake();
+			return;
+		}
+	}
+}
+
+bool wx::executor::steal(worker& self)
+{
+	std::size_t n = _workers.size();
+
+	for (std::size_t i = 1; i < n; ++i)
+	{
+		if (void *item = _workers[(self.index + i) % n]->deque.steal())
+		{
+			resume(item);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void wx::executor::run(worker& self)
+{
+	current_executor = this;
+	current_index = self.index;
+
+	std::vector<std::function<void()>> deferred;
+
+	while (!_stopping.load(std::memory_order_acquire))
+	{
+		bool busy = false;
+
+		if (!self.deferred.empty())
+		{
+			deferred.swap(self.deferred);
+
+			for (auto& f : deferred)
+				f();
+
+			deferred.clear();
+			busy = true;
+		}
+
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			void *item = self.deque.pop();
+
+			if (!item)
+				break;
+
+			resume(item);
+			busy = true;
+		}
+
+		if (!busy)
+			busy = steal(self);
+
+		if (busy)
+		{
+			self.loop.run_once(std::chrono::milliseconds(0));
+			continue;
+		}
+
+		// Nothing is runnable here or stealable elsewhere, so sleep in the event loop until I/O,
+		// a mailbox message, or a wakeup from a worker with work to steal.
+
+		self.sleeping.store(true, std::memory_order_relaxed);
+		_sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+		bool pending = false;
+
+		for (auto& w : _workers)
+			pending = pending || !w->deque.empty();
+
+		if (!pending && !_stopping.load(std::memory_order_acquire))
+			self.loop.run_once();
+
+		_sleepers.fetch_sub(1, std::memory_order_relaxed);
+		self.sleeping.store(false, std::memory_order_relaxed);
+	}
+}
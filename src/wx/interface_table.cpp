@@ -0,0 +1,229 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ifaddrs.h>
+#include <linux/if_packet.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <w/sockets.hpp>
+#include <wx/interface_table.hpp>
+#include <wx/ipv6.hpp>
+#include <wx/netlink.hpp>
+
+namespace
+{
+	unsigned prefix_length(const struct sockaddr *netmask) noexcept
+	{
+		if (!netmask)
+			return 0;
+
+		std::span<const std::uint8_t> bytes;
+
+		if (netmask->sa_family == AF_INET)
+			bytes = { reinterpret_cast<const std::uint8_t *>(&reinterpret_cast<const struct sockaddr_in *>(netmask)->sin_addr), 4 };
+		else if (netmask->sa_family == AF_INET6)
+			bytes = reinterpret_cast<const struct sockaddr_in6 *>(netmask)->sin6_addr.s6_addr;
+
+		unsigned length = 0;
+		for (std::uint8_t byte : bytes)
+			length += std::popcount(byte);
+
+		return length;
+	}
+}
+
+wx::interface_table::interface_table()
+	: _netlink(NETLINK_ROUTE, RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR),
+	  _stale(true)
+{
+	// The subscription is made before the first snapshot is taken, so that no change can fall
+	// between the two unnoticed.
+
+	refresh();
+}
+
+void wx::interface_table::refresh()
+{
+	std::vector<interface> interfaces;
+	std::vector<std::pair<std::size_t, address>> entries;
+	std::unordered_map<std::string_view, std::size_t> by_name;
+
+	auto list = w::getifaddrs();
+
+	for (const struct ifaddrs& a : list)
+	{
+		if (!a.ifa_name)
+			continue;
+
+		std::string_view name(a.ifa_name, ::strnlen(a.ifa_name, IF_NAMESIZE - 1));
+		auto [it, inserted] = by_name.emplace(name, interfaces.size());
+
+		if (inserted)
+		{
+			interface& i = interfaces.emplace_back();
+			std::memcpy(i.name, name.data(), name.size());
+			i.name[name.size()] = '\0';
+			i.index = 0;
+			i.flags = a.ifa_flags;
+		}
+
+		if (!a.ifa_addr)
+			continue;
+
+		switch (a.ifa_addr->sa_family)
+		{
+			case AF_PACKET:
+				interfaces[it->second].index = reinterpret_cast<const struct sockaddr_ll *>(a.ifa_addr)->sll_ifindex;
+				break;
+
+			case AF_INET:
+			case AF_INET6:
+			{
+				address entry { };
+				std::memcpy(&entry.sa, a.ifa_addr, a.ifa_addr->sa_family == AF_INET ? sizeof(entry.in) : sizeof(entry.in6));
+				entry.prefix_length = prefix_length(a.ifa_netmask);
+				entries.emplace_back(it->second, entry);
+				break;
+			}
+		}
+	}
+
+	// Addresses are grouped by interface, keeping the order reported by the kernel within each
+	// interface, so that each interface's addresses form one contiguous span.
+
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const auto& x, const auto& y) { return x.first < y.first; });
+
+	std::vector<address> addresses;
+	addresses.reserve(entries.size());
+
+	for (const auto& [position, entry] : entries)
+		addresses.push_back(entry);
+
+	std::unordered_map<unsigned, std::size_t> by_index;
+	std::size_t first = 0;
+
+	for (std::size_t position = 0; position < interfaces.size(); ++position)
+	{
+		interface& i = interfaces[position];
+		std::size_t last = first;
+
+		while (last < entries.size() && entries[last].first == position)
+			++last;
+
+		i.addresses = std::span<const address>(addresses.data() + first, last - first);
+		first = last;
+
+		// Interfaces without a link-layer address (which is rare) are not reported with an
+		// AF_PACKET entry, so their index has to be looked up separately.
+
+		if (!i.index)
+			i.index = ::if_nametoindex(i.name);
+
+		if (i.index)
+			by_index.emplace(i.index, position);
+	}
+
+	// The name keys were views of the names in the list, which is about to be freed, so they
+	// are rebuilt to view the names in the table itself. Moving the vectors below does not move
+	// their elements, so these views (and the address spans) stay valid.
+
+	by_name.clear();
+	for (std::size_t position = 0; position < interfaces.size(); ++position)
+		by_name.emplace(interfaces[position].name, position);
+
+	_interfaces = std::move(interfaces);
+	_addresses = std::move(addresses);
+	_by_name = std::move(by_name);
+	_by_index = std::move(by_index);
+	_stale = false;
+}
+
+void wx::interface_table::refresh_if_stale()
+{
+	if (_stale)
+		refresh();
+}
+
+bool wx::interface_table::poll()
+{
+	_netlink.drain([this](const struct nlmsghdr& message)
+	{
+		switch (message.nlmsg_type)
+		{
+			case RTM_NEWLINK:
+			case RTM_DELLINK:
+			case RTM_NEWADDR:
+			case RTM_DELADDR:
+				_stale = true;
+				break;
+		}
+	});
+
+	// If notifications were lost, it is no longer known what changed.
+
+	if (_netlink.overrun())
+		_stale = true;
+
+	return _stale;
+}
+
+const wx::interface_table::interface *wx::interface_table::find(std::string_view name)
+{
+	refresh_if_stale();
+
+	auto it = _by_name.find(name);
+	return it == _by_name.end() ? nullptr : &_interfaces[it->second];
+}
+
+const wx::interface_table::interface *wx::interface_table::find(unsigned index)
+{
+	refresh_if_stale();
+
+	auto it = _by_index.find(index);
+	return it == _by_index.end() ? nullptr : &_interfaces[it->second];
+}
+
+std::optional<struct sockaddr_in6> wx::interface_table::link_local_address(std::string_view name)
+{
+	const interface *i = find(name);
+
+	if (i)
+	{
+		for (const address& a : i->addresses)
+		{
+			if (a.sa.sa_family == AF_INET6 && wx::ipv6::is_link_local(a.in6.sin6_addr))
+			{
+				struct sockaddr_in6 result = a.in6;
+				result.sin6_scope_id = i->index;
+				return result;
+			}
+		}
+	}
+
+	return std::nullopt;
+}
+
+std::span<const wx::interface_table::interface> wx::interface_table::interfaces()
+{
+	refresh_if_stale();
+	return _interfaces;
+}
@@ -0,0 +1,89 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <span>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <w/posix.hpp>
+#include <w/sockets.hpp>
+#include <wx/iovec.hpp>
+
+namespace
+{
+	// Transfers the segments with the given call, at most IOV_MAX at a time, advancing them as
+	// it goes. The call returns the number of bytes transferred from the segments it is given.
+
+	template <typename Transfer>
+	std::size_t transfer_all(std::span<struct iovec> iov, const char *what, Transfer transfer)
+	{
+		std::size_t total = 0;
+
+		// Leading empty segments would otherwise make a zero-length call.
+		iov = wx::advance(iov, 0);
+
+		while (!iov.empty())
+		{
+			std::error_code ec;
+			std::size_t n = transfer(iov.data(), static_cast<int>(std::min<std::size_t>(iov.size(), IOV_MAX)), ec);
+
+			if (ec == std::errc::interrupted)
+				continue;
+			else if (ec)
+				throw std::system_error(ec, what);
+
+			iov = wx::advance(iov, n);
+			total += n;
+		}
+
+		return total;
+	}
+}
+
+std::span<struct iovec> wx::advance(std::span<struct iovec> iov, std::size_t n) noexcept
+{
+	std::size_t i = 0;
+
+	for (; i < iov.size() && n >= iov[i].iov_len; ++i)
+		n -= iov[i].iov_len;
+
+	iov = iov.subspan(i);
+
+	if (!iov.empty())
+	{
+		iov.front().iov_base = static_cast<char *>(iov.front().iov_base) + n;
+		iov.front().iov_len -= n;
+	}
+
+	return iov;
+}
+
+std::size_t wx::write_all(int fd, std::span<struct iovec> iov)
+{
+	return transfer_all(iov, "write error",
+		[fd](const struct iovec *segments, int count, std::error_code& ec)
+		{
+			return w::writev(fd, segments, count, ec);
+		});
+}
+
+std::size_t wx::send_all(int sockfd, std::span<struct iovec> iov, int flags)
+{
+	return transfer_all(iov, "failed to send message to socket",
+		[sockfd, flags](const struct iovec *segments, int count, std::error_code& ec)
+		{
+			struct msghdr msg = { };
+			msg.msg_iov = const_cast<struct iovec *>(segments);
+			msg.msg_iovlen = static_cast<std::size_t>(count);
+
+			return w::sendmsg(sockfd, &msg, flags, ec);
+		});
+}
@@ -5,9 +5,14 @@
 //
 
 #include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -45,9 +50,243 @@ struct sockaddr_in6 wx::ipv6::get_link_local_address(const char *interface_name)
 	return *reinterpret_cast<const sockaddr_in6 *>(interface->ifa_addr);
 }
 
+std::to_chars_result wx::ipv6::to_chars(char *first, char *last, const in6_addr& address) noexcept
+{
+	static constexpr char digits[] = "0123456789abcdef";
+
+	std::uint16_t words[8];
+	for (int i = 0; i < 8; ++i)
+		words[i] = static_cast<std::uint16_t>((address.s6_addr[2 * i] << 8) | address.s6_addr[2 * i + 1]);
+
+	// Find the longest run of zero words (the first, if there is a tie), which is only
+	// shortened if it is at least two words long.
+
+	int best_base = -1, best_length = 0;
+
+	for (int i = 0; i < 8; )
+	{
+		if (words[i])
+		{
+			++i;
+			continue;
+		}
+
+		int base = i;
+		while (i < 8 && !words[i])
+			++i;
+
+		if (i - base > best_length)
+		{
+			best_base = base;
+			best_length = i - base;
+		}
+	}
+
+	if (best_length < 2)
+		best_base = -1;
+
+	char buffer[max_string_length];
+	char *p = buffer;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		if (best_base >= 0 && i >= best_base && i < best_base + best_length)
+		{
+			if (i == best_base)
+				*p++ = ':';
+
+			continue;
+		}
+
+		if (i)
+			*p++ = ':';
+
+		// IPv4-compatible (::a.b.c.d) and IPv4-mapped (::ffff:a.b.c.d) addresses end in
+		// dotted decimal notation.
+
+		if (i == 6 && best_base == 0 && (best_length == 6 || (best_length == 5 && words[5] == 0xffff)))
+		{
+			for (int j = 12; j < 16; ++j)
+			{
+				if (j != 12)
+					*p++ = '.';
+
+				p = std::to_chars(p, buffer + sizeof(buffer), address.s6_addr[j]).ptr;
+			}
+
+			break;
+		}
+
+		bool leading = true;
+
+		for (int shift = 12; shift >= 0; shift -= 4)
+		{
+			unsigned nibble = (words[i] >> shift) & 0xf;
+
+			if (leading && nibble == 0 && shift)
+				continue;
+
+			leading = false;
+			*p++ = digits[nibble];
+		}
+	}
+
+	if (best_base >= 0 && best_base + best_length == 8)
+		*p++ = ':';
+
+	auto length = static_cast<std::size_t>(p - buffer);
+
+	if (static_cast<std::size_t>(last - first) < length)
+		return { last, std::errc::value_too_large };
+
+	std::memcpy(first, buffer, length);
+	return { first + length, std::errc() };
+}
+
+namespace
+{
+	int hex_value(char ch) noexcept
+	{
+		if (ch >= '0' && ch <= '9')
+			return ch - '0';
+		else if (ch >= 'a' && ch <= 'f')
+			return ch - 'a' + 10;
+		else if (ch >= 'A' && ch <= 'F')
+			return ch - 'A' + 10;
+		else
+			return -1;
+	}
+
+	// Parses a dotted decimal IPv4 address with exactly four octets, without leading zeros,
+	// as inet_pton() does.
+	const char *parse_ipv4(const char *p, const char *last, std::uint8_t *octets) noexcept
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i)
+			{
+				if (p == last || *p != '.')
+					return nullptr;
+
+				++p;
+			}
+
+			if (p == last || *p < '0' || *p > '9')
+				return nullptr;
+
+			unsigned value = static_cast<unsigned>(*p++ - '0');
+
+			while (p != last && *p >= '0' && *p <= '9')
+			{
+				if (!value)
+					return nullptr;
+
+				value = value * 10 + static_cast<unsigned>(*p++ - '0');
+
+				if (value > 255)
+					return nullptr;
+			}
+
+			octets[i] = static_cast<std::uint8_t>(value);
+		}
+
+		return p;
+	}
+}
+
+std::from_chars_result wx::ipv6::from_chars(const char *first, const char *last, in6_addr& address) noexcept
+{
+	const std::from_chars_result invalid { first, std::errc::invalid_argument };
+
+	std::uint8_t bytes[16] = { };
+	int count = 0;
+	int gap = -1;
+	const char *p = first;
+
+	if (p != last && *p == ':')
+	{
+		if (last - p < 2 || p[1] != ':')
+			return invalid;
+
+		p += 2;
+		gap = 0;
+	}
+
+	while (p != last && count < 16)
+	{
+		const char *group = p;
+		unsigned value = 0;
+		int length = 0;
+
+		for (int digit; length < 5 && p != last && (digit = hex_value(*p)) >= 0; ++length, ++p)
+			value = value * 16 + static_cast<unsigned>(digit);
+
+		if (!length)
+			break;
+		else if (p != last && *p == '.')
+		{
+			// An embedded IPv4 address supplies the last two groups, and ends the address.
+
+			if (count > 12 || !(p = parse_ipv4(group, last, bytes + count)))
+				return invalid;
+
+			count += 4;
+			break;
+		}
+		else if (length > 4)
+			return invalid;
+
+		bytes[count++] = static_cast<std::uint8_t>(value >> 8);
+		bytes[count++] = static_cast<std::uint8_t>(value);
+
+		if (count == 16 || p == last || *p != ':')
+			break;
+
+		if (last - p >= 2 && p[1] == ':')
+		{
+			if (gap >= 0)
+				return invalid;
+
+			gap = count;
+			p += 2;
+		}
+		else if (last - p >= 2 && hex_value(p[1]) >= 0)
+			++p;
+		else
+			return invalid;
+	}
+
+	// The "::" gap must stand for at least one group, and without it all eight are needed.
+
+	if (gap >= 0)
+	{
+		if (count == 16)
+			return invalid;
+
+		std::memmove(bytes + 16 - (count - gap), bytes + gap, static_cast<std::size_t>(count - gap));
+		std::memset(bytes + gap, 0, static_cast<std::size_t>(16 - count));
+	}
+	else if (count != 16)
+		return invalid;
+
+	std::memcpy(address.s6_addr, bytes, sizeof(bytes));
+	return { p, std::errc() };
+}
+
+in6_addr wx::ipv6::parse(std::string_view str)
+{
+	in6_addr address;
+	const char *last = str.data() + str.size();
+	auto [ptr, ec] = wx::ipv6::from_chars(str.data(), last, address);
+
+	if (ec != std::errc() || ptr != last)
+		throw std::runtime_error("invalid IPv6 address '"s + std::string(str) + "'");
+
+	return address;
+}
+
 std::string wx::ipv6::to_string(const in6_addr& address)
 {
-	char str[64];
-	w::inet_ntop(AF_INET6, &address, str, sizeof(str));
-	return str;
+	char str[max_string_length];
+	return std::string(str, wx::ipv6::to_chars(str, str + sizeof(str), address).ptr);
 }
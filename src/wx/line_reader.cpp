@@ -0,0 +1,136 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+
+#include <w/posix.hpp>
+#include <wx/line_reader.hpp>
+
+using namespace std::string_literals;
+
+namespace
+{
+	w::fd open_for_reading(const char *path)
+	{
+		std::error_code ec;
+		w::fd file = w::open(path, O_RDONLY | O_CLOEXEC, ec);
+
+		if (ec)
+			throw std::system_error(ec, "failed to open '"s + path + "'");
+
+		// This is only a hint, so failure (e.g. on a pipe) is ignored.
+		::posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+		return file;
+	}
+}
+
+wx::line_reader::line_reader(const char *path, char delimiter, std::size_t block_size)
+	: line_reader(-1, delimiter, block_size)
+{
+	_owned = open_for_reading(path);
+	_fd = _owned;
+}
+
+wx::line_reader::line_reader(int fd, char delimiter, std::size_t block_size)
+	: _fd(fd),
+	  _delimiter(delimiter),
+	  _block_size(std::max(block_size, std::size_t { 1 })),
+	  _capacity(0),
+	  _next(nullptr),
+	  _scan(nullptr),
+	  _end(nullptr),
+	  _eof(false)
+{
+}
+
+wx::line_reader::line_reader(std::string_view data, char delimiter) noexcept
+	: _fd(-1),
+	  _delimiter(delimiter),
+	  _block_size(0),
+	  _capacity(0),
+	  _next(data.data()),
+	  _scan(data.data()),
+	  _end(data.data() + data.size()),
+	  _eof(true)
+{
+}
+
+wx::line_reader wx::line_reader::from_memory(std::string_view data, char delimiter) noexcept
+{
+	return line_reader(data, delimiter);
+}
+
+bool wx::line_reader::next(std::string_view& record)
+{
+	for (;;)
+	{
+		// Only the bytes which arrived since the last search are searched, so a record which
+		// straddles a refill is not scanned twice.
+
+		if (_scan < _end)
+		{
+			auto found = static_cast<const char *>(std::memchr(_scan, _delimiter, static_cast<std::size_t>(_end - _scan)));
+
+			if (found)
+			{
+				record = std::string_view(_next, static_cast<std::size_t>(found - _next));
+				_next = _scan = found + 1;
+				return true;
+			}
+
+			_scan = _end;
+		}
+
+		if (_eof)
+		{
+			if (_next == _end)
+				return false;
+
+			record = std::string_view(_next, static_cast<std::size_t>(_end - _next));
+			_next = _end;
+			return true;
+		}
+
+		refill();
+	}
+}
+
+void wx::line_reader::refill()
+{
+	// The partial record at the end of the buffer is moved to the start, and the buffer grows
+	// when the partial record leaves less than a block free.
+
+	auto pending = static_cast<std::size_t>(_end - _next);
+
+	if (_capacity - pending < _block_size)
+	{
+		std::size_t capacity = std::max(_capacity * 2, pending + _block_size);
+		auto buffer = std::make_unique_for_overwrite<char[]>(capacity);
+
+		if (pending)
+			std::memcpy(buffer.get(), _next, pending);
+
+		_buffer = std::move(buffer);
+		_capacity = capacity;
+	}
+	else if (pending && _next != _buffer.get())
+		std::memmove(_buffer.get(), _next, pending);
+
+	std::size_t n = w::read(_fd, _buffer.get() + pending, _capacity - pending);
+
+	_next = _buffer.get();
+	_scan = _next + pending;
+	_end = _scan + n;
+	_eof = !n;
+}
@@ -0,0 +1,52 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <w/posix.hpp>
+#include <wx/mapped_file.hpp>
+
+wx::mapped_file::mapped_file(const char *path, int advice, int flags)
+	: mapped_file(w::open(path, O_RDONLY | O_CLOEXEC), advice, flags)
+{
+}
+
+wx::mapped_file::mapped_file(int fd, int advice, int flags)
+{
+	struct stat statbuf = w::fstat(fd);
+
+	if (!S_ISREG(statbuf.st_mode))
+		throw std::invalid_argument("only regular files can be mapped");
+
+	if (!statbuf.st_size)
+		return;
+
+	_mapping = w::mmap(nullptr, static_cast<std::size_t>(statbuf.st_size), PROT_READ,
+		MAP_PRIVATE | flags, fd, 0);
+
+	if (advice != MADV_NORMAL)
+		advise(advice);
+}
+
+void wx::mapped_file::advise(int advice, std::size_t offset, std::size_t length)
+{
+	if (offset >= size())
+		return;
+
+	length = std::min(length, size() - offset);
+
+	static const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	std::size_t start = offset & ~(page_size - 1);
+
+	w::madvise(const_cast<std::byte *>(data()) + start, offset + length - start, advice);
+}
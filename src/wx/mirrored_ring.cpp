@@ -0,0 +1,46 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+#include <wx/mirrored_ring.hpp>
+
+wx::mirrored_ring::mirrored_ring(std::size_t capacity)
+	: _head(0),
+	  _tail(0)
+{
+	auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+	if (!capacity || capacity > (std::size_t { 1 } << (std::numeric_limits<std::size_t>::digits - 2)))
+		throw std::invalid_argument("invalid ring buffer capacity");
+
+	capacity = std::bit_ceil(std::max(capacity, page_size));
+
+	// Address space for both copies is reserved first, so that the two file mappings can be
+	// placed over it with MAP_FIXED without clobbering anything else. The reservation's handle
+	// then owns both mappings, and the file is kept alive by them after it is closed.
+
+	_mapping = w::mmap(nullptr, capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	_base = static_cast<std::byte *>(_mapping.get().address);
+
+	w::fd file = w::memfd_create("cppwrap_mirrored_ring", MFD_CLOEXEC);
+	w::ftruncate(file, static_cast<off_t>(capacity));
+
+	for (std::byte *copy : { _base, _base + capacity })
+		w::mmap(copy, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, file, 0).release();
+
+	_mask = capacity - 1;
+}
@@ -0,0 +1,93 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+
+#include <linux/netlink.h>
+#include <sys/socket.h>
+
+#include <w/assert.hpp>
+#include <w/netlink.hpp>
+#include <w/posix.hpp>
+#include <w/sockets.hpp>
+#include <wx/netlink.hpp>
+
+wx::netlink_socket::netlink_socket(int protocol, std::uint32_t groups, int receive_buffer,
+	unsigned batch, std::size_t datagram_size)
+	: _socket(w::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol)),
+	  _datagram_size(NLMSG_ALIGN(datagram_size)),
+	  _iovecs(batch ? batch : 1),
+	  _headers(_iovecs.size()),
+	  _sequence(0),
+	  _overrun(false)
+{
+	if (_datagram_size < NLMSG_HDRLEN)
+		throw std::invalid_argument("netlink datagram buffer is too small");
+
+	// The requested receive buffer is capped by net.core.rmem_max; that is not worth failing
+	// over, so errors are ignored.
+
+	if (receive_buffer)
+	{
+		std::error_code ec;
+		w::setsockopt(_socket, SOL_SOCKET, SO_RCVBUF, receive_buffer, ec);
+	}
+
+	w::bind(_socket, w::netlink_address(groups));
+
+	_buffers = std::make_unique<std::byte[]>(_datagram_size * _iovecs.size());
+
+	for (std::size_t i = 0; i < _iovecs.size(); ++i)
+	{
+		_iovecs[i].iov_base = _buffers.get() + i * _datagram_size;
+		_iovecs[i].iov_len = _datagram_size;
+		_headers[i].msg_hdr.msg_iov = &_iovecs[i];
+		_headers[i].msg_hdr.msg_iovlen = 1;
+	}
+}
+
+unsigned wx::netlink_socket::receive_batch()
+{
+	while (true)
+	{
+		std::error_code ec;
+		unsigned received = w::recvmmsg(_socket, _headers.data(), static_cast<unsigned>(_headers.size()), 0, nullptr, ec);
+
+		if (!ec)
+		{
+			// A datagram larger than its buffer has lost the messages at its tail, which is
+			// as good as an overrun.
+
+			for (unsigned i = 0; i < received; ++i)
+			{
+				if (_headers[i].msg_hdr.msg_flags & MSG_TRUNC)
+					_overrun = true;
+			}
+
+			return received;
+		}
+
+		if (w::would_block(ec))
+			return 0;
+
+		if (ec.value() != ENOBUFS)
+			throw std::system_error(ec, "failed to receive netlink messages");
+
+		_overrun = true;
+	}
+}
+
+std::uint32_t wx::netlink_socket::send(struct nlmsghdr& message)
+{
+	message.nlmsg_seq = ++_sequence;
+	w::sendto(_socket, &message, message.nlmsg_len, 0, w::netlink_address());
+	return message.nlmsg_seq;
+}
@@ -0,0 +1,84 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <w/posix.hpp>
+#include <w/sockets.hpp>
+#include <wx/packet_ring.hpp>
+
+namespace
+{
+	// TPACKET_V3 packs frames of any size into a block, but the kernel still validates the
+	// frame size against the block size, so any aligned size which divides it will do.
+
+	constexpr std::size_t frame_size = 2048;
+}
+
+wx::packet_ring::packet_ring(const char *interface, std::size_t block_size, std::size_t block_count,
+	std::chrono::milliseconds retire_timeout, int protocol)
+	: _current(0)
+{
+	constexpr std::size_t max = std::numeric_limits<unsigned>::max();
+	auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+	if (!block_size || block_size > max - page_size)
+		throw std::invalid_argument("invalid packet ring block size");
+
+	block_size = (block_size + page_size - 1) / page_size * page_size;
+
+	if (!block_count || block_count > max / (block_size / frame_size))
+		throw std::invalid_argument("invalid packet ring block count");
+
+	// The socket is created listening to no protocol, so that it receives nothing until it is
+	// bound below with the ring in place; it would otherwise start with every interface.
+
+	_socket = w::socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, 0);
+	w::setsockopt(_socket, SOL_PACKET, PACKET_VERSION, int { TPACKET_V3 });
+
+	struct tpacket_req3 req { };
+	req.tp_block_size = static_cast<unsigned>(block_size);
+	req.tp_block_nr = static_cast<unsigned>(block_count);
+	req.tp_frame_size = static_cast<unsigned>(frame_size);
+	req.tp_frame_nr = static_cast<unsigned>(block_size / frame_size * block_count);
+	req.tp_retire_blk_tov = static_cast<unsigned>(retire_timeout.count());
+
+	w::setsockopt(_socket, SOL_PACKET, PACKET_RX_RING, req);
+
+	_mapping = w::mmap(nullptr, block_size * block_count, PROT_READ | PROT_WRITE, MAP_SHARED, _socket, 0);
+	_base = static_cast<std::byte *>(_mapping.get().address);
+	_block_size = block_size;
+	_block_count = block_count;
+
+	struct sockaddr_ll addr { };
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = htons(static_cast<std::uint16_t>(protocol));
+	addr.sll_ifindex = interface && *interface ? static_cast<int>(w::if_nametoindex(interface)) : 0;
+
+	w::bind(_socket, addr);
+}
+
+void wx::packet_ring::join_fanout(std::uint16_t group, std::uint16_t mode)
+{
+	// The group ID goes in the low 16 bits, and the mode and its flags in the high 16 bits.
+
+	w::setsockopt(_socket, SOL_PACKET, PACKET_FANOUT, static_cast<int>(std::uint32_t { mode } << 16 | group));
+}
+
+struct tpacket_stats_v3 wx::packet_ring::statistics()
+{
+	return w::getsockopt<struct tpacket_stats_v3>(_socket, SOL_PACKET, PACKET_STATISTICS);
+}
@@ -0,0 +1,73 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <w/sockets.hpp>
+#include <wx/sharded_listener.hpp>
+
+wx::sharded_listener::sharded_listener(const struct sockaddr *addr, socklen_t addrlen,
+	std::size_t shards, int backlog)
+{
+	if (!shards)
+		throw std::invalid_argument("sharded listener needs at least one shard");
+
+	if (addr->sa_family != AF_INET && addr->sa_family != AF_INET6)
+		throw std::invalid_argument("unsupported address family for sharded listener");
+
+	if (addrlen > sizeof(struct sockaddr_storage))
+		throw std::invalid_argument("address is too large");
+
+	struct sockaddr_storage bound;
+	std::memcpy(&bound, addr, addrlen);
+
+	_sockets.reserve(shards);
+
+	for (std::size_t i = 0; i < shards; ++i)
+	{
+		w::fd fd = w::socket(addr->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC);
+		w::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, int { 1 });
+		w::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, int { 1 });
+		w::bind(fd, reinterpret_cast<const struct sockaddr *>(&bound), addrlen);
+
+		// With an ephemeral port, every socket would otherwise be given a different one, so the
+		// remaining shards bind to the port the kernel picked for the first.
+
+		if (!i)
+		{
+			socklen_t len = addrlen;
+			w::getsockname(fd, reinterpret_cast<struct sockaddr *>(&bound), &len);
+		}
+
+		w::listen(fd, backlog);
+		_sockets.push_back(std::move(fd));
+	}
+}
+
+void wx::sharded_listener::steer_by_cpu()
+{
+	// A = cpu % shards; return A. The result indexes the reuseport group in the order in which
+	// its sockets were bound, which is the order of the shards.
+
+	struct sock_filter code[] = {
+		{ BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU) },
+		{ BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<__u32>(_sockets.size()) },
+		{ BPF_RET | BPF_A, 0, 0, 0 },
+	};
+
+	struct sock_fprog prog = {
+		static_cast<unsigned short>(sizeof(code) / sizeof(code[0])),
+		code
+	};
+
+	w::setsockopt(_sockets.front(), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, prog);
+}
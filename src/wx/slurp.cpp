@@ -4,50 +4,227 @@
 // Published under the MIT license - https://opensource.org/licenses/MIT
 //
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <filesystem>
 #include <fstream>
 #include <ios>
-#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <w/linux.hpp>
+#include <w/posix.hpp>
 #include <wx/slurp.hpp>
 #include <wx/string.hpp>
 
 using namespace std::string_literals;
 
-std::string wx::read_file_as_string(const char *path)
+namespace
 {
-	// Note: It's impossible to determine the length of some files (notably, sysfs) in advance, so
-	// we have to use a dynamically-growing buffer strategy. The default initial buffer size must
-	// be chosen to be large enough to accommodate a reasonable proportion of files without
-	// reallocation but not too large to waste memory.
+	// The largest amount written in a single call, which keeps well clear of the kernel's own
+	// per-call limit of just under 2 GiB.
+	constexpr std::size_t max_chunk = std::size_t { 1 } << 30;
 
-	std::size_t buffer_size = 32;
+	std::atomic<unsigned> temporary_counter;
 
-	std::ifstream file;
-	file.open(path, std::ios::binary);
+	std::string parent_directory(const char *path)
+	{
+		std::filesystem::path parent = std::filesystem::path(path).parent_path();
+		return parent.empty() ? "." : parent.string();
+	}
 
-	if (!file)
-		throw std::runtime_error("failed to open '"s + path + "'");
+	// Temporary names only need to be unique among concurrent writers of the same file, and
+	// creating them with O_EXCL catches any collision.
 
-	file.exceptions(std::ios_base::badbit | std::ios_base::failbit);
+	std::string temporary_name(const std::string& path)
+	{
+		return path + ".tmp." + std::to_string(::getpid()) + '.' + std::to_string(temporary_counter++);
+	}
 
-	std::string contents(buffer_size, '\0');
-	std::size_t size = 0;
+	bool tmpfile_unsupported(const std::error_code& ec) noexcept
+	{
+		// Kernels older than 3.11 report EISDIR, since O_TMPFILE includes O_DIRECTORY.
+		return ec == std::errc::operation_not_supported ||
+			ec == std::errc::is_a_directory ||
+			ec == std::errc::invalid_argument;
+	}
+
+	void discard(std::string& temp) noexcept
+	{
+		if (temp.empty())
+			return;
+
+		std::error_code ec;
+		w::unlink(temp.c_str(), ec);
+		temp.clear();
+	}
+
+	void write_contents(int fd, std::string_view str)
+	{
+		// Preallocating lets the filesystem lay out the file in one go, and reports a full
+		// filesystem before anything is written. It is only a hint, so filesystems which do
+		// not support it are ignored.
+
+		if (!str.empty())
+		{
+			std::error_code ec;
+			w::fallocate(fd, 0, 0, static_cast<off_t>(str.size()), ec);
+
+			if (ec && ec != std::errc::operation_not_supported)
+				throw std::system_error(ec, "failed to allocate file space");
+		}
+
+		while (!str.empty())
+			str.remove_prefix(w::write(fd, str.data(), std::min(str.size(), max_chunk)));
+	}
 
-	file.exceptions(std::ios_base::badbit);
+	// Creates a file holding the given contents which is not yet visible at its path: an
+	// O_TMPFILE if the filesystem supports it, leaving temp empty, or otherwise a file under a
+	// temporary name.
 
-	while (file.read(&contents[size], buffer_size - size))
+	w::fd stage(const char *path, std::string_view str, std::string& temp)
 	{
-		size = buffer_size;
-		contents.resize(buffer_size *= 2);
+		std::error_code ec;
+		w::fd file = w::open(parent_directory(path).c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, 0666, ec);
+
+		if (ec && !tmpfile_unsupported(ec))
+			throw std::system_error(ec, "failed to create temporary file for '"s + path + "'");
+
+		if (ec)
+		{
+			do
+			{
+				temp = temporary_name(path);
+				file = w::open(temp.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0666, ec);
+			}
+			while (ec == std::errc::file_exists);
+
+			if (ec)
+			{
+				temp.clear();
+				throw std::system_error(ec, "failed to create temporary file for '"s + path + "'");
+			}
+		}
+
+		try
+		{
+			write_contents(file, str);
+		}
+		catch (...)
+		{
+			discard(temp);
+			throw;
+		}
+
+		return file;
 	}
 
-	contents.resize(size + file.gcount());
+	// Puts a staged file in place. An O_TMPFILE is linked directly to its path if nothing is
+	// there; otherwise it is linked under a temporary name, which is renamed over the path.
+
+	void publish(int fd, const std::string& path, std::string& temp)
+	{
+		std::error_code ec;
+
+		if (temp.empty())
+		{
+			std::string proc_path = "/proc/self/fd/" + std::to_string(fd);
+			w::linkat(AT_FDCWD, proc_path.c_str(), AT_FDCWD, path.c_str(), AT_SYMLINK_FOLLOW, ec);
+
+			if (!ec)
+				return;
+			else if (ec != std::errc::file_exists)
+				throw std::system_error(ec, "failed to link '" + path + "'");
+
+			do
+			{
+				temp = temporary_name(path);
+				w::linkat(AT_FDCWD, proc_path.c_str(), AT_FDCWD, temp.c_str(), AT_SYMLINK_FOLLOW, ec);
+			}
+			while (ec == std::errc::file_exists);
+
+			if (ec)
+			{
+				temp.clear();
+				throw std::system_error(ec, "failed to link '" + path + "'");
+			}
+		}
+
+		w::rename(temp.c_str(), path.c_str(), ec);
+
+		if (ec)
+		{
+			discard(temp);
+			throw std::system_error(ec, "failed to replace '" + path + "'");
+		}
+
+		temp.clear();
+	}
+}
+
+void wx::read_file_as_string(const char *path, std::string& contents)
+{
+	std::error_code ec;
+	w::fd file = w::open(path, O_RDONLY | O_CLOEXEC, ec);
+
+	if (ec)
+		throw std::system_error(ec, "failed to open '"s + path + "'");
+
+	// For regular files, the size is known in advance, so the buffer is allocated once and one
+	// extra byte is requested to detect a file which has grown since it was sized. It's
+	// impossible to determine the length of other files (notably, sysfs and procfs entries) in
+	// advance, so we have to use a dynamically-growing buffer strategy for them. The initial
+	// buffer size must be chosen to be large enough to accommodate a reasonable proportion of
+	// files without reallocation but not too large to waste memory.
+
+	struct stat statbuf = w::fstat(file);
+	std::size_t buffer_size;
+
+	if (S_ISREG(statbuf.st_mode) && statbuf.st_size > 0)
+		buffer_size = static_cast<std::size_t>(statbuf.st_size) + 1;
+	else
+		buffer_size = std::max(contents.capacity(), std::size_t { 32 });
+
+	contents.resize(buffer_size);
+	std::size_t size = 0;
+
+	for (;;)
+	{
+		std::size_t n = w::read(file, &contents[size], buffer_size - size);
+
+		if (!n)
+			break;
+
+		size += n;
+
+		if (size == buffer_size)
+			contents.resize(buffer_size *= 2);
+	}
+
+	contents.resize(size);
+}
+
+std::string wx::read_file_as_string(const char *path)
+{
+	std::string contents;
+	read_file_as_string(path, contents);
 	return contents;
 }
 
+void wx::slurp(const char *path, std::string& contents)
+{
+	read_file_as_string(path, contents);
+	wx::rtrim(contents);
+}
+
 std::string wx::slurp(const char *path)
 {
 	std::string contents = read_file_as_string(path);
@@ -62,3 +239,111 @@ void wx::spew(const char *path, std::string_view str)
 	file.open(path, std::ios::binary);
 	file.write(str.data(), str.size());
 }
+
+void wx::spew_atomic(const char *path, std::string_view str, bool sync)
+{
+	std::string temp;
+	w::fd file = stage(path, str, temp);
+
+	try
+	{
+		if (sync)
+			w::fdatasync(file);
+
+		publish(file, path, temp);
+	}
+	catch (...)
+	{
+		discard(temp);
+		throw;
+	}
+
+	if (sync)
+		w::fsync(w::open(parent_directory(path).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+}
+
+wx::spew_batch& wx::spew_batch::operator=(spew_batch&& other) noexcept
+{
+	if (&other != this)
+	{
+		clear();
+		_files = std::move(other._files);
+	}
+
+	return *this;
+}
+
+wx::spew_batch::~spew_batch()
+{
+	clear();
+}
+
+void wx::spew_batch::add(const char *path, std::string_view str)
+{
+	staged_file staged { { }, path, { } };
+	staged.file = stage(path, str, staged.temp);
+
+	try
+	{
+		_files.push_back(std::move(staged));
+	}
+	catch (...)
+	{
+		discard(staged.temp);
+		throw;
+	}
+}
+
+void wx::spew_batch::commit()
+{
+	// One file on each filesystem involved stands for its filesystem in syncfs().
+
+	std::vector<int> filesystems;
+	std::vector<dev_t> devices;
+
+	for (const staged_file& staged : _files)
+	{
+		dev_t device = w::fstat(staged.file).st_dev;
+
+		if (std::find(devices.begin(), devices.end(), device) == devices.end())
+		{
+			devices.push_back(device);
+			filesystems.push_back(staged.file);
+		}
+	}
+
+	for (int fd : filesystems)
+		w::syncfs(fd);
+
+	// Files are removed from the batch as they are put in place, so that a failure leaves
+	// only the remaining ones to be discarded.
+
+	auto published = _files.begin();
+
+	try
+	{
+		for (; published != _files.end(); ++published)
+			publish(published->file, published->path, published->temp);
+	}
+	catch (...)
+	{
+		_files.erase(_files.begin(), published);
+		throw;
+	}
+
+	// The file descriptors standing for the filesystems must stay open until the new names
+	// have been flushed too.
+
+	for (int fd : filesystems)
+		w::syncfs(fd);
+
+	_files.clear();
+}
+
+void wx::spew_batch::clear() noexcept
+{
+	for (staged_file& staged : _files)
+		discard(staged.temp);
+
+	_files.clear();
+}
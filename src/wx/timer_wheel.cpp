@@ -0,0 +1,340 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <sys/timerfd.h>
+#include <time.h>
+
+#include <w/assert.hpp>
+#include <w/linux.hpp>
+#include <w/posix.hpp>
+#include <wx/timer_wheel.hpp>
+
+wx::timer_wheel::timer_wheel(handler on_expire, std::chrono::nanoseconds resolution,
+	std::chrono::nanoseconds slack, int clockid)
+	: _on_expire(std::move(on_expire)),
+	  _clockid(clockid),
+	  _resolution(resolution.count()),
+	  _slack(0),
+	  _epoch(0),
+	  _now(0),
+	  _armed(std::numeric_limits<std::uint64_t>::max()),
+	  _size(0),
+	  _free(nil)
+{
+	if (_resolution <= 0)
+		throw std::invalid_argument("timer wheel resolution must be positive");
+
+	if (slack.count() > 0)
+		_slack = static_cast<std::uint64_t>((slack.count() + _resolution - 1) / _resolution);
+
+	std::fill(std::begin(_heads), std::end(_heads), nil);
+	std::fill(std::begin(_occupied), std::end(_occupied), 0);
+
+	_timer = w::timerfd_create(clockid, TFD_NONBLOCK | TFD_CLOEXEC);
+	_epoch = static_cast<std::int64_t>(now_ticks()) * _resolution;
+}
+
+std::uint64_t wx::timer_wheel::now_ticks() const
+{
+	struct timespec ts;
+
+	w::throw_if_ne(
+		::clock_gettime(_clockid, &ts),
+		0,
+		"failed to get clock time");
+
+	std::int64_t ns = static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec - _epoch;
+	return static_cast<std::uint64_t>(ns / _resolution);
+}
+
+std::uint64_t wx::timer_wheel::deadline(std::chrono::nanoseconds timeout) const
+{
+	// Round up, so that a timer never expires early, and then up again to the slack period so
+	// that nearby timers share a slot and a wakeup.
+
+	std::int64_t ns = std::max<std::int64_t>(timeout.count(), 0);
+	std::uint64_t tick = now_ticks() + static_cast<std::uint64_t>((ns + _resolution - 1) / _resolution) + 1;
+
+	if (_slack > 1)
+		tick = (tick + _slack - 1) / _slack * _slack;
+
+	return std::max(tick, _now + 1);
+}
+
+wx::timer_wheel::node *wx::timer_wheel::find(timer_id id) noexcept
+{
+	std::uint32_t index = static_cast<std::uint32_t>(id);
+	std::uint32_t generation = static_cast<std::uint32_t>(id >> 32);
+
+	if (index >= _nodes.size())
+		return nullptr;
+
+	node& n = _nodes[index];
+	return n.generation == generation && n.slot != nil ? &n : nullptr;
+}
+
+void wx::timer_wheel::link(std::uint32_t index, std::uint32_t slot) noexcept
+{
+	node& n = _nodes[index];
+	n.slot = slot;
+	n.prev = nil;
+	n.next = _heads[slot];
+
+	if (n.next != nil)
+		_nodes[n.next].prev = index;
+
+	_heads[slot] = index;
+
+	if (slot != due_slot)
+		_occupied[slot / slots_per_level] |= std::uint64_t { 1 } << (slot % slots_per_level);
+}
+
+void wx::timer_wheel::unlink(std::uint32_t index) noexcept
+{
+	node& n = _nodes[index];
+
+	if (n.prev != nil)
+		_nodes[n.prev].next = n.next;
+	else
+		_heads[n.slot] = n.next;
+
+	if (n.next != nil)
+		_nodes[n.next].prev = n.prev;
+
+	if (n.slot != due_slot && _heads[n.slot] == nil)
+		_occupied[n.slot / slots_per_level] &= ~(std::uint64_t { 1 } << (n.slot % slots_per_level));
+
+	n.slot = nil;
+}
+
+void wx::timer_wheel::place(std::uint32_t index) noexcept
+{
+	// A timer goes on the level of the most significant group of bits in which its expiration
+	// differs from the current time, in the slot given by its expiration's bits in that group.
+	// It is therefore revisited exactly when the current time reaches the start of that slot.
+
+	std::uint64_t expires = _nodes[index].expires;
+
+	if (expires <= _now)
+	{
+		link(index, due_slot);
+		return;
+	}
+
+	unsigned level = static_cast<unsigned>(std::bit_width(expires ^ _now) - 1) / level_bits;
+	level = std::min(level, levels - 1);
+
+	auto slot = static_cast<std::uint32_t>((expires >> (level * level_bits)) % slots_per_level);
+	link(index, level * slots_per_level + slot);
+}
+
+void wx::timer_wheel::collect(std::uint64_t now) noexcept
+{
+	std::uint64_t then = _now;
+	_now = now;
+
+	for (unsigned level = 0; level < levels; ++level)
+	{
+		// The slots passed at this level are those for the values in (then, now], taken modulo
+		// the number of slots. Each passed slot is emptied, and its timers are either due or
+		// placed again (always on a lower level).
+
+		unsigned shift = level * level_bits;
+		std::uint64_t elapsed = (now >> shift) - (then >> shift);
+
+		if (!elapsed)
+			break;
+
+		std::uint64_t passed = ~std::uint64_t { 0 };
+
+		if (elapsed < slots_per_level)
+			passed = std::rotl((std::uint64_t { 1 } << elapsed) - 1,
+				static_cast<int>(((then >> shift) + 1) % slots_per_level));
+
+		for (std::uint64_t pending = passed & _occupied[level]; pending; pending &= pending - 1)
+		{
+			std::uint32_t slot = level * slots_per_level + static_cast<std::uint32_t>(std::countr_zero(pending));
+			std::uint32_t index = _heads[slot];
+
+			_heads[slot] = nil;
+			_occupied[level] &= ~(std::uint64_t { 1 } << (slot % slots_per_level));
+
+			while (index != nil)
+			{
+				std::uint32_t next = _nodes[index].next;
+				place(index);
+				index = next;
+			}
+		}
+	}
+}
+
+std::uint64_t wx::timer_wheel::next_wakeup() const noexcept
+{
+	if (_heads[due_slot] != nil)
+		return _now;
+
+	// The lowest occupied level holds the earliest timers. On level zero, a slot holds timers
+	// expiring on exactly that tick; on higher levels, the wheel must wake up at the start of the
+	// slot to move its timers down.
+
+	for (unsigned level = 0; level < levels; ++level)
+	{
+		if (!_occupied[level])
+			continue;
+
+		unsigned shift = level * level_bits;
+		std::uint64_t base = (_now >> shift) + 1;
+		int offset = std::countr_zero(std::rotr(_occupied[level], static_cast<int>(base % slots_per_level)));
+
+		return (base + static_cast<std::uint64_t>(offset)) << shift;
+	}
+
+	return std::numeric_limits<std::uint64_t>::max();
+}
+
+void wx::timer_wheel::arm(std::uint64_t tick)
+{
+	if (tick == _armed)
+		return;
+
+	// An absolute expiration of zero would disarm the timer rather than fire immediately, so
+	// times in the past are clamped to one nanosecond.
+
+	std::chrono::nanoseconds when(0);
+
+	if (tick != std::numeric_limits<std::uint64_t>::max())
+		when = std::chrono::nanoseconds(std::max<std::int64_t>(
+			_epoch + static_cast<std::int64_t>(tick) * _resolution, 1));
+
+	w::timerfd_settime(_timer, TFD_TIMER_ABSTIME, std::chrono::nanoseconds(0), when);
+	_armed = tick;
+}
+
+wx::timer_wheel::timer_id wx::timer_wheel::schedule(std::chrono::nanoseconds timeout, void *user_data)
+{
+	std::uint64_t expires = deadline(timeout);
+	std::uint32_t index;
+
+	if (_free != nil)
+	{
+		index = _free;
+		_free = _nodes[index].next;
+	}
+	else
+	{
+		index = static_cast<std::uint32_t>(_nodes.size());
+		_nodes.push_back(node { 0, nullptr, nil, nil, 1, nil });
+	}
+
+	node& n = _nodes[index];
+	n.expires = expires;
+	n.user_data = user_data;
+	place(index);
+	++_size;
+
+	timer_id id = (static_cast<timer_id>(n.generation) << 32) | index;
+
+	if (expires < _armed)
+		arm(expires);
+
+	return id;
+}
+
+bool wx::timer_wheel::reschedule(timer_id id, std::chrono::nanoseconds timeout)
+{
+	node *n = find(id);
+
+	if (!n)
+		return false;
+
+	std::uint32_t index = static_cast<std::uint32_t>(id);
+	std::uint64_t expires = deadline(timeout);
+
+	unlink(index);
+	n->expires = expires;
+	place(index);
+
+	if (expires < _armed)
+		arm(expires);
+
+	return true;
+}
+
+bool wx::timer_wheel::cancel(timer_id id) noexcept
+{
+	node *n = find(id);
+
+	if (!n)
+		return false;
+
+	std::uint32_t index = static_cast<std::uint32_t>(id);
+	unlink(index);
+
+	// Bumping the generation invalidates the identifier, and the node goes back to the pool.
+
+	++n->generation;
+	n->next = _free;
+	_free = index;
+	--_size;
+	return true;
+}
+
+std::size_t wx::timer_wheel::expire()
+{
+	std::error_code ec;
+	std::uint64_t expirations = 0;
+	w::read(_timer, &expirations, sizeof(expirations), ec);
+
+	if (ec && !w::would_block(ec))
+		throw std::system_error(ec, "failed to read timer file descriptor");
+
+	// A one-shot timer is disarmed once it has fired, so it has to be programmed again.
+
+	_armed = std::numeric_limits<std::uint64_t>::max();
+
+	std::uint64_t now = now_ticks();
+	if (now > _now)
+		collect(now);
+
+	std::size_t count = 0;
+
+	try
+	{
+		while (_heads[due_slot] != nil)
+		{
+			// The node is released before the callback runs, so that the callback may schedule
+			// new timers (possibly reusing it) without affecting this loop.
+
+			std::uint32_t index = _heads[due_slot];
+			node& n = _nodes[index];
+			timer_id id = (static_cast<timer_id>(n.generation) << 32) | index;
+			void *user_data = n.user_data;
+
+			cancel(id);
+			++count;
+			_on_expire(id, user_data);
+		}
+	}
+	catch (...)
+	{
+		arm(next_wakeup());
+		throw;
+	}
+
+	arm(next_wakeup());
+	return count;
+}
@@ -0,0 +1,115 @@
+//
+// libcppwrap - A collection of C++ wrappers for native APIs
+// Copyright (C) 2021-2023 David A. Norris <danorris@gmail.com>
+// Published under the MIT license - https://opensource.org/licenses/MIT
+//
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <w/assert.hpp>
+#include <w/sockets.hpp>
+#include <wx/zerocopy.hpp>
+
+wx::zerocopy_sender::zerocopy_sender(int sockfd)
+	: _sockfd(sockfd),
+	  _next_id(0),
+	  _completed(0)
+{
+	w::setsockopt(_sockfd, SOL_SOCKET, SO_ZEROCOPY, int { 1 });
+}
+
+std::size_t wx::zerocopy_sender::send(const void *buf, std::size_t len, int flags)
+{
+	std::size_t sent = w::send(_sockfd, buf, len, flags | MSG_ZEROCOPY);
+	++_next_id;
+	return sent;
+}
+
+std::size_t wx::zerocopy_sender::send(const void *buf, std::size_t len, int flags,
+	std::error_code& ec) noexcept
+{
+	std::size_t sent = w::send(_sockfd, buf, len, flags | MSG_ZEROCOPY, ec);
+
+	if (!ec)
+		++_next_id;
+
+	return sent;
+}
+
+std::size_t wx::zerocopy_sender::sendmsg(const struct msghdr *msg, int flags)
+{
+	std::size_t sent = w::sendmsg(_sockfd, msg, flags | MSG_ZEROCOPY);
+	++_next_id;
+	return sent;
+}
+
+std::size_t wx::zerocopy_sender::sendmsg(const struct msghdr *msg, int flags,
+	std::error_code& ec) noexcept
+{
+	std::size_t sent = w::sendmsg(_sockfd, msg, flags | MSG_ZEROCOPY, ec);
+
+	if (!ec)
+		++_next_id;
+
+	return sent;
+}
+
+std::size_t wx::zerocopy_sender::reap(const completion_callback& cb)
+{
+	// Each notification carries a single extended error; the kernel merges consecutive
+	// completions into one range where it can, so a handful of reads usually suffices.
+
+	union
+	{
+		char buf[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+		struct cmsghdr align;
+	} control;
+
+	std::size_t count = 0;
+
+	for (;;)
+	{
+		struct msghdr msg;
+		std::memset(&msg, 0, sizeof(msg));
+		msg.msg_control = control.buf;
+		msg.msg_controllen = sizeof(control.buf);
+
+		std::error_code ec;
+		w::recvmsg(_sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT, ec);
+
+		if (w::would_block(ec))
+			break;
+		else if (ec)
+			throw std::system_error(ec, "failed to read socket error queue");
+
+		for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+		{
+			if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+				(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)))
+				continue;
+
+			struct sock_extended_err err;
+			std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+
+			if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY || err.ee_errno != 0)
+				continue;
+
+			std::uint32_t first = err.ee_info;
+			std::uint32_t last = err.ee_data;
+			std::uint32_t n = last - first + 1;
+
+			_completed += n;
+			count += n;
+			cb(first, last, err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED);
+		}
+	}
+
+	return count;
+}